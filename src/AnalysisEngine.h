@@ -0,0 +1,101 @@
+#ifndef ANALYSIS_ENGINE_H
+#define ANALYSIS_ENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class EngineLog;
+
+struct EngineLine {
+    std::string move;           // Best move in this line (e.g., "e2e4")
+    std::vector<std::string> pv; // Principal variation (sequence of moves)
+    int score;                  // Evaluation in centipawns (+100 = +1.0 pawn advantage)
+    int depth;                  // Search depth
+    int mate;                   // Mate in plies (0 = checkmate on board, >0 side to move mates in N plies, <0 side to move is mated in N plies)
+};
+
+// What ends a search; 0 leaves that limit unset. The search stops at the
+// first limit reached, or runs until stopped if none is set or `infinite`.
+// Clock fields are the remaining time and increment of each side, as in a
+// UCI "go wtime ... btime ..."; the engine budgets the side to move's share.
+struct SearchLimits {
+    int depth;
+    int movetimeMs;
+    uint64_t nodes;
+    int whiteTimeMs;
+    int blackTimeMs;
+    int whiteIncMs;
+    int blackIncMs;
+    int movesToGo;                        // moves until the next time control, 0 = sudden death
+    bool infinite;                        // ignore the limits above until stopped
+    bool ponder;                          // think on the opponent's time; limits start at ponderHit()
+    std::vector<std::string> searchMoves; // UCI moves to consider at the root, empty = all
+
+    SearchLimits()
+        : depth(0), movetimeMs(0), nodes(0), whiteTimeMs(0), blackTimeMs(0),
+          whiteIncMs(0), blackIncMs(0), movesToGo(0), infinite(false), ponder(false) {}
+};
+
+// How a search ended, as passed to a SearchCallback
+struct SearchResult {
+    std::string bestMove;           // UCI, empty if the position has no legal move
+    std::string ponderMove;         // expected reply to bestMove, empty if none
+    std::vector<EngineLine> lines;  // final lines, best first
+    bool stopped;                   // ended by stopAnalysis or a new position, not its limits
+
+    SearchResult() : stopped(false) {}
+};
+
+// Runs once per search on an engine thread when the search ends. It must
+// not start, stop or wait for a search on the same engine.
+typedef std::function<void(const SearchResult&)> SearchCallback;
+
+// Common interface of the analysis backends Game can drive: the external
+// Stockfish process and the built-in SearchEngine. Scores are from the side
+// to move's point of view, as in UCI.
+class AnalysisEngine {
+public:
+    virtual ~AnalysisEngine() {}
+
+    // Engine lifecycle
+    virtual bool initialize(const std::string& enginePath) = 0;
+    virtual void shutdown() = 0;
+
+    // Analysis
+    virtual bool sendPosition(const std::string& fen) = 0;
+    // The position reached from startFen by the UCI moves, so the engine
+    // knows the game's history and can see repetitions coming
+    virtual bool sendPosition(const std::string& startFen, const std::vector<std::string>& uciMoves) = 0;
+    virtual bool startAnalysis(int depth = 20, int multiPV = 1) = 0;
+    // onDone, if set, receives the result when the search ends, however it ends
+    virtual bool startSearch(const SearchLimits& limits, int multiPV = 1,
+                             const SearchCallback& onDone = SearchCallback()) = 0;
+    virtual void stopAnalysis() = 0;
+    // The opponent played the move a ponder search assumed: the search goes
+    // on as a normal one under its limits. On a miss, stopAnalysis() instead.
+    virtual void ponderHit() = 0;
+    // Blocks until the current search has ended and its final lines are
+    // available, or timeoutMs passes (-1 waits indefinitely). True if ended.
+    virtual bool waitForSearch(int timeoutMs = -1) = 0;
+
+    // Get analysis results
+    virtual std::vector<EngineLine> getBestLines(int count = 3) = 0;
+    virtual uint64_t getLinesVersion() const = 0; // changes whenever getBestLines has something new
+    virtual int getEvaluation() = 0;
+    virtual std::string getBestMove() = 0;
+
+    // Configuration
+    virtual void setMultiPV(int count) = 0;
+    virtual void setSkillLevel(int level) = 0; // 0-20, lower = weaker
+    virtual void setThreads(int count) = 0;
+    virtual void setHashSize(int megabytes) = 0; // transposition table size
+
+    // Status
+    virtual bool isEngineReady() const = 0;
+    virtual bool isEngineRunning() const = 0;
+    virtual const EngineLog* getLog() const = 0; // I/O timestamps and latency metrics, null if none
+};
+
+#endif // ANALYSIS_ENGINE_H
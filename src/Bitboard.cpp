@@ -0,0 +1,80 @@
+#include "Bitboard.h"
+#include <cstdlib>
+
+namespace Bitboards {
+
+Bitboard Rays[DIRECTION_COUNT][64];
+Bitboard KnightAttacks[64];
+Bitboard KingAttacks[64];
+Bitboard PawnAttacks[2][64];
+Bitboard Between[64][64];
+Bitboard Line[64][64];
+
+// File/rank deltas matching the Direction enum order
+static const int DirFile[DIRECTION_COUNT] = { 0,  1, 1, -1,  0, -1, -1,  1 };
+static const int DirRank[DIRECTION_COUNT] = { 1,  1, 0,  1, -1, -1,  0, -1 };
+
+static bool onBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+static Bitboard stepAttacks(int sq, const int (*deltas)[2], int count) {
+    Bitboard b = 0;
+    for (int i = 0; i < count; ++i) {
+        int f = fileOf(sq) + deltas[i][0];
+        int r = rankOf(sq) + deltas[i][1];
+        if (onBoard(f, r)) b |= squareBB(squareOf(f, r));
+    }
+    return b;
+}
+
+static void fillTables() {
+    static const int knightDeltas[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+    static const int kingDeltas[8][2] = { {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1} };
+    static const int whitePawnDeltas[2][2] = { {-1, 1}, {1, 1} };
+    static const int blackPawnDeltas[2][2] = { {-1, -1}, {1, -1} };
+
+    for (int sq = 0; sq < 64; ++sq) {
+        KnightAttacks[sq] = stepAttacks(sq, knightDeltas, 8);
+        KingAttacks[sq] = stepAttacks(sq, kingDeltas, 8);
+        PawnAttacks[0][sq] = stepAttacks(sq, whitePawnDeltas, 2);
+        PawnAttacks[1][sq] = stepAttacks(sq, blackPawnDeltas, 2);
+
+        for (int d = 0; d < DIRECTION_COUNT; ++d) {
+            Bitboard ray = 0;
+            int f = fileOf(sq) + DirFile[d];
+            int r = rankOf(sq) + DirRank[d];
+            while (onBoard(f, r)) {
+                ray |= squareBB(squareOf(f, r));
+                f += DirFile[d];
+                r += DirRank[d];
+            }
+            Rays[d][sq] = ray;
+        }
+    }
+
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            Between[a][b] = 0;
+            Line[a][b] = 0;
+            if (a == b) continue;
+            for (int d = 0; d < DIRECTION_COUNT; ++d) {
+                if (Rays[d][a] & squareBB(b)) {
+                    int opposite = (d + 4) % DIRECTION_COUNT;
+                    Between[a][b] = Rays[d][a] & Rays[opposite][b];
+                    Line[a][b] = Rays[d][a] | Rays[opposite][a] | squareBB(a);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void init() {
+    // A function-local static is initialised exactly once, even when the
+    // first Positions are built on several threads at the same time
+    static const bool filled = (fillTables(), true);
+    (void)filled;
+}
+
+} // namespace Bitboards
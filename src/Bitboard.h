@@ -0,0 +1,104 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include "ChessTypes.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One bit per square, bit index == square index (A1 = bit 0, H8 = bit 63)
+typedef uint64_t Bitboard;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFULL;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+inline Bitboard squareBB(int sq) { return Bitboard(1) << sq; }
+
+inline int popCount(Bitboard b) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least / most significant set bit. b must be non-zero.
+inline int lsb(Bitboard b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int msb(Bitboard b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, b);
+    return static_cast<int>(idx);
+#else
+    return 63 ^ __builtin_clzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+namespace Bitboards {
+
+// Ray directions. The first four step towards higher square indices.
+enum Direction { NORTH = 0, NORTH_EAST, EAST, NORTH_WEST, SOUTH, SOUTH_WEST, WEST, SOUTH_EAST, DIRECTION_COUNT };
+
+extern Bitboard Rays[DIRECTION_COUNT][64];
+extern Bitboard KnightAttacks[64];
+extern Bitboard KingAttacks[64];
+extern Bitboard PawnAttacks[2][64];
+extern Bitboard Between[64][64];
+extern Bitboard Line[64][64];
+
+// Fills the lookup tables. Safe to call more than once, from any thread.
+void init();
+
+inline Bitboard slide(int dir, int sq, Bitboard occ) {
+    Bitboard attacks = Rays[dir][sq];
+    Bitboard blockers = attacks & occ;
+    if (blockers) {
+        int b = (dir < SOUTH) ? lsb(blockers) : msb(blockers);
+        attacks ^= Rays[dir][b];
+    }
+    return attacks;
+}
+
+} // namespace Bitboards
+
+inline Bitboard pawnAttacks(PieceColor c, int sq) { return Bitboards::PawnAttacks[static_cast<int>(c)][sq]; }
+inline Bitboard knightAttacks(int sq) { return Bitboards::KnightAttacks[sq]; }
+inline Bitboard kingAttacks(int sq) { return Bitboards::KingAttacks[sq]; }
+
+inline Bitboard rookAttacks(int sq, Bitboard occ) {
+    using namespace Bitboards;
+    return slide(NORTH, sq, occ) | slide(EAST, sq, occ) | slide(SOUTH, sq, occ) | slide(WEST, sq, occ);
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occ) {
+    using namespace Bitboards;
+    return slide(NORTH_EAST, sq, occ) | slide(NORTH_WEST, sq, occ) | slide(SOUTH_EAST, sq, occ) | slide(SOUTH_WEST, sq, occ);
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occ) { return rookAttacks(sq, occ) | bishopAttacks(sq, occ); }
+
+// Squares strictly between a and b when they share a rank, file or diagonal; 0 otherwise
+inline Bitboard betweenBB(int a, int b) { return Bitboards::Between[a][b]; }
+
+// Full board line through a and b (both included); 0 when not aligned
+inline Bitboard lineBB(int a, int b) { return Bitboards::Line[a][b]; }
+
+#endif // BITBOARD_H
@@ -10,8 +10,7 @@
 #include <algorithm>
 
 Board::Board(sf::RenderWindow* window)
-    : window(window), selectedPiece(nullptr), currentState(INITIAL), hoveredSquare(""), currentTurn(PieceColor::WHITE), isCheck(false),
-      whiteKingsideCastle(true), whiteQueensideCastle(true), blackKingsideCastle(true), blackQueensideCastle(true) {
+    : window(window), selectedSquare(SQUARE_NONE), currentState(INITIAL), hoveredSquare(""), isCheck(false) {
     loadTextures();
     initializePieces();
 
@@ -35,14 +34,10 @@ Board::~Board() {
 
 void Board::reset() {
     // Reset board state to initial game
-    selectedPiece = nullptr;
+    selectedSquare = SQUARE_NONE;
     clickedSquare.clear();
     hoveredSquare.clear();
-    currentTurn = PieceColor::WHITE;
     isCheck = false;
-    whiteKingsideCastle = whiteQueensideCastle = true;
-    blackKingsideCastle = blackQueensideCastle = true;
-    enPassantTarget = "-";
     checkmateFlag = false;
     stalemateFlag = false;
     moveHistory.clear();
@@ -54,153 +49,54 @@ void Board::update(float dtMs) {
     updateAnimation(dtMs);
 }
 
-static PieceType pieceTypeFromChar(char c) {
-    switch (std::tolower(c)) {
-        case 'p': return PieceType::PAWN;
-        case 'n': return PieceType::KNIGHT;
-        case 'b': return PieceType::BISHOP;
-        case 'r': return PieceType::ROOK;
-        case 'q': return PieceType::QUEEN;
-        case 'k': return PieceType::KING;
-        default:  return PieceType::NONE;
-    }
-}
-
 bool Board::setFEN(const std::string& fen) {
-    // Expect: piece placement / active color / castling / en passant / halfmove / fullmove
-    std::istringstream iss(fen);
-    std::string placement, active, castling, ep, half, full;
-    if (!(iss >> placement >> active >> castling >> ep >> half >> full)) {
+    // Position only replaces its state when the whole FEN parses
+    if (!position.setFEN(fen)) {
         std::cout << "Invalid FEN: " << fen << std::endl;
         return false;
     }
+    setPosition(position);
+    return true;
+}
+
+void Board::setPosition(const Position& pos) {
+    if (&pos != &position) position = pos;
 
     // Reset state
-    pieces.clear();
     moveHistory.clear();
-    selectedPiece = nullptr;
+    selectedSquare = SQUARE_NONE;
     clickedSquare.clear();
     hoveredSquare.clear();
     checkmateFlag = false;
     stalemateFlag = false;
-    isCheck = false;
-
-    // Piece placement
-    int rank = 8;
-    int fileIndex = 0; // 0..7 for A..H
-    for (size_t i = 0; i < placement.size(); ++i) {
-        char c = placement[i];
-        if (c == '/') {
-            rank--;
-            fileIndex = 0;
-            continue;
-        }
-        if (std::isdigit(static_cast<unsigned char>(c))) {
-            fileIndex += c - '0';
-            continue;
-        }
-        if (fileIndex > 7 || rank < 1) {
-            std::cout << "Invalid FEN board placement bounds" << std::endl;
-            return false;
-        }
-        PieceType pt = pieceTypeFromChar(c);
-        PieceColor pc = std::isupper(static_cast<unsigned char>(c)) ? PieceColor::WHITE : PieceColor::BLACK;
-        char fileChar = static_cast<char>('A' + fileIndex);
-        std::string pos = std::string(1, fileChar) + std::to_string(rank);
-        if (pt != PieceType::NONE) {
-            pieces.emplace_back(pt, pc, pos);
-        }
-        fileIndex++;
-    }
-
-    // Active color
-    currentTurn = (active == "w") ? PieceColor::WHITE : PieceColor::BLACK;
-
-    // Castling rights
-    whiteKingsideCastle  = castling.find('K') != std::string::npos;
-    whiteQueensideCastle = castling.find('Q') != std::string::npos;
-    blackKingsideCastle  = castling.find('k') != std::string::npos;
-    blackQueensideCastle = castling.find('q') != std::string::npos;
-
-    // En passant
-    if (ep == "-") enPassantTarget = "-";
-    else {
-        // Convert to uppercase file
-        if (ep.size() >= 2) {
-            std::string upp = ep;
-            upp[0] = std::toupper(static_cast<unsigned char>(upp[0]));
-            enPassantTarget = upp;
-        } else {
-            enPassantTarget = "-";
-        }
-    }
-
-    return true;
+    isCheck = position.isKingInCheck(position.getSideToMove());
 }
 
 std::string Board::getLastMoveUCI() const {
     if (moveHistory.empty()) return std::string();
-    const auto& r = moveHistory.back();
-    if (r.from.size() < 2 || r.to.size() < 2) return std::string();
-    std::string from = r.from; std::string to = r.to;
-    from[0] = std::tolower(static_cast<unsigned char>(from[0]));
-    to[0] = std::tolower(static_cast<unsigned char>(to[0]));
-    std::string uci = from + to;
-    if (r.wasPromotion) {
-        char promo = 'q';
-        switch (r.promotionType) {
-            case PieceType::QUEEN: promo = 'q'; break;
-            case PieceType::ROOK: promo = 'r'; break;
-            case PieceType::BISHOP: promo = 'b'; break;
-            case PieceType::KNIGHT: promo = 'n'; break;
-            default: promo = 'q'; break;
-        }
-        uci.push_back(promo);
-    }
-    return uci;
+    return moveToUCI(position.lastMove());
 }
 
 bool Board::applyUCIMove(const std::string& uci) {
-    if (uci.size() < 4) return false;
-    std::string from;
-    from.push_back(std::toupper(static_cast<unsigned char>(uci[0])));
-    from.push_back(uci[1]);
-    std::string to;
-    to.push_back(std::toupper(static_cast<unsigned char>(uci[2])));
-    to.push_back(uci[3]);
-    size_t prev = moveHistory.size();
-    handleClick(from);
-    handleRelease(to);
-    bool ok = moveHistory.size() > prev;
-    if (ok && uci.size() >= 5) {
-        char pc = std::tolower(static_cast<unsigned char>(uci[4]));
-        PieceType pt = PieceType::QUEEN;
-        if (pc == 'q') pt = PieceType::QUEEN;
-        else if (pc == 'r') pt = PieceType::ROOK;
-        else if (pc == 'b') pt = PieceType::BISHOP;
-        else if (pc == 'n') pt = PieceType::KNIGHT;
-        setLastMovePromotion(pt);
+    Move move = position.parseUCIMove(uci);
+    if (move == MOVE_NONE) {
+        std::cout << "Illegal move " << uci << std::endl;
+        return false;
     }
+    playMove(move);
+
     // Trigger visual animation for programmatic (engine/puzzle) moves
-    if (ok) {
-        PieceType movedType = PieceType::NONE;
-        PieceColor movedColor = PieceColor::NONE;
-        if (!moveHistory.empty()) {
-            const auto& r = moveHistory.back();
-            movedType = r.movedPiece;
-            movedColor = r.movedColor;
-        }
-        // Use one-shot override if set; otherwise default to a moderate slow animation
-        float duration = 700.0f;
-        float delay = 0.0f;
-        if (programmaticAnimOverride) {
-            duration = programmaticAnimDurationMs;
-            delay = programmaticAnimDelayMs;
-            programmaticAnimOverride = false;
-        }
-        triggerMoveAnimation(from, to, movedType, movedColor, duration, delay);
-    }
-    return ok;
+    const MoveRecord& r = moveHistory.back();
+    // Use one-shot override if set; otherwise default to a moderate slow animation
+    float duration = 700.0f;
+    float delay = 0.0f;
+    if (programmaticAnimOverride) {
+        duration = programmaticAnimDurationMs;
+        delay = programmaticAnimDelayMs;
+        programmaticAnimOverride = false;
+    }
+    triggerMoveAnimation(squareToString(r.from), squareToString(r.to), r.movedPiece, r.movedColor, duration, delay);
+    return true;
 }
 
 void Board::loadTextures() {
@@ -252,39 +148,7 @@ void Board::loadTextures() {
 }
 
 void Board::initializePieces() {
-    pieces.clear();
-
-    // White pieces (row 1 and 2)
-    // Row 1: Rook, Knight, Bishop, Queen, King, Bishop, Knight, Rook
-    pieces.push_back(ChessPiece(PieceType::ROOK, PieceColor::WHITE, "A1"));
-    pieces.push_back(ChessPiece(PieceType::KNIGHT, PieceColor::WHITE, "B1"));
-    pieces.push_back(ChessPiece(PieceType::BISHOP, PieceColor::WHITE, "C1"));
-    pieces.push_back(ChessPiece(PieceType::QUEEN, PieceColor::WHITE, "D1"));
-    pieces.push_back(ChessPiece(PieceType::KING, PieceColor::WHITE, "E1"));
-    pieces.push_back(ChessPiece(PieceType::BISHOP, PieceColor::WHITE, "F1"));
-    pieces.push_back(ChessPiece(PieceType::KNIGHT, PieceColor::WHITE, "G1"));
-    pieces.push_back(ChessPiece(PieceType::ROOK, PieceColor::WHITE, "H1"));
-
-    // Row 2: All pawns
-    for (char file = 'A'; file <= 'H'; file++) {
-        pieces.push_back(ChessPiece(PieceType::PAWN, PieceColor::WHITE, std::string(1, file) + "2"));
-    }
-
-    // Black pieces (row 7 and 8)
-    // Row 7: All pawns
-    for (char file = 'A'; file <= 'H'; file++) {
-        pieces.push_back(ChessPiece(PieceType::PAWN, PieceColor::BLACK, std::string(1, file) + "7"));
-    }
-
-    // Row 8: Rook, Knight, Bishop, Queen, King, Bishop, Knight, Rook
-    pieces.push_back(ChessPiece(PieceType::ROOK, PieceColor::BLACK, "A8"));
-    pieces.push_back(ChessPiece(PieceType::KNIGHT, PieceColor::BLACK, "B8"));
-    pieces.push_back(ChessPiece(PieceType::BISHOP, PieceColor::BLACK, "C8"));
-    pieces.push_back(ChessPiece(PieceType::QUEEN, PieceColor::BLACK, "D8"));
-    pieces.push_back(ChessPiece(PieceType::KING, PieceColor::BLACK, "E8"));
-    pieces.push_back(ChessPiece(PieceType::BISHOP, PieceColor::BLACK, "F8"));
-    pieces.push_back(ChessPiece(PieceType::KNIGHT, PieceColor::BLACK, "G8"));
-    pieces.push_back(ChessPiece(PieceType::ROOK, PieceColor::BLACK, "H8"));
+    position.setStartPosition();
 }
 
 void Board::render() {
@@ -302,8 +166,8 @@ void Board::render() {
             hl.setOutlineThickness(0);
             window->draw(hl);
         };
-        if (r.from.size() == 2) drawSquare(r.from);
-        if (r.to.size() == 2) drawSquare(r.to);
+        drawSquare(squareToString(r.from));
+        drawSquare(squareToString(r.to));
     }
     renderPieces();
 
@@ -329,34 +193,37 @@ void Board::renderBoard() {
 }
 
 void Board::renderPieces() {
-    for (const auto& piece : pieces) {
-        if (!piece.isActive) continue;
-
-        int x = spriteCoordinate.getX(piece.position);
-        int y = spriteCoordinate.getY(piece.position);
+    // Walk the occupancy bitboard; the dragged piece is drawn last so it stays on top
+    Bitboard occ = position.occupied();
+    while (occ) {
+        int sq = popLsb(occ);
+        if (currentState == PIECE_CLICKED && sq == selectedSquare) continue;
 
-        // If this piece is being dragged, attach it to mouse
-        if (currentState == PIECE_CLICKED && selectedPiece == &piece) {
-            sf::Vector2i mousePos = sf::Mouse::getPosition(*window);
-            x = mousePos.x - 22;
-            y = mousePos.y - 22;
-        }
+        PieceType type = position.typeAt(sq);
+        PieceColor color = position.colorAt(sq);
+        std::string square = squareToString(sq);
 
         // If animating a move that already updated board state, hide the moved piece at destination
-        if (moveAnim.active && piece.position == moveAnim.to && piece.type == moveAnim.type && piece.color == moveAnim.color) {
+        if (moveAnim.active && square == moveAnim.to && type == moveAnim.type && color == moveAnim.color) {
             continue;
         }
 
-        renderPiece(piece, x, y);
+        renderPiece(type, color, spriteCoordinate.getX(square), spriteCoordinate.getY(square));
+    }
+
+    // If a piece is being dragged, attach it to mouse
+    if (currentState == PIECE_CLICKED && selectedSquare != SQUARE_NONE && !position.isEmpty(selectedSquare)) {
+        sf::Vector2i mousePos = sf::Mouse::getPosition(*window);
+        renderPiece(position.typeAt(selectedSquare), position.colorAt(selectedSquare), mousePos.x - 22, mousePos.y - 22);
     }
 }
 
-void Board::renderPiece(const ChessPiece& piece, int x, int y) {
+void Board::renderPiece(PieceType type, PieceColor color, int x, int y) {
     // Select the appropriate texture based on piece type and color
     sf::Texture* texture = nullptr;
 
-    if (piece.color == PieceColor::WHITE) {
-        switch (piece.type) {
+    if (color == PieceColor::WHITE) {
+        switch (type) {
             case PieceType::PAWN:   texture = &whitePawnTexture; break;
             case PieceType::KNIGHT: texture = &whiteKnightTexture; break;
             case PieceType::BISHOP: texture = &whiteBishopTexture; break;
@@ -366,7 +233,7 @@ void Board::renderPiece(const ChessPiece& piece, int x, int y) {
             default: return;
         }
     } else {
-        switch (piece.type) {
+        switch (type) {
             case PieceType::PAWN:   texture = &blackPawnTexture; break;
             case PieceType::KNIGHT: texture = &blackKnightTexture; break;
             case PieceType::BISHOP: texture = &blackBishopTexture; break;
@@ -384,172 +251,100 @@ void Board::renderPiece(const ChessPiece& piece, int x, int y) {
     }
 }
 
-ChessPiece* Board::getPieceAt(const std::string& position) {
-    for (auto& piece : pieces) {
-        if (piece.isActive && piece.position == position) {
-            return &piece;
+void Board::handleClick(const std::string& square) {
+    int sq = squareFromString(square);
+    if (sq != SQUARE_NONE && !position.isEmpty(sq)) {
+        // Only allow picking up pieces of the current turn
+        if (position.colorAt(sq) != position.getSideToMove()) {
+            std::cout << "It's " << (position.getSideToMove() == PieceColor::WHITE ? "white" : "black") << "'s turn!" << std::endl;
+            return;
         }
-    }
-    return nullptr;
-}
-
-bool Board::isPathClear(const std::string& from, const std::string& to) {
-    // Check if there are any pieces blocking the path from 'from' to 'to'
-    // This assumes the move is already validated as a valid direction (horizontal, vertical, or diagonal)
-
-    if (from == to) return false;
-
-    char startFile = from[0];
-    char endFile = to[0];
-    int startRank = from[1] - '0';
-    int endRank = to[1] - '0';
-
-    // Calculate direction
-    int fileStep = 0;
-    int rankStep = 0;
-
-    if (endFile > startFile) fileStep = 1;
-    else if (endFile < startFile) fileStep = -1;
-
-    if (endRank > startRank) rankStep = 1;
-    else if (endRank < startRank) rankStep = -1;
-
-    // Check each square along the path (excluding start and end)
-    char currentFile = startFile + fileStep;
-    int currentRank = startRank + rankStep;
 
-    while (currentFile != endFile || currentRank != endRank) {
-        std::string currentSquare = std::string(1, currentFile) + std::to_string(currentRank);
+        selectedSquare = sq;
+        clickedSquare = square;
+        currentState = PIECE_CLICKED;
+        std::cout << "Picked up " << (position.colorAt(sq) == PieceColor::WHITE ? "white " : "black ");
 
-        if (getPieceAt(currentSquare) != nullptr) {
-            return false;  // Path is blocked
+        switch (position.typeAt(sq)) {
+            case PieceType::PAWN: std::cout << "pawn"; break;
+            case PieceType::KNIGHT: std::cout << "knight"; break;
+            case PieceType::BISHOP: std::cout << "bishop"; break;
+            case PieceType::ROOK: std::cout << "rook"; break;
+            case PieceType::QUEEN: std::cout << "queen"; break;
+            case PieceType::KING: std::cout << "king"; break;
+            default: break;
         }
-
-        currentFile += fileStep;
-        currentRank += rankStep;
+        std::cout << " from " << square << std::endl;
     }
-
-    return true;  // Path is clear
 }
 
-bool Board::isMoveLegal(const ChessPiece& piece, const std::string& from, const std::string& to) {
-    // Basic validation
-    if (from == to) return false;
-    if (from.empty() || to.empty()) return false;
-
-    int startRank = (int)from.at(1) - '0';
-    int endRank = (int)to.at(1) - '0';
-    char startFile = from.at(0);
-    char endFile = to.at(0);
-
-    // Check if moving to a square with same color piece
-    ChessPiece* targetPiece = getPieceAt(to);
-    if (targetPiece && targetPiece->color == piece.color) {
-        return false;
-    }
-
-    // Piece-specific move validation
-    switch (piece.type) {
-        case PieceType::PAWN: {
-            if (piece.color == PieceColor::WHITE) {
-                // White pawns move up (increasing rank)
-                int direction = endRank - startRank;
-                int fileDiff = abs(endFile - startFile);
-
-                // Forward move
-                if (fileDiff == 0 && !targetPiece) {
-                    if (startRank == 2 && direction <= 2 && direction > 0) return true;
-                    if (direction == 1) return true;
-                }
-                // Diagonal capture
-                if (fileDiff == 1 && direction == 1) {
-                    if (targetPiece) return true;
-                    // En passant capture to empty square if matches enPassantTarget
-                    if (enPassantTarget != "-" && to == enPassantTarget) return true;
-                }
+void Board::handleRelease(const std::string& square) {
+    if (currentState == PIECE_CLICKED && selectedSquare != SQUARE_NONE) {
+        int from = selectedSquare;
+        int to = squareFromString(square);
+        Move move = findLegalMove(from, to);
+
+        if (move == MOVE_NONE) {
+            bool castleAttempt = position.typeAt(from) == PieceType::KING && to != SQUARE_NONE
+                && std::abs(fileOf(to) - fileOf(from)) == 2;
+            if (castleAttempt) {
+                std::cout << "Cannot castle!" << std::endl;
             } else {
-                // Black pawns move down (decreasing rank)
-                int direction = startRank - endRank;
-                int fileDiff = abs(endFile - startFile);
-
-                // Forward move
-                if (fileDiff == 0 && !targetPiece) {
-                    if (startRank == 7 && direction <= 2 && direction > 0) return true;
-                    if (direction == 1) return true;
-                }
-                // Diagonal capture
-                if (fileDiff == 1 && direction == 1) {
-                    if (targetPiece) return true;
-                    // En passant capture to empty square if matches enPassantTarget
-                    if (enPassantTarget != "-" && to == enPassantTarget) return true;
-                }
-            }
-            return false;
-        }
-
-        case PieceType::ROOK: {
-            // Rook moves horizontally or vertically
-            if (startRank == endRank || startFile == endFile) {
-                return isPathClear(from, to);
+                std::cout << "Illegal move from " << clickedSquare << " to " << square << std::endl;
             }
-            return false;
+            selectedSquare = SQUARE_NONE;
+            hoveredSquare = "";
+            currentState = INITIAL;
+            return;
         }
 
-        case PieceType::KNIGHT: {
-            // Knight moves in L-shape and can jump over pieces
-            int rankDiff = abs(endRank - startRank);
-            int fileDiff = abs(endFile - startFile);
-            return (rankDiff == 2 && fileDiff == 1) || (rankDiff == 1 && fileDiff == 2);
-        }
+        // The promotion piece is picked afterwards through setLastMovePromotion
+        // (promotion dialog), so the pawn lands on the last rank as a pawn for now
+        playMove(moveFlag(move) == MOVE_PROMOTION ? encodeMove(from, to) : move);
 
-        case PieceType::BISHOP: {
-            // Bishop moves diagonally
-            int rankDiff = abs(endRank - startRank);
-            int fileDiff = abs(endFile - startFile);
-            if (rankDiff == fileDiff && rankDiff > 0) {
-                return isPathClear(from, to);
-            }
-            return false;
-        }
+        // Trigger a short visual animation for manual moves
+        const MoveRecord& r = moveHistory.back();
+        triggerMoveAnimation(squareToString(r.from), squareToString(r.to), r.movedPiece, r.movedColor, 300.0f);
 
-        case PieceType::QUEEN: {
-            // Queen moves like rook or bishop
-            int rankDiff = abs(endRank - startRank);
-            int fileDiff = abs(endFile - startFile);
-            bool validDirection = (startRank == endRank || startFile == endFile || rankDiff == fileDiff);
-            if (validDirection) {
-                return isPathClear(from, to);
-            }
-            return false;
-        }
-
-        case PieceType::KING: {
-            // King moves one square in any direction
-            int rankDiff = abs(endRank - startRank);
-            int fileDiff = abs(endFile - startFile);
-            return rankDiff <= 1 && fileDiff <= 1;
-        }
+        selectedSquare = SQUARE_NONE;
+        hoveredSquare = "";
+        currentState = INITIAL;
+    }
+}
 
-        default:
-            return false;
+Move Board::findLegalMove(int from, int to) const {
+    if (from == SQUARE_NONE || to == SQUARE_NONE) return MOVE_NONE;
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    for (Move m : moves) {
+        if (moveFrom(m) == from && moveTo(m) == to) return m;
     }
+    return MOVE_NONE;
 }
 
-void Board::handleClick(const std::string& square) {
-    ChessPiece* piece = getPieceAt(square);
-    if (piece) {
-        // Only allow picking up pieces of the current turn
-        if (piece->color != currentTurn) {
-            std::cout << "It's " << (currentTurn == PieceColor::WHITE ? "white" : "black") << "'s turn!" << std::endl;
-            return;
-        }
+void Board::playMove(Move move) {
+    const int from = moveFrom(move);
+    const int to = moveTo(move);
 
-        selectedPiece = piece;
-        clickedSquare = square;
-        currentState = PIECE_CLICKED;
-        std::cout << "Picked up " << (piece->color == PieceColor::WHITE ? "white " : "black ");
+    MoveRecord record;
+    record.from = from;
+    record.to = to;
+    record.movedPiece = position.typeAt(from);
+    record.movedColor = position.colorAt(from);
+    record.capturedPiece = (moveFlag(move) == MOVE_EN_PASSANT) ? PieceType::PAWN
+                         : (moveFlag(move) == MOVE_CASTLING) ? PieceType::NONE : position.typeAt(to);
+    record.wasCastle = moveFlag(move) == MOVE_CASTLING;
+    record.wasEnPassant = moveFlag(move) == MOVE_EN_PASSANT;
+    record.wasPromotion = moveFlag(move) == MOVE_PROMOTION;
+    record.promotionType = record.wasPromotion ? movePromotion(move) : PieceType::NONE;
+    record.wasCheck = isCheck;
 
-        switch (piece->type) {
+    if (record.wasCastle) {
+        std::cout << "Castled " << (to > from ? "kingside" : "queenside") << std::endl;
+    }
+    if (record.capturedPiece != PieceType::NONE) {
+        std::cout << "Captured " << (record.movedColor == PieceColor::WHITE ? "black " : "white ");
+        switch (record.capturedPiece) {
             case PieceType::PAWN: std::cout << "pawn"; break;
             case PieceType::KNIGHT: std::cout << "knight"; break;
             case PieceType::BISHOP: std::cout << "bishop"; break;
@@ -558,215 +353,68 @@ void Board::handleClick(const std::string& square) {
             case PieceType::KING: std::cout << "king"; break;
             default: break;
         }
-        std::cout << " from " << square << std::endl;
-    }
-}
-
-void Board::handleRelease(const std::string& square) {
-    if (currentState == PIECE_CLICKED && selectedPiece) {
-        // Check for castling attempt (king moving 2 squares)
-        if (selectedPiece->type == PieceType::KING) {
-            int fileDiff = abs(square[0] - clickedSquare[0]);
-            if (fileDiff == 2) {
-                // Castling attempt
-                bool kingside = (square[0] > clickedSquare[0]);
-                if (canCastle(selectedPiece->color, kingside)) {
-                    executeCastle(selectedPiece->color, kingside);
-                    moveSound.play();
-                    // En passant target invalidated after any legal move
-                    enPassantTarget = "-";
-
-                    // Remove castling rights for this color
-                    if (selectedPiece->color == PieceColor::WHITE) {
-                        whiteKingsideCastle = false;
-                        whiteQueensideCastle = false;
-                    } else {
-                        blackKingsideCastle = false;
-                        blackQueensideCastle = false;
-                    }
-
-                    // Switch turn
-                    currentTurn = (currentTurn == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
-                    isCheck = isKingInCheck(currentTurn);
-                    if (isCheck) {
-                        std::cout << "CHECK! " << (currentTurn == PieceColor::WHITE ? "White" : "Black") << " king is in check!" << std::endl;
-                    }
-                    std::cout << "It's now " << (currentTurn == PieceColor::WHITE ? "white" : "black") << "'s turn" << std::endl;
-
-                    selectedPiece = nullptr;
-                    hoveredSquare = "";
-                    currentState = INITIAL;
-                    return;
-                } else {
-                    std::cout << "Cannot castle!" << std::endl;
-                    selectedPiece = nullptr;
-                    hoveredSquare = "";
-                    currentState = INITIAL;
-                    return;
-                }
-            }
-        }
-
-        if (isMoveLegal(*selectedPiece, clickedSquare, square)) {
-            // Check if this move would leave/put the king in check
-            if (wouldMoveCauseCheck(selectedPiece, clickedSquare, square)) {
-                std::cout << "Illegal move: Your king would be in check!" << std::endl;
-                selectedPiece = nullptr;
-                hoveredSquare = "";
-                currentState = INITIAL;
-                return;
-            }
+        std::cout << " at " << squareToString(to) << std::endl;
 
-            // Check if capturing (including en passant)
-            ChessPiece* capturedPiece = getPieceAt(square);
-            bool wasEnPassant = false;
-            if (!capturedPiece && selectedPiece->type == PieceType::PAWN && isEnPassantCapture(*selectedPiece, clickedSquare, square)) {
-                // En passant capture: captured pawn is behind 'to' square
-                char file = square[0];
-                int rank = square[1] - '0';
-                int capRank = (selectedPiece->color == PieceColor::WHITE) ? (rank - 1) : (rank + 1);
-                std::string capSquare = std::string(1, file) + std::to_string(capRank);
-                capturedPiece = getPieceAt(capSquare);
-                wasEnPassant = (capturedPiece != nullptr);
-            }
-            if (capturedPiece) {
-                std::cout << "Captured " << (capturedPiece->color == PieceColor::WHITE ? "white " : "black ");
-                switch (capturedPiece->type) {
-                    case PieceType::PAWN: std::cout << "pawn"; break;
-                    case PieceType::KNIGHT: std::cout << "knight"; break;
-                    case PieceType::BISHOP: std::cout << "bishop"; break;
-                    case PieceType::ROOK: std::cout << "rook"; break;
-                    case PieceType::QUEEN: std::cout << "queen"; break;
-                    case PieceType::KING: std::cout << "king"; break;
-                    default: break;
-                }
-                std::cout << " at " << square << std::endl;
-                capturedPiece->isActive = false;
-
-                // Play capture sound
-                captureSound.play();
-            } else {
-                // Play move sound
-                moveSound.play();
-            }
+        // Play capture sound
+        captureSound.play();
+    } else {
+        // Play move sound
+        moveSound.play();
+    }
 
-            // Update castling rights when king or rook moves
-            if (selectedPiece->type == PieceType::KING) {
-                if (selectedPiece->color == PieceColor::WHITE) {
-                    whiteKingsideCastle = false;
-                    whiteQueensideCastle = false;
-                } else {
-                    blackKingsideCastle = false;
-                    blackQueensideCastle = false;
-                }
-            } else if (selectedPiece->type == PieceType::ROOK) {
-                if (selectedPiece->color == PieceColor::WHITE) {
-                    if (clickedSquare == "H1") whiteKingsideCastle = false;
-                    if (clickedSquare == "A1") whiteQueensideCastle = false;
-                } else {
-                    if (clickedSquare == "H8") blackKingsideCastle = false;
-                    if (clickedSquare == "A8") blackQueensideCastle = false;
-                }
-            }
+    // Record move in history
+    moveHistory.push_back(record);
+    position.makeMove(move);
+    std::cout << "Moved to " << squareToString(to) << std::endl;
 
-            // Record move in history
-            MoveRecord record;
-            record.from = clickedSquare;
-            record.to = square;
-            record.movedPiece = selectedPiece->type;
-            record.movedColor = selectedPiece->color;
-            record.capturedPiece = capturedPiece;
-            record.wasCastle = false;
-            record.wasEnPassant = wasEnPassant;
-            record.wasPromotion = false;
-            record.promotionType = PieceType::NONE;
-            record.wasCheck = isCheck;
-            record.whiteKCastle = whiteKingsideCastle;
-            record.whiteQCastle = whiteQueensideCastle;
-            record.blackKCastle = blackKingsideCastle;
-            record.blackQCastle = blackQueensideCastle;
-            record.prevEnPassantTarget = enPassantTarget;
-            moveHistory.push_back(record);
-
-            // Move the piece
-            selectedPiece->position = square;
-            std::cout << "Moved to " << square << std::endl;
-
-            // Update en passant target: only set when a pawn moves two squares; otherwise clear
-            {
-                char sFile = clickedSquare[0];
-                int sRank = clickedSquare[1] - '0';
-                char tFile = square[0];
-                int tRank = square[1] - '0';
-                enPassantTarget = "-";
-                if (selectedPiece->type == PieceType::PAWN && sFile == tFile && std::abs(tRank - sRank) == 2) {
-                    int epRank = (selectedPiece->color == PieceColor::WHITE) ? (sRank + 1) : (sRank - 1);
-                    enPassantTarget = std::string(1, tFile) + std::to_string(epRank);
-                }
-            }
-
-            // Switch turn after successful move
-            currentTurn = (currentTurn == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+    updateGameState();
+    std::cout << "It's now " << (position.getSideToMove() == PieceColor::WHITE ? "white" : "black") << "'s turn" << std::endl;
+}
 
-            // Check if the opponent is now in check
-            isCheck = isKingInCheck(currentTurn);
-            if (isCheck) {
-                std::cout << "CHECK! " << (currentTurn == PieceColor::WHITE ? "White" : "Black") << " king is in check!" << std::endl;
-            }
+void Board::updateGameState() {
+    PieceColor toMove = position.getSideToMove();
 
-            // Determine checkmate/stalemate for side to move
-            checkmateFlag = false;
-            stalemateFlag = false;
-            if (!hasAnyLegalMove(currentTurn)) {
-                if (isCheck) {
-                    checkmateFlag = true;
-                    std::cout << "CHECKMATE!" << std::endl;
-                } else {
-                    stalemateFlag = true;
-                    std::cout << "STALEMATE!" << std::endl;
-                }
-            }
+    // Check if the side to move is now in check
+    isCheck = position.isKingInCheck(toMove);
+    if (isCheck) {
+        std::cout << "CHECK! " << (toMove == PieceColor::WHITE ? "White" : "Black") << " king is in check!" << std::endl;
+    }
 
-            std::cout << "It's now " << (currentTurn == PieceColor::WHITE ? "white" : "black") << "'s turn" << std::endl;
-            // Trigger a short visual animation for manual moves
-            triggerMoveAnimation(record.from, record.to, record.movedPiece, record.movedColor, 300.0f);
+    // Determine checkmate/stalemate for side to move
+    checkmateFlag = false;
+    stalemateFlag = false;
+    if (!hasAnyLegalMove()) {
+        if (isCheck) {
+            checkmateFlag = true;
+            std::cout << "CHECKMATE!" << std::endl;
         } else {
-            std::cout << "Illegal move from " << clickedSquare << " to " << square << std::endl;
+            stalemateFlag = true;
+            std::cout << "STALEMATE!" << std::endl;
         }
+    }
 
-        selectedPiece = nullptr;
-        hoveredSquare = "";
-        currentState = INITIAL;
+    if (!checkmateFlag && !stalemateFlag && isThreefoldRepetition()) {
+        std::cout << "Threefold repetition - draw can be claimed" << std::endl;
     }
 }
 
-bool Board::hasAnyLegalMove(PieceColor color) {
-    // Brute-force: try all moves for all pieces of 'color'
-    for (auto& piece : pieces) {
-        if (!piece.isActive || piece.color != color) continue;
-        std::string from = piece.position;
-        for (char file = 'A'; file <= 'H'; ++file) {
-            for (int rank = 1; rank <= 8; ++rank) {
-                std::string to = std::string(1, file) + std::to_string(rank);
-                if (from == to) continue;
-                if (isMoveLegal(piece, from, to)) {
-                    if (!wouldMoveCauseCheck(&piece, from, to)) {
-                        return true;
-                    }
-                }
-            }
-        }
-    }
-    return false;
+bool Board::isThreefoldRepetition() const {
+    return position.isRepetition(3);
+}
+
+bool Board::hasAnyLegalMove() const {
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    return !moves.empty();
 }
 
 void Board::handleRightClick() {
     // Cancel the current move if a piece is selected
-    if (currentState == PIECE_CLICKED && selectedPiece) {
+    if (currentState == PIECE_CLICKED && selectedSquare != SQUARE_NONE) {
         std::cout << "Move cancelled - piece returned to " << clickedSquare << std::endl;
 
         // Reset state
-        selectedPiece = nullptr;
+        selectedSquare = SQUARE_NONE;
         hoveredSquare = "";
         clickedSquare = "";
         currentState = INITIAL;
@@ -784,86 +432,7 @@ void Board::setState(State state) {
 }
 
 std::string Board::getFEN() const {
-    // FEN format: piece placement / active color / castling / en passant / halfmove / fullmove
-    std::string fen;
-
-    // 1. Piece placement (from rank 8 to rank 1)
-    for (int rank = 8; rank >= 1; rank--) {
-        int emptyCount = 0;
-        for (char file = 'A'; file <= 'H'; file++) {
-            std::string square = std::string(1, file) + std::to_string(rank);
-            ChessPiece* piece = const_cast<Board*>(this)->getPieceAt(square);
-
-            if (piece) {
-                if (emptyCount > 0) {
-                    fen += std::to_string(emptyCount);
-                    emptyCount = 0;
-                }
-
-                // Add piece character
-                char pieceChar;
-                switch (piece->type) {
-                    case PieceType::PAWN:   pieceChar = 'p'; break;
-                    case PieceType::KNIGHT: pieceChar = 'n'; break;
-                    case PieceType::BISHOP: pieceChar = 'b'; break;
-                    case PieceType::ROOK:   pieceChar = 'r'; break;
-                    case PieceType::QUEEN:  pieceChar = 'q'; break;
-                    case PieceType::KING:   pieceChar = 'k'; break;
-                    default: pieceChar = '?';
-                }
-
-                // White pieces are uppercase
-                if (piece->color == PieceColor::WHITE) {
-                    pieceChar = toupper(pieceChar);
-                }
-
-                fen += pieceChar;
-            } else {
-                emptyCount++;
-            }
-        }
-
-        if (emptyCount > 0) {
-            fen += std::to_string(emptyCount);
-        }
-
-        if (rank > 1) {
-            fen += '/';
-        }
-    }
-
-    // 2. Active color
-    fen += ' ';
-    fen += (currentTurn == PieceColor::WHITE) ? 'w' : 'b';
-
-    // 3. Castling availability
-    fen += ' ';
-    std::string castling;
-    if (whiteKingsideCastle) castling += 'K';
-    if (whiteQueensideCastle) castling += 'Q';
-    if (blackKingsideCastle) castling += 'k';
-    if (blackQueensideCastle) castling += 'q';
-    if (castling.empty()) castling = "-";
-    fen += castling;
-
-    // 4. En passant target square
-    fen += ' ';
-    if (enPassantTarget.empty() || enPassantTarget == "-") {
-        fen += "-";
-    } else {
-        // FEN uses lowercase files and ranks
-        std::string ep = enPassantTarget;
-        ep[0] = tolower(ep[0]);
-        fen += ep;
-    }
-
-    // 5. Halfmove clock (not tracked yet, default to 0)
-    fen += " 0";
-
-    // 6. Fullmove number (simplified, always 1 for now)
-    fen += " 1";
-
-    return fen;
+    return position.getFEN();
 }
 
 void Board::triggerMoveAnimation(const std::string& from, const std::string& to, PieceType type, PieceColor color, float durationMs, float delayMs) {
@@ -944,227 +513,39 @@ void Board::renderAnimationOverlay() {
     }
 }
 
-std::string Board::findKing(PieceColor color) {
-    for (const auto& piece : pieces) {
-        if (piece.isActive && piece.type == PieceType::KING && piece.color == color) {
-            return piece.position;
-        }
-    }
-    return "";  // Should never happen in a valid game
-}
-
-bool Board::isSquareUnderAttack(const std::string& square, PieceColor byColor) {
-    // Check if any piece of 'byColor' can attack 'square'
-    for (const auto& piece : pieces) {
-        if (!piece.isActive || piece.color != byColor) continue;
-
-        // Check if this piece can legally move to the square (ignoring check rules for this test)
-        if (isMoveLegal(piece, piece.position, square)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Board::isKingInCheck(PieceColor kingColor) {
-    std::string kingPos = findKing(kingColor);
-    if (kingPos.empty()) return false;
-
-    // Check if the king's position is under attack by the opponent
-    PieceColor opponentColor = (kingColor == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
-    return isSquareUnderAttack(kingPos, opponentColor);
-}
-
-bool Board::wouldMoveCauseCheck(ChessPiece* piece, const std::string& from, const std::string& to) {
-    // Simulate the move temporarily
-    std::string originalPos = piece->position;
-    ChessPiece* capturedPiece = getPieceAt(to);
-    ChessPiece* epCaptured = nullptr;
-    bool capturedWasActive = false;
-
-    // Handle en passant simulation (capture is not on 'to' square)
-    if (!capturedPiece && piece->type == PieceType::PAWN && isEnPassantCapture(*piece, from, to)) {
-        // Determine the captured pawn square relative to 'to'
-        char file = to[0];
-        int rank = to[1] - '0';
-        int capRank = (piece->color == PieceColor::WHITE) ? (rank - 1) : (rank + 1);
-        std::string capSquare = std::string(1, file) + std::to_string(capRank);
-        epCaptured = getPieceAt(capSquare);
-        if (epCaptured) {
-            capturedPiece = epCaptured;
-        }
-    }
-
-    if (capturedPiece) {
-        capturedWasActive = capturedPiece->isActive;
-        capturedPiece->isActive = false;
-    }
-
-    piece->position = to;
-
-    // Check if this move puts or leaves the current player's king in check
-    bool causesCheck = isKingInCheck(piece->color);
-
-    // Restore the board state
-    piece->position = originalPos;
-    if (capturedPiece) {
-        capturedPiece->isActive = capturedWasActive;
-    }
-
-    return causesCheck;
-}
-
-bool Board::isEnPassantCapture(const ChessPiece& piece, const std::string& from, const std::string& to) const {
-    if (enPassantTarget == "-" || piece.type != PieceType::PAWN) return false;
-    if (to != enPassantTarget) return false;
-    // Must be a diagonal step by 1 rank towards opponent
-    int startRank = (int)from.at(1) - '0';
-    int endRank = (int)to.at(1) - '0';
-    char startFile = from.at(0);
-    char endFile = to.at(0);
-    int fileDiff = std::abs(endFile - startFile);
-    if (piece.color == PieceColor::WHITE) {
-        return (endRank - startRank == 1) && (fileDiff == 1);
-    } else {
-        return (startRank - endRank == 1) && (fileDiff == 1);
-    }
-}
-
-bool Board::canCastle(PieceColor color, bool kingside) {
-    // Check castling rights
-    if (color == PieceColor::WHITE) {
-        if (kingside && !whiteKingsideCastle) return false;
-        if (!kingside && !whiteQueensideCastle) return false;
-    } else {
-        if (kingside && !blackKingsideCastle) return false;
-        if (!kingside && !blackQueensideCastle) return false;
-    }
-
-    // Check if king is in check
-    if (isKingInCheck(color)) return false;
-
-    // Define squares for castling
-    std::string kingStart = (color == PieceColor::WHITE) ? "E1" : "E8";
-    std::string kingEnd, rookStart;
-    std::vector<std::string> pathSquares;
-
-    if (kingside) {
-        kingEnd = (color == PieceColor::WHITE) ? "G1" : "G8";
-        rookStart = (color == PieceColor::WHITE) ? "H1" : "H8";
-        pathSquares = (color == PieceColor::WHITE) ?
-            std::vector<std::string>{"F1", "G1"} : std::vector<std::string>{"F8", "G8"};
-    } else {
-        kingEnd = (color == PieceColor::WHITE) ? "C1" : "C8";
-        rookStart = (color == PieceColor::WHITE) ? "A1" : "A8";
-        pathSquares = (color == PieceColor::WHITE) ?
-            std::vector<std::string>{"D1", "C1", "B1"} : std::vector<std::string>{"D8", "C8", "B8"};
-    }
-
-    // Check path is clear (no pieces between king and rook)
-    for (const auto& sq : pathSquares) {
-        if (sq != kingEnd && getPieceAt(sq) != nullptr) return false;
-    }
-
-    // Check king doesn't pass through or land on attacked square
-    PieceColor opponent = (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
-    std::vector<std::string> kingPath = {kingStart, (kingside ?
-        (color == PieceColor::WHITE ? "F1" : "F8") :
-        (color == PieceColor::WHITE ? "D1" : "D8")), kingEnd};
-
-    for (const auto& sq : kingPath) {
-        if (isSquareUnderAttack(sq, opponent)) return false;
-    }
-
-    return true;
-}
-
-void Board::executeCastle(PieceColor color, bool kingside) {
-    std::string kingStart = (color == PieceColor::WHITE) ? "E1" : "E8";
-    std::string kingEnd, rookStart, rookEnd;
-
-    if (kingside) {
-        kingEnd = (color == PieceColor::WHITE) ? "G1" : "G8";
-        rookStart = (color == PieceColor::WHITE) ? "H1" : "H8";
-        rookEnd = (color == PieceColor::WHITE) ? "F1" : "F8";
-    } else {
-        kingEnd = (color == PieceColor::WHITE) ? "C1" : "C8";
-        rookStart = (color == PieceColor::WHITE) ? "A1" : "A8";
-        rookEnd = (color == PieceColor::WHITE) ? "D1" : "D8";
-    }
-
-    // Move king
-    ChessPiece* king = getPieceAt(kingStart);
-    if (king) king->position = kingEnd;
-
-    // Move rook
-    ChessPiece* rook = getPieceAt(rookStart);
-    if (rook) rook->position = rookEnd;
-
-    std::cout << "Castled " << (kingside ? "kingside" : "queenside") << std::endl;
-}
-
 void Board::undoLastMove() {
     if (moveHistory.empty()) return;
-    MoveRecord rec = moveHistory.back();
     moveHistory.pop_back();
+    position.unmakeMove();
 
-    // Find moved piece at destination
-    ChessPiece* moved = getPieceAt(rec.to);
-    if (!moved) {
-        for (auto& p : pieces) {
-            if (p.isActive && p.color == rec.movedColor && p.position == rec.to) { moved = &p; break; }
-        }
-    }
-    if (moved) {
-        if (rec.wasPromotion) moved->type = PieceType::PAWN;
-        moved->position = rec.from;
-    }
-
-    // Restore captured piece, including en passant square
-    if (rec.capturedPiece) {
-        rec.capturedPiece->isActive = true;
-        if (rec.wasEnPassant) {
-            char file = rec.to[0];
-            int rank = rec.to[1] - '0';
-            int capRank = (rec.movedColor == PieceColor::WHITE) ? (rank - 1) : (rank + 1);
-            rec.capturedPiece->position = std::string(1, file) + std::to_string(capRank);
-        } else {
-            rec.capturedPiece->position = rec.to;
-        }
-    }
-
-    // Restore rights and ep target
-    whiteKingsideCastle = rec.whiteKCastle;
-    whiteQueensideCastle = rec.whiteQCastle;
-    blackKingsideCastle = rec.blackKCastle;
-    blackQueensideCastle = rec.blackQCastle;
-    enPassantTarget = rec.prevEnPassantTarget;
-
-    // Switch turn back
-    currentTurn = (currentTurn == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
-    isCheck = isKingInCheck(currentTurn);
+    isCheck = position.isKingInCheck(position.getSideToMove());
     checkmateFlag = false;
     stalemateFlag = false;
 }
 
 bool Board::setLastMovePromotion(PieceType promoteTo) {
     if (moveHistory.empty()) return false;
+    if (promoteTo == PieceType::PAWN || promoteTo == PieceType::KING || promoteTo == PieceType::NONE) return false;
     MoveRecord& rec = moveHistory.back();
-    ChessPiece* moved = getPieceAt(rec.to);
-    if (!moved) return false;
-    if (moved->type != PieceType::PAWN) return false;
-    int toRank = rec.to[1] - '0';
-    if (!((moved->color == PieceColor::WHITE && toRank == 8) || (moved->color == PieceColor::BLACK && toRank == 1))) return false;
-    moved->type = promoteTo;
+    if (position.typeAt(rec.to) != PieceType::PAWN) return false;
+    PieceColor color = position.colorAt(rec.to);
+    int toRank = rankOf(rec.to);
+    if (!((color == PieceColor::WHITE && toRank == 7) || (color == PieceColor::BLACK && toRank == 0))) return false;
+
+    // Replay the pawn move as a real promotion so the undo stack stays exact
+    position.unmakeMove();
+    position.makeMove(encodeMove(rec.from, rec.to, MOVE_PROMOTION, promoteTo));
     rec.wasPromotion = true;
     rec.promotionType = promoteTo;
+
+    // The promoted piece may give check or mate
+    updateGameState();
     return true;
 }
 
 PieceType Board::getPieceTypeAt(const std::string& square) const {
-    for (const auto& p : pieces) {
-        if (p.isActive && p.position == square) return p.type;
-    }
-    return PieceType::NONE;
+    int sq = squareFromString(square);
+    if (sq == SQUARE_NONE) return PieceType::NONE;
+    return position.typeAt(sq);
 }
 
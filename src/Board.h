@@ -11,32 +11,7 @@
 #include <vector>
 #include <memory>
 #include "Coordinate.h"
-
-enum class PieceType {
-    PAWN = 0,
-    KNIGHT = 1,
-    BISHOP = 2,
-    ROOK = 3,
-    QUEEN = 4,
-    KING = 5,
-    NONE = 6
-};
-
-enum class PieceColor {
-    WHITE = 0,
-    BLACK = 1,
-    NONE = 2
-};
-
-struct ChessPiece {
-    PieceType type;
-    PieceColor color;
-    std::string position;  // e.g., "A2", "E4"
-    bool isActive;         // false if piece is captured
-
-    ChessPiece(PieceType t, PieceColor c, std::string pos)
-        : type(t), color(c), position(pos), isActive(true) {}
-};
+#include "Position.h"
 
 class Board {
 private:
@@ -52,7 +27,8 @@ private:
 
     sf::Sprite pieceSprite;
 
-    std::vector<ChessPiece> pieces;
+    // Bitboard position is the single source of truth; sprites are drawn from it
+    Position position;
     Coordinate spriteCoordinate;
 
     // Sound effects
@@ -61,35 +37,26 @@ private:
     sf::Sound moveSound;
     sf::Sound captureSound;
 
-    // Move history for undo
+    // Move history for display and PGN; Position keeps the matching undo stack
     struct MoveRecord {
-        std::string from;
-        std::string to;
+        int from;                    // square index 0..63
+        int to;
         PieceType movedPiece;
         PieceColor movedColor;
-        ChessPiece* capturedPiece;
+        PieceType capturedPiece;     // NONE if nothing was captured
         bool wasCastle;
         bool wasEnPassant;           // en passant capture occurred
         bool wasPromotion;           // pawn promotion occurred
         PieceType promotionType;     // to what piece
         bool wasCheck;
-        bool whiteKCastle, whiteQCastle, blackKCastle, blackQCastle;
-        std::string prevEnPassantTarget; // previous en passant target square or "-"
     };
     std::vector<MoveRecord> moveHistory;
 
-    ChessPiece* selectedPiece;
+    int selectedSquare;          // square of the picked up piece or SQUARE_NONE
     std::string clickedSquare;
     std::string hoveredSquare;
-    PieceColor currentTurn;
     bool isCheck;
 
-    // Castling rights
-    bool whiteKingsideCastle;
-    bool whiteQueensideCastle;
-    bool blackKingsideCastle;
-    bool blackQueensideCastle;
-
     // Game state flags
     bool checkmateFlag = false;
     bool stalemateFlag = false;
@@ -101,19 +68,11 @@ private:
     void initializePieces();
     void renderBoard();
     void renderPieces();
-    void renderPiece(const ChessPiece& piece, int x, int y);
-    ChessPiece* getPieceAt(const std::string& position);
-    bool isMoveLegal(const ChessPiece& piece, const std::string& from, const std::string& to);
-    bool isPathClear(const std::string& from, const std::string& to);
-    bool isSquareUnderAttack(const std::string& square, PieceColor byColor);
-    std::string findKing(PieceColor color);
-    bool isKingInCheck(PieceColor kingColor);
-    bool wouldMoveCauseCheck(ChessPiece* piece, const std::string& from, const std::string& to);
-    bool canCastle(PieceColor color, bool kingside);
-    void executeCastle(PieceColor color, bool kingside);
-    bool isEnPassantCapture(const ChessPiece& piece, const std::string& from, const std::string& to) const;
-    std::string enPassantTarget = "-"; // target square in algebraic (e.g., "E3") or "-"
-    bool hasAnyLegalMove(PieceColor color);
+    void renderPiece(PieceType type, PieceColor color, int x, int y);
+    Move findLegalMove(int from, int to) const; // MOVE_NONE if no legal move matches
+    bool hasAnyLegalMove() const;
+    void playMove(Move move);    // records, plays sounds and makes a legal move
+    void updateGameState();
 
     // Animation of last move
     struct MoveAnimation {
@@ -145,6 +104,7 @@ public:
     void render();
     void reset();
     bool setFEN(const std::string& fen); // Load position from FEN
+    void setPosition(const Position& pos); // Load a position parsed elsewhere (a prefetched puzzle)
     std::string getLastMoveUCI() const;  // Return last move in UCI (e2e4), empty if none
     bool applyUCIMove(const std::string& uci); // Programmatically perform a move like "e2e4"; returns true on success
     void handleClick(const std::string& square);
@@ -153,9 +113,10 @@ public:
     void updateHoveredSquare(const std::string& square);
     void setState(State state);
     bool getIsCheck() const { return isCheck; }
-    PieceColor getCurrentTurn() const { return currentTurn; }
+    PieceColor getCurrentTurn() const { return position.getSideToMove(); }
     bool getIsCheckmate() const { return checkmateFlag; }
     bool getIsStalemate() const { return stalemateFlag; }
+    bool isThreefoldRepetition() const;
 
     // Move history
     void undoLastMove();
@@ -166,6 +127,8 @@ public:
 
     // FEN export
     std::string getFEN() const;
+    const Position& getPosition() const { return position; }
+    uint64_t getHash() const { return position.getKey(); } // Zobrist key, O(1)
 
     // PGN export/import
     std::string getPGN() const;
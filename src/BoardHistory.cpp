@@ -1,5 +1,7 @@
 // Board move history and PGN functions
 #include "Board.h"
+#include "Pgn.h"
+#include <iostream>
 #include <sstream>
 #include <fstream>
 
@@ -8,41 +10,33 @@
 std::string Board::getPGN() const {
     std::ostringstream pgn;
 
+    // Replay from the first position so every move is written in full SAN
+    Position replay = position;
+    std::vector<Move> moves;
+    for (int ply = 0; ply < replay.historySize(); ply++) moves.push_back(replay.moveAt(ply));
+    while (replay.historySize() > 0) replay.unmakeMove();
+    std::string startFEN = replay.getFEN();
+
     pgn << "[Event \"Chess Game\"]" << std::endl;
     pgn << "[Site \"Local\"]" << std::endl;
     pgn << "[Round \"1\"]" << std::endl;
     pgn << "[White \"Player 1\"]" << std::endl;
     pgn << "[Black \"Player 2\"]" << std::endl;
     pgn << "[Result \"*\"]" << std::endl;
+    if (startFEN != "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") {
+        pgn << "[SetUp \"1\"]" << std::endl;
+        pgn << "[FEN \"" << startFEN << "\"]" << std::endl;
+    }
     pgn << std::endl;
 
-    int moveNumber = 1;
-    for (size_t i = 0; i < moveHistory.size(); i++) {
-        const MoveRecord& move = moveHistory[i];
-
-        if (move.movedColor == PieceColor::WHITE) {
-            pgn << moveNumber << ". ";
-        }
-
-        // Convert to algebraic notation (simplified)
-        std::string pieceSymbol;
-        switch (move.movedPiece) {
-            case PieceType::KNIGHT: pieceSymbol = "N"; break;
-            case PieceType::BISHOP: pieceSymbol = "B"; break;
-            case PieceType::ROOK: pieceSymbol = "R"; break;
-            case PieceType::QUEEN: pieceSymbol = "Q"; break;
-            case PieceType::KING: pieceSymbol = "K"; break;
-            default: pieceSymbol = ""; break; // Pawn
-        }
-
-        pgn << pieceSymbol << move.to;
-
-        if (move.movedColor == PieceColor::BLACK) {
-            pgn << " ";
-            moveNumber++;
-        } else {
-            pgn << " ";
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (replay.getSideToMove() == PieceColor::WHITE) {
+            pgn << replay.getFullmoveNumber() << ". ";
+        } else if (i == 0) {
+            pgn << replay.getFullmoveNumber() << "... ";
         }
+        pgn << replay.moveToSAN(moves[i]) << " ";
+        replay.makeMove(moves[i]);
     }
 
     pgn << "*" << std::endl;
@@ -50,13 +44,24 @@ std::string Board::getPGN() const {
 }
 
 void Board::loadPGN(const std::string& pgn) {
-    // Reset board to initial position
-    pieces.clear();
-    moveHistory.clear();
-    initializePieces();
-    currentTurn = PieceColor::WHITE;
-    isCheck = false;
-
-    std::cout << "PGN loading not fully implemented yet. Board reset to initial position." << std::endl;
-    // Full PGN parsing would require more complex implementation
+    // Only the first game of the text is loaded
+    std::istringstream in(pgn);
+    PgnReader reader(in);
+    PgnGame game;
+    if (!reader.next(game)) {
+        reset();
+        std::cout << "No game found in PGN. Board reset to initial position." << std::endl;
+        return;
+    }
+
+    if (game.startFEN.empty() || !setFEN(game.startFEN)) {
+        reset();
+    }
+    for (Move m : game.moves) {
+        playMove(m);
+    }
+    if (!game.error.empty()) {
+        std::cout << "PGN: " << game.error << "; loaded the moves before it" << std::endl;
+    }
+    std::cout << "Loaded " << game.moves.size() << " moves from PGN" << std::endl;
 }
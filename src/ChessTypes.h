@@ -0,0 +1,86 @@
+#ifndef CHESS_TYPES_H
+#define CHESS_TYPES_H
+
+#include <string>
+
+enum class PieceType {
+    PAWN = 0,
+    KNIGHT = 1,
+    BISHOP = 2,
+    ROOK = 3,
+    QUEEN = 4,
+    KING = 5,
+    NONE = 6
+};
+
+enum class PieceColor {
+    WHITE = 0,
+    BLACK = 1,
+    NONE = 2
+};
+
+inline PieceColor oppositeColor(PieceColor c) {
+    return (c == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+// 'n' / 'N' -> KNIGHT, NONE for anything that is not a piece letter
+inline PieceType pieceTypeFromChar(char c) {
+    switch (c) {
+        case 'p': case 'P': return PieceType::PAWN;
+        case 'n': case 'N': return PieceType::KNIGHT;
+        case 'b': case 'B': return PieceType::BISHOP;
+        case 'r': case 'R': return PieceType::ROOK;
+        case 'q': case 'Q': return PieceType::QUEEN;
+        case 'k': case 'K': return PieceType::KING;
+        default:  return PieceType::NONE;
+    }
+}
+
+// Lowercase piece letter ('p', 'n', ...), '?' for NONE
+inline char pieceTypeToChar(PieceType t) {
+    switch (t) {
+        case PieceType::PAWN:   return 'p';
+        case PieceType::KNIGHT: return 'n';
+        case PieceType::BISHOP: return 'b';
+        case PieceType::ROOK:   return 'r';
+        case PieceType::QUEEN:  return 'q';
+        case PieceType::KING:   return 'k';
+        default:                return '?';
+    }
+}
+
+// Squares are indexed 0..63: A1 = 0, B1 = 1, ..., H1 = 7, A2 = 8, ..., H8 = 63
+const int SQUARE_NONE = 64;
+
+inline int squareOf(int file, int rank) { return rank * 8 + file; } // file/rank are 0..7
+inline int fileOf(int sq) { return sq & 7; }
+inline int rankOf(int sq) { return sq >> 3; }
+
+// "E4" / "e4" -> 28, SQUARE_NONE on anything malformed
+inline int squareFromString(const std::string& s) {
+    if (s.size() < 2) return SQUARE_NONE;
+    char f = s[0];
+    if (f >= 'a' && f <= 'h') f = static_cast<char>(f - 'a' + 'A');
+    if (f < 'A' || f > 'H' || s[1] < '1' || s[1] > '8') return SQUARE_NONE;
+    return squareOf(f - 'A', s[1] - '1');
+}
+
+// 28 -> "E4" (uppercase file, as used by Board and Coordinate)
+inline std::string squareToString(int sq) {
+    if (sq < 0 || sq >= 64) return std::string();
+    std::string s;
+    s.push_back(static_cast<char>('A' + fileOf(sq)));
+    s.push_back(static_cast<char>('1' + rankOf(sq)));
+    return s;
+}
+
+// Castling rights bitmask
+enum CastlingRight {
+    WHITE_KINGSIDE = 1,
+    WHITE_QUEENSIDE = 2,
+    BLACK_KINGSIDE = 4,
+    BLACK_QUEENSIDE = 8,
+    ALL_CASTLING = 15
+};
+
+#endif // CHESS_TYPES_H
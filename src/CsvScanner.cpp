@@ -0,0 +1,175 @@
+#include "CsvScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CSV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile wider instructions only inside functions asking for
+// them, so the SIMD kernels build without -mavx2 and run only when detected.
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define CSV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CSV_TARGET(isa)
+#endif
+
+namespace {
+
+// One bit per byte of `word` equal to the byte broadcast in `pattern`, in
+// byte order. Exact: the high bit of a byte is set only where the XOR is zero.
+uint64_t matchBytes(uint64_t word, uint64_t pattern) {
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    uint64_t x = word ^ pattern;
+    uint64_t zero = ~(((x & low7) + low7) | x | low7);
+    // Gathers the eight high bits into the top byte, byte 0 lowest
+    return (zero >> 7) * 0x0102040810204080ULL >> 56;
+}
+
+// Eight bytes at a time in a general-purpose register, for CPUs without SIMD.
+// Words are loaded little-endian, as on every platform the game builds for.
+void classifyScalar(const char* block, CsvBlockMasks& out) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    uint64_t quotes = 0;
+    uint64_t commas = 0;
+    uint64_t newlines = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t word;
+        std::memcpy(&word, block + 8 * i, sizeof(word));
+        int shift = 8 * i;
+        quotes |= matchBytes(word, ones * '"') << shift;
+        commas |= matchBytes(word, ones * ',') << shift;
+        newlines |= matchBytes(word, ones * '\n') << shift;
+    }
+    out.quotes = quotes;
+    out.commas = commas;
+    out.newlines = newlines;
+}
+
+#ifdef CSV_X86
+
+CSV_TARGET("sse2")
+void classifySse2(const char* block, CsvBlockMasks& out) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    uint64_t quotes = 0;
+    uint64_t commas = 0;
+    uint64_t newlines = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        int shift = 16 * i;
+        quotes |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << shift;
+        commas |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, comma)))) << shift;
+        newlines |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << shift;
+    }
+    out.quotes = quotes;
+    out.commas = commas;
+    out.newlines = newlines;
+}
+
+CSV_TARGET("avx2")
+void classifyAvx2(const char* block, CsvBlockMasks& out) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+    out.quotes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quote)))
+        | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quote)))) << 32;
+    out.commas = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, comma)))
+        | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, comma)))) << 32;
+    out.newlines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)))
+        | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)))) << 32;
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    // AVX needs the OS to save the YMM registers as well as the CPU to have it
+    __cpuid(info, 1);
+    bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (!osSavesAvx) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // CSV_X86
+
+CsvKernel detectKernel() {
+#ifdef CSV_X86
+    if (cpuHasAvx2()) return CSV_AVX2;
+    if (cpuHasSse2()) return CSV_SSE2;
+#endif
+    return CSV_SCALAR;
+}
+
+// Collects one line's fields for split()
+struct SplitVisitor {
+    CsvField* fields;
+    size_t maxFields;
+    size_t count;
+
+    void field(const char* data, size_t length) {
+        if (count == maxFields) return;
+        fields[count].data = data;
+        fields[count].length = length;
+        count++;
+    }
+    void row(size_t, size_t) {}
+};
+
+} // namespace
+
+CsvKernel CsvScanner::best() {
+    static const CsvKernel detected = detectKernel();
+    return detected;
+}
+
+bool CsvScanner::supported(CsvKernel k) {
+    return k >= CSV_SCALAR && k <= best();
+}
+
+const char* CsvScanner::name(CsvKernel k) {
+    switch (k) {
+        case CSV_SCALAR: return "scalar";
+        case CSV_SSE2: return "sse2";
+        case CSV_AVX2: return "avx2";
+        default: return "?";
+    }
+}
+
+CsvScanner::CsvScanner(CsvKernel wanted) : kernel(supported(wanted) ? wanted : best()), classify(classifyScalar) {
+#ifdef CSV_X86
+    if (kernel == CSV_SSE2) classify = classifySse2;
+    else if (kernel == CSV_AVX2) classify = classifyAvx2;
+#endif
+}
+
+size_t CsvScanner::split(const char* line, size_t length, CsvField* fields, size_t maxFields) const {
+    SplitVisitor visitor = { fields, maxFields, 0 };
+    scan(line, length, visitor);
+    return visitor.count;
+}
@@ -0,0 +1,148 @@
+#ifndef CSV_SCANNER_H
+#define CSV_SCANNER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "Bitboard.h"
+
+// Bytes of one field inside the scanned buffer, surrounding quotes excluded.
+// Valid as long as the buffer is.
+struct CsvField {
+    const char* data;
+    size_t length;
+
+    std::string str() const { return std::string(data, length); }
+    bool equals(const std::string& text) const {
+        return length == text.size() && std::memcmp(data, text.data(), length) == 0;
+    }
+};
+
+// Ways of classifying a block of CSV bytes, slowest first
+enum CsvKernel {
+    CSV_SCALAR,
+    CSV_SSE2,       // four 16-byte compares per block
+    CSV_AVX2,       // two 32-byte compares per block
+    CSV_KERNEL_COUNT
+};
+
+// Where the structural characters of one 64-byte block are: bit i is set
+// when byte i is that character
+struct CsvBlockMasks {
+    uint64_t quotes;
+    uint64_t commas;
+    uint64_t newlines;
+};
+
+// Splits CSV text into fields 64 bytes at a time. A kernel turns each block
+// into bitmasks of its quotes, commas and newlines; a prefix XOR over the
+// quote mask marks the quoted bytes, and the commas and newlines outside
+// them are the field ends, visited lowest bit first. Only 64 bytes are ever
+// looked at per step whatever the row length, and fields come back as
+// slices of the original buffer.
+//
+// The kernel is chosen at run time: AVX2 when the CPU and OS support it,
+// SSE2 on any other x86, and plain byte compares elsewhere. All kernels
+// produce the same masks.
+class CsvScanner {
+public:
+    static const size_t BLOCK_SIZE = 64;
+
+    // The fastest kernel this machine runs, detected once
+    static CsvKernel best();
+    static bool supported(CsvKernel kernel);
+    static const char* name(CsvKernel kernel);
+
+    // An unsupported kernel falls back to best()
+    explicit CsvScanner(CsvKernel kernel = best());
+    CsvKernel getKernel() const { return kernel; }
+
+    // Walks every line of [data, data + size), calling
+    //   visitor.field(const char* data, size_t length)
+    // for each field, surrounding quotes excluded, then
+    //   visitor.row(size_t begin, size_t end)
+    // with the line's offsets in `data`, its ending ("\n" or "\r\n")
+    // excluded. Blank lines come through as one empty field. Newlines and
+    // commas inside quotes belong to the field.
+    template <typename Visitor>
+    void scan(const char* data, size_t size, Visitor& visitor) const;
+
+    // The fields of one line without its ending, at most `maxFields` of
+    // them; returns how many were stored
+    size_t split(const char* line, size_t length, CsvField* fields, size_t maxFields) const;
+
+private:
+    typedef void (*ClassifyFunction)(const char* block, CsvBlockMasks& out);
+
+    CsvKernel kernel;
+    ClassifyFunction classify;
+
+    // Bit i of the result is the XOR of bits 0..i of x
+    static uint64_t prefixXor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    template <typename Visitor>
+    static void emitField(const char* data, size_t begin, size_t end, Visitor& visitor) {
+        if (end - begin >= 2 && data[begin] == '"' && data[end - 1] == '"') {
+            begin++;
+            end--;
+        }
+        visitor.field(data + begin, end - begin);
+    }
+};
+
+template <typename Visitor>
+void CsvScanner::scan(const char* data, size_t size, Visitor& visitor) const {
+    uint64_t inQuotes = 0;      // all ones when the previous block ended inside quotes
+    size_t fieldBegin = 0;
+    size_t rowBegin = 0;
+    char tail[BLOCK_SIZE];
+    CsvBlockMasks masks;
+
+    for (size_t base = 0; base < size; base += BLOCK_SIZE) {
+        const char* block = data + base;
+        // The last partial block is copied out rather than read past the buffer
+        if (size - base < BLOCK_SIZE) {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, block, size - base);
+            block = tail;
+        }
+        classify(block, masks);
+
+        uint64_t quoted = prefixXor(masks.quotes) ^ inQuotes;
+        inQuotes = 0 - (quoted >> 63);
+        uint64_t ends = (masks.commas | masks.newlines) & ~quoted;
+        while (ends) {
+            int bit = lsb(ends);
+            ends &= ends - 1;
+            size_t at = base + bit;
+            if (masks.newlines >> bit & 1) {
+                size_t rowEnd = at;
+                if (rowEnd > rowBegin && data[rowEnd - 1] == '\r') rowEnd--;
+                emitField(data, fieldBegin, std::max(rowEnd, fieldBegin), visitor);
+                visitor.row(rowBegin, rowEnd);
+                rowBegin = at + 1;
+            } else {
+                emitField(data, fieldBegin, at, visitor);
+            }
+            fieldBegin = at + 1;
+        }
+    }
+
+    // A last line without a newline
+    if (rowBegin < size) {
+        emitField(data, fieldBegin, size, visitor);
+        visitor.row(rowBegin, size);
+    }
+}
+
+#endif // CSV_SCANNER_H
@@ -0,0 +1,134 @@
+#include "EngineLog.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+EngineLog::EngineLog()
+    : created(Clock::now()), ring(CAPACITY), next(0), count(0), current(), searchStartUs(0),
+      parsedLines(0), parseNs(0), rateWindowUs(0), rateWindowLines(0) {
+    current.firstInfoMs = -1;
+    current.bestMoveMs = -1;
+    current.depthTimes.reserve(128);
+}
+
+int64_t EngineLog::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - created).count();
+}
+
+void EngineLog::append(bool sent, const char* text, size_t length, int64_t timeUs) {
+    // Commands carry their newline; it is not part of the text
+    while (length > 0 && (text[length - 1] == '\n' || text[length - 1] == '\r')) length--;
+    length = std::min(length, EngineLogEntry::TEXT_MAX);
+
+    EngineLogEntry& entry = ring[next];
+    entry.timeUs = timeUs;
+    entry.sent = sent;
+    entry.length = static_cast<uint16_t>(length);
+    std::memcpy(entry.text, text, length);
+    next = (next + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+}
+
+void EngineLog::recordSent(const char* text, size_t length) {
+    int64_t t = nowUs();
+    std::lock_guard<std::mutex> lock(mutex);
+    append(true, text, length, t);
+    current.commandsSent++;
+
+    if (length >= 2 && text[0] == 'g' && text[1] == 'o' && (length == 2 || text[2] == ' ' || text[2] == '\n')) {
+        searchStartUs = t;
+        current.searchId++;
+        current.firstInfoMs = -1;
+        current.depth = 0;
+        current.depthMs = 0;
+        current.bestMoveMs = -1;
+        current.depthTimes.clear();
+    }
+}
+
+void EngineLog::recordReceived(const char* text, size_t length) {
+    int64_t t = nowUs();
+    std::lock_guard<std::mutex> lock(mutex);
+    append(false, text, length, t);
+    current.linesReceived++;
+
+    // Lines per second over whole seconds, so the figure does not flicker
+    if (t - rateWindowUs >= 1000000) {
+        current.linesPerSecond = rateWindowLines * 1e6 / static_cast<double>(t - rateWindowUs);
+        rateWindowUs = t;
+        rateWindowLines = 0;
+    }
+    rateWindowLines++;
+}
+
+void EngineLog::recordParse(int64_t nanoseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    parsedLines++;
+    parseNs += nanoseconds;
+}
+
+void EngineLog::recordDepth(int depth) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int ms = static_cast<int>((nowUs() - searchStartUs) / 1000);
+    if (current.firstInfoMs < 0) current.firstInfoMs = ms;
+    if (depth > current.depth) {
+        current.depth = depth;
+        current.depthMs = ms;
+        if (current.depthTimes.size() < current.depthTimes.capacity()) {
+            current.depthTimes.push_back(std::make_pair(depth, ms));
+        }
+    }
+}
+
+void EngineLog::recordBestMove() {
+    std::lock_guard<std::mutex> lock(mutex);
+    int ms = static_cast<int>((nowUs() - searchStartUs) / 1000);
+    current.bestMoveMs = ms;
+}
+
+void EngineLog::recordBatch(size_t lines, size_t pendingBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current.lastBatchLines = lines;
+    current.maxBatchLines = std::max(current.maxBatchLines, lines);
+    current.pendingBytes = pendingBytes;
+}
+
+EngineMetrics EngineLog::metrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    EngineMetrics m = current;
+    m.parseUsPerLine = parsedLines ? parseNs / 1000.0 / parsedLines : 0.0;
+    return m;
+}
+
+std::vector<EngineLogEntry> EngineLog::entries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<EngineLogEntry> out;
+    out.reserve(count);
+    size_t first = (next + CAPACITY - count) % CAPACITY;
+    for (size_t i = 0; i < count; ++i) out.push_back(ring[(first + i) % CAPACITY]);
+    return out;
+}
+
+bool EngineLog::dump(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    EngineMetrics m = metrics();
+    out << "# commands " << m.commandsSent << ", lines " << m.linesReceived
+        << ", " << m.linesPerSecond << " lines/s, parse " << m.parseUsPerLine << " us/line\n";
+    out << "# search " << m.searchId << ": first info " << m.firstInfoMs << " ms, depth " << m.depth
+        << " at " << m.depthMs << " ms, bestmove " << m.bestMoveMs << " ms\n";
+    out << "# depth times:";
+    for (const auto& d : m.depthTimes) out << ' ' << d.first << '@' << d.second;
+    out << "\n# reader batch " << m.lastBatchLines << " lines (max " << m.maxBatchLines << "), "
+        << m.pendingBytes << " bytes pending\n";
+
+    // time in ms, direction, text
+    for (const EngineLogEntry& e : entries()) {
+        out << e.timeUs / 1000 << '.' << (e.timeUs / 100) % 10 << (e.timeUs / 10) % 10 << (e.timeUs % 10)
+            << (e.sent ? " > " : " < ");
+        out.write(e.text, e.length);
+        out << '\n';
+    }
+    return true;
+}
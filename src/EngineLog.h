@@ -0,0 +1,79 @@
+#ifndef ENGINE_LOG_H
+#define ENGINE_LOG_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One command sent to, or line received from, an engine
+struct EngineLogEntry {
+    static const size_t TEXT_MAX = 120;     // longer lines are cut
+
+    int64_t timeUs;                         // since the log was created
+    bool sent;
+    uint16_t length;
+    char text[TEXT_MAX];
+};
+
+// Latency and throughput of the engine link, for the search started last
+struct EngineMetrics {
+    uint64_t commandsSent;
+    uint64_t linesReceived;
+    double linesPerSecond;                  // over the last full second
+    double parseUsPerLine;                  // mean time in the info parser
+    int searchId;                           // "go" commands so far
+    int firstInfoMs;                        // go -> first line with a PV, -1 until then
+    int depth;                              // deepest depth reported
+    int depthMs;                            // go -> that depth
+    int bestMoveMs;                         // go -> bestmove, -1 while searching
+    std::vector<std::pair<int, int> > depthTimes; // (depth, ms after go) for each new depth
+    size_t lastBatchLines;                  // lines the reader took in one wake-up
+    size_t maxBatchLines;
+    size_t pendingBytes;                    // read but not yet a complete line
+};
+
+// Fixed-size ring buffer of timestamped engine I/O plus the metrics derived
+// from it. Writers are the thread sending commands and the output reader;
+// a mutex keeps them apart (uncontended it costs less than the timestamp).
+// Nothing allocates once the log exists.
+class EngineLog {
+public:
+    static const size_t CAPACITY = 4096;    // entries kept; older ones are overwritten
+
+    EngineLog();
+
+    void recordSent(const char* text, size_t length);       // a "go" starts new search metrics
+    void recordReceived(const char* text, size_t length);
+    void recordParse(int64_t nanoseconds);                   // one info line through the parser
+    void recordDepth(int depth);                             // current search reached `depth`
+    void recordBestMove();                                   // current search ended
+    void recordBatch(size_t lines, size_t pendingBytes);     // one reader wake-up
+
+    EngineMetrics metrics() const;
+    std::vector<EngineLogEntry> entries() const;             // oldest first
+    bool dump(const std::string& path) const;                // entries and metrics as text
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    mutable std::mutex mutex;
+    Clock::time_point created;
+    std::vector<EngineLogEntry> ring;
+    size_t next;                            // slot written next
+    size_t count;                           // slots in use
+
+    EngineMetrics current;
+    int64_t searchStartUs;
+    uint64_t parsedLines;
+    int64_t parseNs;
+    int64_t rateWindowUs;                   // start of the second being counted
+    uint64_t rateWindowLines;
+
+    int64_t nowUs() const;
+    void append(bool sent, const char* text, size_t length, int64_t timeUs);
+};
+
+#endif // ENGINE_LOG_H
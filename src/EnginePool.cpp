@@ -0,0 +1,174 @@
+#include "EnginePool.h"
+#include "SearchEngine.h"
+#include "StockfishEngine.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// How often a driver waiting on its engine checks for cancellation
+const int CANCEL_CHECK_MS = 20;
+
+} // namespace
+
+EnginePool::EnginePool(int engineCount, int threadsPerEngine, int hashMegabytesPerEngine)
+    : requestedEngines(engineCount), threadsPerEngine(std::max(1, threadsPerEngine)),
+      hashMegabytes(std::max(1, hashMegabytesPerEngine)), engineFactory(&EnginePool::createDefaultEngine),
+      nextJobId(0), running(0), stopping(false), cancelGeneration(0) {
+    if (requestedEngines <= 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        requestedEngines = std::max(1, static_cast<int>(cores) / this->threadsPerEngine);
+    }
+}
+
+EnginePool::~EnginePool() {
+    shutdown();
+}
+
+AnalysisEngine* EnginePool::createDefaultEngine() {
+    AnalysisEngine* engine = new StockfishEngine();
+    if (engine->initialize(STOCKFISH_DEFAULT_PATH)) return engine;
+    delete engine;
+
+    engine = new SearchEngine();
+    if (engine->initialize("")) return engine;
+    delete engine;
+    return nullptr;
+}
+
+bool EnginePool::start() {
+    if (!engines.empty()) return true;
+
+    for (int i = 0; i < requestedEngines; ++i) {
+        AnalysisEngine* engine = engineFactory();
+        if (!engine) break;
+        engine->setThreads(threadsPerEngine);
+        engine->setHashSize(hashMegabytes);
+        engines.push_back(engine);
+    }
+    if (engines.empty()) {
+        std::cout << "Engine pool: no engine could be started" << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    for (AnalysisEngine* engine : engines) {
+        drivers.emplace_back(&EnginePool::driverLoop, this, engine);
+    }
+    std::cout << "Engine pool: " << engines.size() << " engine" << (engines.size() == 1 ? "" : "s")
+              << " x " << threadsPerEngine << " thread" << (threadsPerEngine == 1 ? "" : "s") << std::endl;
+    return true;
+}
+
+void EnginePool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+        cancelGeneration++;
+    }
+    jobReady.notify_all();
+    for (std::thread& t : drivers) {
+        if (t.joinable()) t.join();
+    }
+    drivers.clear();
+
+    for (AnalysisEngine* engine : engines) {
+        engine->shutdown();
+        delete engine;
+    }
+    engines.clear();
+    resultReady.notify_all();
+}
+
+size_t EnginePool::submit(const AnalysisJob& job) {
+    size_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextJobId++;
+        QueuedJob queued;
+        queued.id = id;
+        queued.job = job;
+        jobs.push_back(queued);
+    }
+    jobReady.notify_one();
+    return id;
+}
+
+bool EnginePool::poll(AnalysisResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) return false;
+    result = results.front();
+    results.pop_front();
+    return true;
+}
+
+bool EnginePool::waitResult(AnalysisResult& result) {
+    std::unique_lock<std::mutex> lock(mutex);
+    resultReady.wait(lock, [this]() {
+        return !results.empty() || (jobs.empty() && running == 0) || drivers.empty();
+    });
+    if (results.empty()) return false;
+    result = results.front();
+    results.pop_front();
+    return true;
+}
+
+void EnginePool::cancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.clear();
+    cancelGeneration++;
+    resultReady.notify_all();
+}
+
+size_t EnginePool::outstanding() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size() + running;
+}
+
+void EnginePool::driverLoop(AnalysisEngine* engine) {
+    for (;;) {
+        QueuedJob queued;
+        unsigned generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            queued = jobs.front();
+            jobs.pop_front();
+            running++;
+            generation = cancelGeneration.load();
+        }
+
+        AnalysisResult result;
+        result.jobId = queued.id;
+        result.fen = queued.job.fen;
+        result.completed = false;
+        if (engine->sendPosition(queued.job.fen) && engine->startSearch(queued.job.limits, queued.job.multiPV)) {
+            // The engine ends the search at its limits; we only wake up to
+            // notice cancellation. A job with no limits runs until cancelled.
+            for (;;) {
+                if (engine->waitForSearch(CANCEL_CHECK_MS)) {
+                    result.completed = true;
+                    break;
+                }
+                if (cancelGeneration.load() != generation) {
+                    engine->stopAnalysis();
+                    engine->waitForSearch();
+                    break;
+                }
+            }
+            result.lines = engine->getBestLines(queued.job.multiPV);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            results.push_back(result);
+        }
+        resultReady.notify_all();
+    }
+}
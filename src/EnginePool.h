@@ -0,0 +1,91 @@
+#ifndef ENGINE_POOL_H
+#define ENGINE_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AnalysisEngine.h"
+
+// One position to analyse
+struct AnalysisJob {
+    std::string fen;
+    SearchLimits limits;
+    int multiPV;
+
+    AnalysisJob() : multiPV(1) {}
+};
+
+struct AnalysisResult {
+    size_t jobId;               // as returned by EnginePool::submit
+    std::string fen;
+    std::vector<EngineLine> lines; // best first; empty if cancelled before depth 1 or no legal move
+    bool completed;             // false if the job was cancelled
+};
+
+// Several engine instances analysing independent positions in parallel.
+// Each engine has a driver thread that takes jobs from a shared queue, runs
+// them to their limits and queues the result; the caller collects results
+// in completion order with poll() (non-blocking) or waitResult().
+//
+// Engines come from a factory; the default starts Stockfish and falls back
+// to the built-in engine, as Game does.
+class EnginePool {
+public:
+    typedef std::function<AnalysisEngine*()> EngineFactory;
+
+    // engineCount 0 picks cores / threadsPerEngine
+    explicit EnginePool(int engineCount = 0, int threadsPerEngine = 1, int hashMegabytesPerEngine = 16);
+    ~EnginePool();
+
+    void setEngineFactory(const EngineFactory& factory) { engineFactory = factory; }
+
+    // Stockfish if it starts, otherwise the built-in engine; null if neither
+    // does. Game creates its own engines here too.
+    static AnalysisEngine* createDefaultEngine();
+
+    // Starts the engines; false if none could be started
+    bool start();
+    void shutdown();
+
+    size_t submit(const AnalysisJob& job);  // returns the job id
+    bool poll(AnalysisResult& result);       // next finished result, if any
+    bool waitResult(AnalysisResult& result); // blocks; false once nothing is queued or running
+    void cancelAll();                        // drops queued jobs and stops running ones
+
+    int size() const { return static_cast<int>(engines.size()); }
+    size_t outstanding() const;              // jobs queued or running
+
+private:
+    struct QueuedJob {
+        size_t id;
+        AnalysisJob job;
+    };
+
+    int requestedEngines;
+    int threadsPerEngine;
+    int hashMegabytes;
+    EngineFactory engineFactory;
+
+    std::vector<AnalysisEngine*> engines;
+    std::vector<std::thread> drivers;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobReady;      // a job was queued, or the pool is stopping
+    std::condition_variable resultReady;   // a result was queued, or nothing is outstanding
+    std::deque<QueuedJob> jobs;            // guarded by mutex
+    std::deque<AnalysisResult> results;    // guarded by mutex
+    size_t nextJobId;
+    size_t running;
+    bool stopping;
+    std::atomic<unsigned> cancelGeneration; // bumped by cancelAll; running jobs stop when it changes
+
+    void driverLoop(AnalysisEngine* engine);
+};
+
+#endif // ENGINE_POOL_H
@@ -0,0 +1,156 @@
+#include "EvalCache.h"
+#include <sqlite3.h>
+#include <sstream>
+
+namespace {
+
+// Past this many positions the in-memory copy is dropped; the database
+// keeps everything and refills memory on demand
+const size_t MAX_MEMORY_ENTRIES = 1 << 16;
+
+} // namespace
+
+EvalCache::EvalCache(const std::string& path) : dbPath(path) {}
+
+EvalCache::~EvalCache() {
+    close();
+}
+
+bool EvalCache::open() {
+    if (db) return true;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+    const char* ddl =
+        "PRAGMA journal_mode=WAL;"
+        "PRAGMA synchronous=NORMAL;"
+        "CREATE TABLE IF NOT EXISTS eval_cache (key INTEGER PRIMARY KEY, depth INTEGER, lines TEXT);";
+    char* err = nullptr;
+    if (sqlite3_exec(db, ddl, nullptr, nullptr, &err) != SQLITE_OK
+        || sqlite3_prepare_v2(db, "SELECT depth, lines FROM eval_cache WHERE key=?1", -1, &selectStmt, nullptr) != SQLITE_OK
+        || sqlite3_prepare_v2(db, "INSERT INTO eval_cache(key,depth,lines) VALUES(?1,?2,?3) "
+                                  "ON CONFLICT(key) DO UPDATE SET depth=excluded.depth, lines=excluded.lines "
+                                  "WHERE excluded.depth >= eval_cache.depth", -1, &upsertStmt, nullptr) != SQLITE_OK) {
+        if (err) sqlite3_free(err);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EvalCache::close() {
+    if (!db) return;
+    flush();
+    sqlite3_finalize(selectStmt);
+    sqlite3_finalize(upsertStmt);
+    selectStmt = nullptr;
+    upsertStmt = nullptr;
+    sqlite3_close(db);
+    db = nullptr;
+}
+
+bool EvalCache::lookup(uint64_t key, Entry& entry) {
+    auto it = memory.find(key);
+    if (it != memory.end()) {
+        entry = it->second.entry;
+        return true;
+    }
+    if (!db) return false;
+
+    bool found = false;
+    sqlite3_bind_int64(selectStmt, 1, static_cast<sqlite3_int64>(key));
+    if (sqlite3_step(selectStmt) == SQLITE_ROW) {
+        const unsigned char* text = sqlite3_column_text(selectStmt, 1);
+        entry.depth = sqlite3_column_int(selectStmt, 0);
+        entry.lines = decodeLines(text ? reinterpret_cast<const char*>(text) : "");
+        found = !entry.lines.empty();
+    }
+    sqlite3_reset(selectStmt);
+
+    if (found) {
+        if (memory.size() >= MAX_MEMORY_ENTRIES) {
+            flush();
+            memory.clear();
+        }
+        Slot slot;
+        slot.entry = entry;
+        slot.dirty = false;
+        memory[key] = slot;
+    }
+    return found;
+}
+
+void EvalCache::store(uint64_t key, const std::vector<EngineLine>& lines) {
+    if (lines.empty() || lines[0].pv.empty()) return;
+    int depth = lines[0].depth;
+
+    auto it = memory.find(key);
+    if (it == memory.end()) {
+        if (memory.size() >= MAX_MEMORY_ENTRIES) {
+            flush();
+            memory.clear();
+        }
+        Slot slot;
+        slot.dirty = false;
+        it = memory.insert(std::make_pair(key, slot)).first;
+    } else if (depth < it->second.entry.depth) {
+        return;
+    }
+
+    Slot& slot = it->second;
+    slot.entry.depth = depth;
+    slot.entry.lines = lines;
+    if (!slot.dirty) {
+        slot.dirty = true;
+        dirtyCount++;
+    }
+}
+
+void EvalCache::flush() {
+    if (!db || dirtyCount == 0) return;
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    for (auto& kv : memory) {
+        Slot& slot = kv.second;
+        if (!slot.dirty) continue;
+        std::string text = encodeLines(slot.entry.lines);
+        sqlite3_bind_int64(upsertStmt, 1, static_cast<sqlite3_int64>(kv.first));
+        sqlite3_bind_int(upsertStmt, 2, slot.entry.depth);
+        sqlite3_bind_text(upsertStmt, 3, text.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(upsertStmt);
+        sqlite3_reset(upsertStmt);
+        slot.dirty = false;
+    }
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    dirtyCount = 0;
+}
+
+// One line per EngineLine: "depth score mate pv..."; the first PV move is
+// the line's move
+std::string EvalCache::encodeLines(const std::vector<EngineLine>& lines) {
+    std::ostringstream out;
+    for (const EngineLine& line : lines) {
+        out << line.depth << ' ' << line.score << ' ' << line.mate;
+        for (const std::string& move : line.pv) out << ' ' << move;
+        out << '\n';
+    }
+    return out.str();
+}
+
+std::vector<EngineLine> EvalCache::decodeLines(const std::string& text) {
+    std::vector<EngineLine> lines;
+    std::istringstream in(text);
+    std::string row;
+    while (std::getline(in, row)) {
+        std::istringstream fields(row);
+        EngineLine line;
+        if (!(fields >> line.depth >> line.score >> line.mate)) continue;
+        std::string move;
+        while (fields >> move) line.pv.push_back(move);
+        if (line.pv.empty()) continue;
+        line.move = line.pv[0];
+        lines.push_back(line);
+    }
+    return lines;
+}
@@ -0,0 +1,56 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AnalysisEngine.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// Engine results by position, kept across sessions. Keys are Position
+// Zobrist keys; each entry holds the deepest lines seen for the position.
+// Lookups are served from memory and fall back to one primary-key SELECT,
+// so a hit costs well under a frame. Writes are buffered until flush().
+// Stored in the eval_cache table of the user database (SQLite, WAL), on a
+// connection of its own so UserDB is unaffected.
+class EvalCache {
+public:
+    struct Entry {
+        int depth = 0;                  // depth of lines[0]
+        std::vector<EngineLine> lines;  // best first, as the engine reported them
+    };
+
+    explicit EvalCache(const std::string& path);
+    ~EvalCache();
+
+    bool open();
+    void close();
+
+    // True and fills entry if the position has been analysed before
+    bool lookup(uint64_t key, Entry& entry);
+    // Keeps lines if they are at least as deep as what is cached
+    void store(uint64_t key, const std::vector<EngineLine>& lines);
+    // Writes the buffered entries in one transaction
+    void flush();
+
+private:
+    struct Slot {
+        Entry entry;
+        bool dirty;
+    };
+
+    std::string dbPath;
+    sqlite3* db = nullptr;
+    sqlite3_stmt* selectStmt = nullptr;
+    sqlite3_stmt* upsertStmt = nullptr;
+    std::unordered_map<uint64_t, Slot> memory;
+    size_t dirtyCount = 0;
+
+    static std::string encodeLines(const std::vector<EngineLine>& lines);
+    static std::vector<EngineLine> decodeLines(const std::string& text);
+};
+
+#endif // EVAL_CACHE_H
@@ -0,0 +1,126 @@
+#include "Evaluate.h"
+
+const int PieceValue[7] = { 100, 320, 330, 500, 900, 0, 0 };
+
+namespace {
+
+// Piece-square tables from White's point of view, written rank 8 first so
+// they read like a diagram. White looks up sq ^ 56, Black looks up sq.
+const int PawnTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+const int KnightTable[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+const int BishopTable[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+const int RookTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+
+const int QueenTable[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+const int KingMiddlegameTable[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20
+};
+
+const int KingEndgameTable[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+const int* const PieceTables[5] = { PawnTable, KnightTable, BishopTable, RookTable, QueenTable };
+
+// Game phase weight per piece type; 24 with all minor and major pieces on
+const int PhaseWeight[5] = { 0, 1, 1, 2, 4 };
+const int TotalPhase = 24;
+const int BishopPairBonus = 30;
+
+} // namespace
+
+int evaluate(const Position& pos) {
+    int material = 0;   // White minus Black, everything but the king
+    int phase = 0;
+    int kingMg = 0;
+    int kingEg = 0;
+
+    for (int c = 0; c < 2; ++c) {
+        PieceColor color = static_cast<PieceColor>(c);
+        int sign = (color == PieceColor::WHITE) ? 1 : -1;
+        int flip = (color == PieceColor::WHITE) ? 56 : 0;
+
+        for (int t = 0; t < 5; ++t) {
+            Bitboard b = pos.pieces(color, static_cast<PieceType>(t));
+            phase += PhaseWeight[t] * popCount(b);
+            while (b) {
+                int sq = popLsb(b);
+                material += sign * (PieceValue[t] + PieceTables[t][sq ^ flip]);
+            }
+        }
+        if (popCount(pos.pieces(color, PieceType::BISHOP)) >= 2) material += sign * BishopPairBonus;
+
+        int ksq = pos.kingSquare(color);
+        if (ksq != SQUARE_NONE) {
+            kingMg += sign * KingMiddlegameTable[ksq ^ flip];
+            kingEg += sign * KingEndgameTable[ksq ^ flip];
+        }
+    }
+
+    if (phase > TotalPhase) phase = TotalPhase;
+    int score = material + (kingMg * phase + kingEg * (TotalPhase - phase)) / TotalPhase;
+    return (pos.getSideToMove() == PieceColor::WHITE) ? score : -score;
+}
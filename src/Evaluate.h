@@ -0,0 +1,13 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "Position.h"
+
+// Centipawn values indexed by PieceType (king and NONE count as 0)
+extern const int PieceValue[7];
+
+// Static evaluation in centipawns from the side to move's point of view:
+// material, piece-square tables and a king table tapered by game phase.
+int evaluate(const Position& pos);
+
+#endif // EVALUATE_H
@@ -13,30 +13,88 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
-#include <ctime>
+#include <thread>
 #include <windows.h>
 #include <commdlg.h>
 #include <cctype>
 
+namespace {
+
+// Live analysis: number of lines shown as arrows and in the panel
+const int ANALYSIS_LINES = 3;
+// Whole-game review: engines started on the first R press. Each one is spawned
+// and goes through the UCI handshake on the UI thread, so keep the count small.
+const int REVIEW_ENGINES = 3;
+// Seconds between writes of new analysis to the evaluation cache; each write
+// is one SQLite transaction, too slow to run on every position change
+const float EVAL_FLUSH_SECONDS = 10.0f;
+
+// Analysis budgets the B key cycles through; 0 leaves a limit unset
+struct BudgetPreset {
+	int depth;
+	int movetimeMs;
+	uint64_t nodes;
+};
+const BudgetPreset ANALYSIS_BUDGETS[] = {
+	{ 12, 0, 0 }, { 15, 0, 0 }, { 20, 0, 0 }, { 25, 0, 0 },
+	{ 0, 1000, 0 }, { 0, 3000, 0 }, { 0, 10000, 0 },
+	{ 0, 0, 1000000 }, { 0, 0, 10000000 },
+};
+const int ANALYSIS_BUDGET_COUNT = sizeof(ANALYSIS_BUDGETS) / sizeof(ANALYSIS_BUDGETS[0]);
+
+// Appends a typed character to UTF-8 text, so dashes in "1600–1800" reach
+// PuzzleFilter::parse as it expects them
+void appendUtf8(std::string& text, uint32_t c) {
+	if (c < 0x80) {
+		text += static_cast<char>(c);
+	} else if (c < 0x800) {
+		text += static_cast<char>(0xC0 | (c >> 6));
+		text += static_cast<char>(0x80 | (c & 0x3F));
+	} else if (c < 0x10000) {
+		text += static_cast<char>(0xE0 | (c >> 12));
+		text += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+		text += static_cast<char>(0x80 | (c & 0x3F));
+	} else {
+		text += static_cast<char>(0xF0 | (c >> 18));
+		text += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+		text += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+		text += static_cast<char>(0x80 | (c & 0x3F));
+	}
+}
+
+// The limits a budget sets, e.g. "depth 15", "3 s" or "1M nodes"
+std::string describeBudget(const SearchLimits& limits) {
+	std::string text;
+	if (limits.depth > 0) text = "depth " + std::to_string(limits.depth);
+	if (limits.movetimeMs > 0) {
+		if (!text.empty()) text += ", ";
+		if (limits.movetimeMs % 1000 == 0) text += std::to_string(limits.movetimeMs / 1000) + " s";
+		else text += std::to_string(limits.movetimeMs) + " ms";
+	}
+	if (limits.nodes > 0) {
+		if (!text.empty()) text += ", ";
+		if (limits.nodes % 1000000 == 0) text += std::to_string(limits.nodes / 1000000) + "M nodes";
+		else text += std::to_string(limits.nodes) + " nodes";
+	}
+	return text.empty() ? "no limit" : text;
+}
+
+} // namespace
+
 Game::Game(){
 	this->initWindow();
 	board = new Board(this->window);
 
 	// Initialize engine components
-	engine = new StockfishEngine();
+	engine = nullptr;
 	evalBar = new EvalBar(this->window, &font, 352, 0, 40, 352);  // Moved to right of board
 	arrowManager = new ArrowManager(this->window);
 	engineInitialized = false;
 	gameOver = false;
 	puzzleSolved = false;
 	analysisRequested = false;
-	lastAnalyzedFEN = "";
-
-	// Initialize engine in background
-	initEngine();
-
-	// Seed RNG once for varied puzzle sampling
-	std::srand(static_cast<unsigned int>(std::time(nullptr)));
+	shownLinesVersion = 0;
+	lastAnalyzedHash = 0;
 
     // Initialize user DB stored next to the executable for consistent loads
     auto getExecutableDir = []() -> std::string {
@@ -55,6 +113,19 @@ Game::Game(){
     } else {
         std::cout << "UserDB load failed at: " << dbPath << std::endl;
     }
+    infiniteAnalysis = userDb->getAnalysisInfinite();
+    analysisBudget.depth = userDb->getAnalysisDepth();
+    analysisBudget.movetimeMs = userDb->getAnalysisMovetime();
+    analysisBudget.nodes = static_cast<uint64_t>(userDb->getAnalysisNodes());
+    puzzlePrefetcher.setDepth(static_cast<size_t>(userDb->getPuzzlePrefetch()));
+    evalCache = new EvalCache(dbPath);
+    if (!evalCache->open()) {
+        std::cout << "Evaluation cache unavailable at: " << dbPath << std::endl;
+        delete evalCache;
+        evalCache = nullptr;
+    }
+    // The engine starts once the settings and cache it analyses with are loaded
+    initEngine();
     if (puzzleFilePath.empty()) {
         puzzleFilePath = userDb->getLastCsvPath();
         if (!puzzleFilePath.empty()) {
@@ -70,10 +141,19 @@ Game::Game(){
 }
 
 Game::~Game(){
+	stopPlay();
+	delete opponent;
+	delete review;
+	delete reviewPool;
 	delete board;
 	delete engine;
 	delete evalBar;
 	delete arrowManager;
+	delete evalCache;
+	// The prefetcher and the tag indexer may be reading from the source; wait them out first
+	puzzlePrefetcher.reset(nullptr);
+	stopPuzzleTags();
+	delete puzzleSource;
 	if (userDb) { userDb->save(); delete userDb; userDb = nullptr; }
 
 	// Clean up buttons
@@ -100,55 +180,29 @@ void Game::run(){
 		// Update buttons
 		updateButtons();
 
-		// Check for analysis updates periodically (non-blocking)
-		if (engineInitialized && analysisRequested && analysisClock.getElapsedTime().asMilliseconds() > 500) {
-			// Get best lines without blocking
-			auto lines = engine->getBestLines(3);
-
-			if (!lines.empty()) {
-				// Store lines for display
-				currentLines = lines;
-
-				// Update eval bar with mate distance if available (White POV)
-				{
-					const EngineLine& top = lines[0];
-					PieceColor turnForEval = board->getCurrentTurn();
-					if (top.mate != 0) {
-						bool whiteWinning = (turnForEval == PieceColor::WHITE) ? (top.mate > 0) : (top.mate < 0);
-						evalBar->setMateEvaluation(top.mate, whiteWinning);
-
-						// Immediate mate on board => stop analysis and mark game over
-						if (top.mate == 0 && !gameOver) {
-							engine->stopAnalysis();
-							analysisRequested = false;
-							gameOver = true;
-							setStatusMessage("Checkmate - game over");
-						}
-					} else {
-						int evalForWhite = (turnForEval == PieceColor::BLACK) ? -top.score : top.score;
-						evalBar->setEvaluation(static_cast<float>(evalForWhite));
-					}
-				}
-
-				// Update arrows
-				arrowManager->clearArrows();
-				for (size_t i = 0; i < lines.size() && i < 3; i++) {
-					if (lines[i].pv.size() >= 1) {
-						std::string move = lines[i].pv[0];
-						if (move.length() >= 4) {
-							std::string from = move.substr(0, 2);
-							std::string to = move.substr(2, 2);
-							from[0] = toupper(from[0]);
-							to[0] = toupper(to[0]);
-							arrowManager->addArrow(from, to, i);
-						}
-					}
-				}
+		// Pick up new analysis as soon as the engine publishes it; the version
+		// check is O(1), so this costs nothing on frames without new output
+		uint64_t linesVersion = engineInitialized && analysisRequested ? engine->getLinesVersion() : shownLinesVersion;
+		if (linesVersion != shownLinesVersion) {
+			shownLinesVersion = linesVersion;
+			auto lines = engine->getBestLines(ANALYSIS_LINES);
+
+			// A new search starts shallow; keep a deeper cached result on screen
+			if (!lines.empty() && lines[0].depth >= shownDepth) {
+				if (evalCache) evalCache->store(analysisKey, lines);
+				showLines(lines);
 			}
-
-			analysisRequested = false;
+		}
+		// A filter turned on while its file's themes were being indexed
+		if (puzzleFilterOn && puzzleFilterRows.empty() && puzzleTagsReady) puzzleFilterOn = applyPuzzleFilter();
+		if (evalCache && evalFlushClock.getElapsedTime().asSeconds() >= EVAL_FLUSH_SECONDS) {
+			evalCache->flush();
+			evalFlushClock.restart();
 		}
 
+		updateReview();
+		updatePlay();
+
 		this->render();
 	}
 
@@ -210,6 +264,9 @@ void Game::render(){
 
     // Render analysis panel
     renderAnalysisPanel();
+    renderPlayPanel();
+    renderReviewPanel();
+    renderEngineMetrics();
 
     // Render promotion dialog on top if open
     if (promotionOpen) {
@@ -298,6 +355,12 @@ void Game::processEvents(){
 
 		
 
+		// While a puzzle filter is being typed, keys edit it instead of acting as shortcuts
+		if (editingFilter && (event.type == sf::Event::TextEntered || event.type == sf::Event::KeyPressed)) {
+			editFilter(event);
+			continue;
+		}
+
 		// Keyboard events
 		if (event.type == sf::Event::KeyPressed)
 		{
@@ -366,8 +429,11 @@ void Game::processEvents(){
 
             // Only process board clicks if no button was clicked and no promotion dialog
             if (!buttonClicked && !promotionOpen) {
-				// Left click - pick up piece
-				if (event.mouseButton.button == sf::Mouse::Left) {
+				// Left click - pick up piece (not the engine's, while playing it)
+				if (event.mouseButton.button == sf::Mouse::Left && playMode && board->getCurrentTurn() == engineColor) {
+					setStatusMessage("Engine is thinking");
+				}
+				else if (event.mouseButton.button == sf::Mouse::Left) {
 					board->handleClick(userWantedString);
 					startingPosition=userWantedString+"->";
 					remainWithThisColor=false;
@@ -453,10 +519,10 @@ void Game::processEvents(){
 				printSecTextLine=true;
 
 				// Trigger analysis update after move (non-blocking)
-				std::string currentFEN = board->getFEN();
-				if (currentFEN != lastAnalyzedFEN) {
+				uint64_t currentHash = board->getHash();
+				if (currentHash != lastAnalyzedHash) {
 					if (!puzzleMode || puzzleAnalysisEnabled) updateAnalysis();
-					lastAnalyzedFEN = currentFEN;
+					lastAnalyzedHash = currentHash;
 				}
 			}
 		}
@@ -635,38 +701,115 @@ void Game::renderText(sf::Color color,int yPosition,std::string textToRender){
 void Game::initEngine() {
 	std::cout << "Initializing Stockfish engine..." << std::endl;
 
-	// Try to initialize engine (path relative to executable)
-	if (engine->initialize("engines/stockfish.exe")) {
-		engineInitialized = true;
+	// Stockfish if it starts (path relative to executable), otherwise the
+	// built-in engine so analysis still works
+	engine = createEngine();
+	engineInitialized = engine != nullptr;
+	if (engineInitialized) {
 		std::cout << "Engine initialized successfully!" << std::endl;
 
 		// Start initial analysis
 		updateAnalysis();
 	} else {
 		std::cout << "Failed to initialize engine. Analysis features disabled." << std::endl;
-		engineInitialized = false;
 	}
 }
 
+// Live analysis and the play opponent both take half the cores and the
+// hash size saved in the user settings
+AnalysisEngine* Game::createEngine() const {
+	AnalysisEngine* created = EnginePool::createDefaultEngine();
+	if (!created) return nullptr;
+	unsigned int cores = std::thread::hardware_concurrency();
+	created->setThreads(cores > 1 ? static_cast<int>(cores / 2) : 1);
+	created->setHashSize(userDb ? userDb->getEngineHash() : 64); // MB
+	return created;
+}
+
 void Game::updateAnalysis() {
-	if (!engineInitialized || gameOver || (puzzleMode && !puzzleAnalysisEnabled)) return;
+	if (!engineInitialized || gameOver || playMode || (puzzleMode && !puzzleAnalysisEnabled)) return;
 
 	// Get current position from board
 	std::string fen = board->getFEN();
+	analysisKey = board->getHash();
+	shownDepth = 0;
+
+	// Infinite analysis keeps deepening until the next position is sent; the
+	// reader thread streams every depth, so the first eval shows within a
+	// few milliseconds and keeps refining
+	SearchLimits limits = infiniteAnalysis ? SearchLimits() : analysisBudget;
+
+	// Positions analysed before (this session or an earlier one) show at once;
+	// the engine only runs if the cached result is shallower than we want
+	if (evalCache) {
+		EvalCache::Entry cached;
+		if (evalCache->lookup(analysisKey, cached)) {
+			showLines(cached.lines);
+			if (limits.depth > 0 && cached.depth >= limits.depth) {
+				engine->stopAnalysis();
+				analysisRequested = false;
+				std::cout << "Analysis from cache (depth " << cached.depth << ")" << std::endl;
+				return;
+			}
+		}
+	}
 
 	// Send position to engine
 	engine->sendPosition(fen);
 
-	// Start analysis (depth 15, 3 lines) - NON-BLOCKING
-	engine->startAnalysis(15, 3);
+	// Start analysis - NON-BLOCKING
+	engine->startSearch(limits, ANALYSIS_LINES);
 
-	// Mark that we've requested analysis and restart timer
+	// Mark that we've requested analysis; results are picked up every frame
 	analysisRequested = true;
-	analysisClock.restart();
 
 	std::cout << "Analysis started (non-blocking)" << std::endl;
 }
 
+void Game::showLines(const std::vector<EngineLine>& lines) {
+	if (lines.empty()) return;
+	shownDepth = lines[0].depth;
+
+	// Store lines for display
+	currentLines = lines;
+
+	// Update eval bar with mate distance if available (White POV)
+	{
+		const EngineLine& top = lines[0];
+		PieceColor turnForEval = board->getCurrentTurn();
+		if (top.mate != 0) {
+			bool whiteWinning = (turnForEval == PieceColor::WHITE) ? (top.mate > 0) : (top.mate < 0);
+			evalBar->setMateEvaluation(top.mate, whiteWinning);
+
+			// Immediate mate on board => stop analysis and mark game over
+			if (top.mate == 0 && !gameOver) {
+				engine->stopAnalysis();
+				analysisRequested = false;
+				gameOver = true;
+				setStatusMessage("Checkmate - game over");
+			}
+		} else {
+			int evalForWhite = (turnForEval == PieceColor::BLACK) ? -top.score : top.score;
+			evalBar->setEvaluation(static_cast<float>(evalForWhite));
+		}
+	}
+
+	// Update arrows
+	arrowManager->clearArrows();
+	for (size_t i = 0; i < lines.size() && i < 3; i++) {
+		if (lines[i].pv.size() >= 1) {
+			std::string move = lines[i].pv[0];
+			if (move.length() >= 4) {
+				std::string from = move.substr(0, 2);
+				std::string to = move.substr(2, 2);
+				from[0] = toupper(from[0]);
+				to[0] = toupper(to[0]);
+				arrowManager->addArrow(from, to, i);
+			}
+		}
+	}
+}
+
 void Game::handleKeyboard(sf::Event::KeyEvent key) {
 	// E key - toggle eval bar
 	if (key.code == sf::Keyboard::E) {
@@ -683,6 +826,169 @@ void Game::handleKeyboard(sf::Event::KeyEvent key) {
 			std::cout << "Arrows toggled" << std::endl;
 		}
 	}
+
+	// I key - switch between infinite analysis and the configured budget
+	if (key.code == sf::Keyboard::I) {
+		infiniteAnalysis = !infiniteAnalysis;
+		if (userDb) {
+			userDb->setAnalysisInfinite(infiniteAnalysis);
+			userDb->save();
+		}
+		setStatusMessage(infiniteAnalysis ? "Infinite analysis" : "Analysis budget: " + describeBudget(analysisBudget));
+		updateAnalysis();
+	}
+
+	// B key - next analysis budget preset; switches infinite analysis off
+	if (key.code == sf::Keyboard::B) {
+		int next = 0;
+		for (int i = 0; i < ANALYSIS_BUDGET_COUNT; ++i) {
+			const BudgetPreset& b = ANALYSIS_BUDGETS[i];
+			if (b.depth == analysisBudget.depth && b.movetimeMs == analysisBudget.movetimeMs && b.nodes == analysisBudget.nodes) {
+				next = (i + 1) % ANALYSIS_BUDGET_COUNT;
+			}
+		}
+		const BudgetPreset& preset = ANALYSIS_BUDGETS[next];
+		analysisBudget.depth = preset.depth;
+		analysisBudget.movetimeMs = preset.movetimeMs;
+		analysisBudget.nodes = preset.nodes;
+		infiniteAnalysis = false;
+		if (userDb) {
+			userDb->setAnalysisBudget(preset.depth, preset.movetimeMs, static_cast<long long>(preset.nodes));
+			userDb->setAnalysisInfinite(false);
+			userDb->save();
+		}
+		setStatusMessage("Analysis budget: " + describeBudget(analysisBudget));
+		updateAnalysis();
+	}
+
+	// P key - play the engine from this position, or stop playing
+	if (key.code == sf::Keyboard::P) {
+		if (playMode) {
+			stopPlay();
+			setStatusMessage("Stopped playing the engine");
+			updateAnalysis();
+		} else {
+			startPlay();
+		}
+	}
+
+	// M key - engine latency overlay
+	if (key.code == sf::Keyboard::M) {
+		showEngineMetrics = !showEngineMetrics;
+	}
+
+	// L key - write the engine I/O log to a file
+	if (key.code == sf::Keyboard::L) {
+		dumpEngineLog();
+	}
+
+	// F key - in puzzle mode, draw only puzzles matching the saved filter;
+	// Ctrl+F types a new filter, Shift+F makes the current puzzle's themes the filter
+	if (key.code == sf::Keyboard::F && puzzleMode && userDb) {
+		if (key.control) {
+			editingFilter = true;
+			filterDraft = userDb->getPuzzleFilter();
+		} else if (key.shift) {
+			for (const auto& kv : puzzleMetaKVs) {
+				if (kv.first == "Themes") userDb->setPuzzleFilter(kv.second);
+			}
+			userDb->save();
+			puzzleFilterOn = applyPuzzleFilter();
+		} else if (puzzleFilterOn) {
+			puzzleFilterOn = false;
+			puzzleFilterRows.clear();
+			puzzlePrefetcher.setFilter(puzzleFilterRows);
+			setStatusMessage("Puzzle filter off");
+		} else {
+			puzzleFilterOn = applyPuzzleFilter();
+		}
+	}
+
+	// R key - review the game played so far
+	if (key.code == sf::Keyboard::R && !puzzleMode) {
+		startReview();
+	}
+}
+
+void Game::startReview() {
+	if (board->getMoveCount() == 0) {
+		setStatusMessage("No moves to review");
+		return;
+	}
+	if (!reviewPool) {
+		// Separate engines from the live analysis, one thread each
+		int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+		reviewPool = new EnginePool(std::min(REVIEW_ENGINES, cores), 1, 16);
+		if (!reviewPool->start()) {
+			delete reviewPool;
+			reviewPool = nullptr;
+			setStatusMessage("Review: no engine available");
+			return;
+		}
+		SearchLimits limits;
+		limits.depth = 14;
+		review = new GameReview(*reviewPool, limits);
+	}
+	if (review->start(board->getPosition())) {
+		setStatusMessage("Reviewing " + std::to_string(board->getMoveCount()) + " moves...");
+	} else {
+		setStatusMessage("Review failed");
+	}
+}
+
+void Game::updateReview() {
+	if (!review || !review->isWaiting()) return;
+
+	// Non-blocking: takes whatever the pool finished since the last frame
+	if (!review->update().empty() && review->isComplete()) {
+		std::ostringstream summary;
+		summary << std::fixed << std::setprecision(1) << "Review done: W " << review->accuracy(PieceColor::WHITE)
+		        << "% B " << review->accuracy(PieceColor::BLACK) << "%";
+		setStatusMessage(summary.str());
+		std::cout << review->report();
+	}
+}
+
+void Game::renderReviewPanel() {
+	if (!review || puzzleMode || review->moves().empty()) return;
+
+	// Below the analysis lines, down to the bottom of the window
+	const float top = 450.0f;
+	sf::RectangleShape panel;
+	panel.setSize(sf::Vector2f(352.0f, static_cast<float>(window->getSize().y) - top));
+	panel.setPosition(0.0f, top);
+	panel.setFillColor(sf::Color(25, 25, 25));
+	window->draw(panel);
+
+	sf::Text text;
+	text.setFont(font);
+	text.setCharacterSize(14);
+	text.setFillColor(sf::Color::White);
+	std::ostringstream header;
+	header << std::fixed << std::setprecision(1) << "Review " << review->evaluatedMoves() << "/" << review->moves().size()
+	       << "   White " << review->accuracy(PieceColor::WHITE) << "%   Black " << review->accuracy(PieceColor::BLACK) << "%";
+	text.setString(header.str());
+	text.setPosition(8.0f, top + 6.0f);
+	window->draw(text);
+
+	// The flagged moves, in game order, as many as fit
+	text.setCharacterSize(13);
+	float y = top + 30.0f;
+	for (const MoveReview& r : review->moves()) {
+		if (y > window->getSize().y - 18.0f) break;
+		if (!r.evaluated || r.moveClass < MOVE_CLASS_INACCURACY) continue;
+
+		std::ostringstream row;
+		row << r.moveNumber << (r.mover == PieceColor::WHITE ? ". " : "... ") << r.san << "  " << moveClassName(r.moveClass)
+		    << "  -" << r.cpLoss << " cp   best " << r.bestMove;
+		text.setString(row.str());
+		if (r.moveClass == MOVE_CLASS_BLUNDER) text.setFillColor(sf::Color(230, 60, 60));
+		else if (r.moveClass == MOVE_CLASS_MISTAKE) text.setFillColor(sf::Color(240, 150, 40));
+		else text.setFillColor(sf::Color(230, 210, 80));
+		text.setPosition(8.0f, y);
+		window->draw(text);
+		y += 18.0f;
+	}
 }
 
 void Game::initButtons() {
@@ -700,6 +1006,10 @@ void Game::initButtons() {
     // Undo button
     undoButton = new Button(window, &font, "Undo", panelX + 10, 10, buttonWidth, buttonHeight);
 	undoButton->setOnClick([this]() {
+		if (playMode) {
+			takeBackInPlay();
+			return;
+		}
 		if (board->canUndo()) {
 			board->undoLastMove();
 			updateAnalysis();
@@ -766,6 +1076,7 @@ void Game::initButtons() {
 				std::string pgn((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 				file.close();
 				std::cout << "File read, loading into board..." << std::endl;
+				stopPlay();
 				board->loadPGN(pgn);
 				setStatusMessage("Game loaded!");
 				std::cout << "SUCCESS: PGN loaded from " << filePath << std::endl;
@@ -785,6 +1096,7 @@ void Game::initButtons() {
     newGameButton = new Button(window, &font, "New Game", panelX + 10, 10 + (buttonHeight + spacing) * 3, buttonWidth, buttonHeight);
     newGameButton->setOnClick([this]() {
         // Reset game state
+        stopPlay();
         board->reset();
         arrowManager->clearArrows();
         currentLines.clear();
@@ -793,10 +1105,10 @@ void Game::initButtons() {
 
         // Reset eval bar and analysis
         if (evalBar) evalBar->setEvaluation(0.0f);
-        lastAnalyzedFEN.clear();
+        lastAnalyzedHash = 0;
         if (engineInitialized) {
             updateAnalysis();
-            lastAnalyzedFEN = board->getFEN();
+            lastAnalyzedHash = board->getHash();
         }
     });
     buttons.push_back(newGameButton);
@@ -804,6 +1116,7 @@ void Game::initButtons() {
     // Puzzle Mode button
     puzzleModeButton = new Button(window, &font, "Puzzle Mode", panelX + 10, 10 + (buttonHeight + spacing) * 4, buttonWidth, buttonHeight);
     puzzleModeButton->setOnClick([this]() {
+        stopPlay();
         // If memory path is empty but DB has a saved path, use it
         if (puzzleFilePath.empty() && userDb && !userDb->getLastCsvPath().empty()) {
             puzzleFilePath = userDb->getLastCsvPath();
@@ -955,8 +1268,23 @@ void Game::renderUI() {
 			window->draw(ratingText);
 		}
 
+		// The filter being typed takes the status line until Enter or Esc
+		if (editingFilter) {
+			// The panel fits about 28 characters; keep the end, where typing happens
+			std::string shown = filterDraft;
+			size_t cut = shown.size() > 26 ? shown.size() - 26 : 0;
+			while (cut > 0 && cut < shown.size() && (static_cast<unsigned char>(shown[cut]) & 0xC0) == 0x80) cut++;
+			shown = (cut ? "..." : "") + shown.substr(cut);
+			sf::Text filterText;
+			filterText.setFont(font);
+			filterText.setString(sf::String::fromUtf8(shown.begin(), shown.end()) + "_");
+			filterText.setCharacterSize(14);
+			filterText.setFillColor(sf::Color::Yellow);
+			filterText.setPosition(400.0f, baseY + 30.0f);
+			window->draw(filterText);
+		}
 		// Render status message (fades after 3 seconds) just below turn indicator
-		if (!statusMessage.empty() && statusClock.getElapsedTime().asSeconds() < 3.0f) {
+		else if (!statusMessage.empty() && statusClock.getElapsedTime().asSeconds() < 3.0f) {
 			sf::Text statusText;
 			statusText.setFont(font);
 			statusText.setString(statusMessage);
@@ -1013,6 +1341,124 @@ void Game::renderUI() {
 		arrowIndicator.setStyle(sf::Text::Bold);
 		arrowIndicator.setPosition(520.0f, helpY);
 		window->draw(arrowIndicator);
+
+		// I key - infinite analysis toggle
+		helpY += 20.0f;
+		helpText.setString("I - Infinite analysis");
+		helpText.setFillColor(sf::Color(180, 180, 180));
+		helpText.setPosition(400.0f, helpY);
+		window->draw(helpText);
+
+		sf::Text infiniteIndicator;
+		infiniteIndicator.setFont(font);
+		infiniteIndicator.setCharacterSize(12);
+		infiniteIndicator.setString(infiniteAnalysis ? "ON" : "OFF");
+		infiniteIndicator.setFillColor(infiniteAnalysis ? sf::Color::Green : sf::Color::Red);
+		infiniteIndicator.setStyle(sf::Text::Bold);
+		infiniteIndicator.setPosition(520.0f, helpY);
+		window->draw(infiniteIndicator);
+
+		// B key - analysis budget used when infinite analysis is off
+		helpY += 20.0f;
+		helpText.setString("B - Analysis budget");
+		helpText.setFillColor(sf::Color(180, 180, 180));
+		helpText.setPosition(400.0f, helpY);
+		window->draw(helpText);
+
+		sf::Text budgetIndicator;
+		budgetIndicator.setFont(font);
+		budgetIndicator.setCharacterSize(12);
+		budgetIndicator.setString(describeBudget(analysisBudget));
+		budgetIndicator.setFillColor(infiniteAnalysis ? sf::Color(120, 120, 120) : sf::Color::Green);
+		budgetIndicator.setStyle(sf::Text::Bold);
+		budgetIndicator.setPosition(520.0f, helpY);
+		window->draw(budgetIndicator);
+
+		// P key - play versus engine
+		helpY += 20.0f;
+		helpText.setString("P - Play engine");
+		helpText.setFillColor(sf::Color(180, 180, 180));
+		helpText.setPosition(400.0f, helpY);
+		window->draw(helpText);
+
+		sf::Text playIndicator;
+		playIndicator.setFont(font);
+		playIndicator.setCharacterSize(12);
+		playIndicator.setString(playMode ? "ON" : "OFF");
+		playIndicator.setFillColor(playMode ? sf::Color::Green : sf::Color::Red);
+		playIndicator.setStyle(sf::Text::Bold);
+		playIndicator.setPosition(520.0f, helpY);
+		window->draw(playIndicator);
+
+		// M / L keys - engine metrics
+		helpY += 20.0f;
+		helpText.setString("M - Engine metrics, L - Dump log");
+		helpText.setFillColor(sf::Color(180, 180, 180));
+		helpText.setPosition(400.0f, helpY);
+		window->draw(helpText);
+
+		// R key - game review
+		helpY += 20.0f;
+		helpText.setString("R - Review game");
+		helpText.setFillColor(sf::Color(180, 180, 180));
+		helpText.setPosition(400.0f, helpY);
+		window->draw(helpText);
+	}
+}
+
+void Game::renderEngineMetrics() {
+	// While playing, the opponent's link is the interesting one
+	AnalysisEngine* source = playMode && opponent ? opponent : (engineInitialized ? engine : nullptr);
+	const EngineLog* log = source ? source->getLog() : nullptr;
+	if (!showEngineMetrics || !log) return;
+
+	EngineMetrics m = log->metrics();
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(1);
+	text << (source == opponent ? "Opponent" : "Analysis") << " engine, search " << m.searchId << "\n";
+	text << "first info  " << (m.firstInfoMs < 0 ? std::string("-") : std::to_string(m.firstInfoMs) + " ms") << "\n";
+	text << "depth " << m.depth << " at " << m.depthMs << " ms";
+	if (m.bestMoveMs >= 0) text << ", bestmove " << m.bestMoveMs << " ms";
+	text << "\n";
+	text << "depths ";
+	size_t from = m.depthTimes.size() > 6 ? m.depthTimes.size() - 6 : 0;
+	for (size_t i = from; i < m.depthTimes.size(); ++i) {
+		text << m.depthTimes[i].first << "@" << m.depthTimes[i].second << " ";
+	}
+	text << "\n";
+	text << m.linesPerSecond << " lines/s, parse " << std::setprecision(2) << m.parseUsPerLine << " us/line\n";
+	text << "reader batch " << m.lastBatchLines << " (max " << m.maxBatchLines << "), "
+	     << m.pendingBytes << " B pending\n";
+	text << m.commandsSent << " sent, " << m.linesReceived << " received";
+
+	sf::RectangleShape box;
+	box.setSize(sf::Vector2f(300.0f, 128.0f));
+	box.setPosition(6.0f, 6.0f);
+	box.setFillColor(sf::Color(0, 0, 0, 200));
+	window->draw(box);
+
+	sf::Text overlay;
+	overlay.setFont(font);
+	overlay.setCharacterSize(12);
+	overlay.setFillColor(sf::Color(120, 255, 120));
+	overlay.setString(text.str());
+	overlay.setPosition(12.0f, 10.0f);
+	window->draw(overlay);
+}
+
+void Game::dumpEngineLog() {
+	AnalysisEngine* source = playMode && opponent ? opponent : (engineInitialized ? engine : nullptr);
+	const EngineLog* log = source ? source->getLog() : nullptr;
+	if (!log) {
+		setStatusMessage("No engine log");
+		return;
+	}
+	const std::string path = "engine_log.txt";
+	if (log->dump(path)) {
+		setStatusMessage("Engine log written to " + path);
+		std::cout << "Engine log written to " << path << std::endl;
+	} else {
+		setStatusMessage("Could not write " + path);
 	}
 }
 
@@ -1022,147 +1468,154 @@ void Game::setStatusMessage(const std::string& message) {
 }
 
 // --- Puzzle helpers ---
-static std::vector<std::string> csvSplitLine(const std::string& line) {
-    std::vector<std::string> fields; std::string cur; bool inQuotes = false;
-    for (size_t i = 0; i < line.size(); ++i) {
-        char c = line[i];
-        if (c == '"') inQuotes = !inQuotes;
-        else if (c == ',' && !inQuotes) { fields.push_back(cur); cur.clear(); }
-        else cur.push_back(c);
-    }
-    fields.push_back(cur);
-    // Strip quotes for each field if present
-    for (auto& f : fields) {
-        if (f.size() >= 2 && f.front() == '"' && f.back() == '"') {
-            f = f.substr(1, f.size()-2);
-        }
-    }
-    return fields;
+static std::string joinWords(const std::vector<std::string>& words) {
+    std::string out; for (size_t i = 0; i < words.size(); ++i) { if (i) out += ' '; out += words[i]; } return out;
 }
 
-static std::vector<std::string> splitUciMoves(const std::string& moves) {
-    std::vector<std::string> out; std::istringstream iss(moves); std::string m; while (iss >> m) out.push_back(m); return out;
+bool Game::openPuzzleSource() {
+    if (puzzleSource && puzzleSource->isOpen() && puzzleSource->getPath() == puzzleFilePath) return true;
+    puzzlePrefetcher.reset(nullptr);
+    stopPuzzleTags();
+    delete puzzleSource;
+    // A .pzl pack is mapped as is; a CSV is mapped and gets <csv>.idx built on first use
+    if (PuzzlePack::isPack(puzzleFilePath)) puzzleSource = new PuzzlePack();
+    else puzzleSource = new PuzzleStore();
+    if (!puzzleSource->open(puzzleFilePath)) return false;
+    // A new file starts a new session of unseen puzzles, and its own tag index
+    puzzlePrefetcher.reset(puzzleSource);
+    puzzleFilterRows.clear();
+    startPuzzleTags();
+    return true;
 }
 
-bool Game::loadRandomPuzzle() {
-    if (puzzleFilePath.empty()) return false;
-    // Ensure headers are loaded
-    if (puzzleHeaders.empty()) {
-        std::ifstream hf(puzzleFilePath);
-        if (hf.is_open()) {
-            std::string header;
-            if (std::getline(hf, header)) {
-                puzzleHeaders = csvSplitLine(header);
-            }
-            hf.close();
-        }
-    }
-
-    std::ifstream f(puzzleFilePath, std::ios::in | std::ios::binary);
-    if (!f.is_open()) return false;
+void Game::startPuzzleTags() {
+    // Loading <file>.tags takes milliseconds, but building it the first time a
+    // file is used takes seconds on the full Lichess set, so it never runs on
+    // the UI thread; a filter asked for meanwhile applies once it is done
+    puzzleTags.clear();
+    puzzleTagsOpened = false;
+    puzzleTagsReady = false;
+    const PuzzleSource* source = puzzleSource;
+    puzzleTagsThread = std::thread([this, source]() {
+        puzzleTagsOpened = puzzleTags.open(*source);
+        puzzleTagsReady = true;
+    });
+}
 
-    // Get file size
-    f.seekg(0, std::ios::end);
-    std::streamoff fileSize = f.tellg();
-    if (fileSize <= 0) { f.close(); return false; }
-    // Working variable for selected CSV line
-    std::string chosen;
+void Game::stopPuzzleTags() {
+    if (puzzleTagsThread.joinable()) puzzleTagsThread.join();
+}
 
-        // If there is a pending review puzzle, serve it first
-    if (userDb && !userDb->getReviewQueue().empty()) {
-        // helper to lowercase strings
-        auto toLower = [](std::string s){ for (auto& c : s) c = (char)tolower((unsigned char)c); return s; };
-        std::string reviewId = userDb->getReviewQueue().front();
-        // Scan file to find exact line by PuzzleId
-        std::ifstream rf(puzzleFilePath);
-        if (rf.is_open()) {
-            std::string header; std::getline(rf, header);
-            std::string line;
-            while (std::getline(rf, line)) {
-                if (!line.empty() && line.back() == '\r') line.pop_back();
-                auto fields2 = csvSplitLine(line);
-                int idIdx = -1; // find PuzzleId column index (cached below)
-                for (size_t i = 0; i < puzzleHeaders.size(); ++i) { if (toLower(puzzleHeaders[i]) == "puzzleid") { idIdx = (int)i; break; } }
-                if (idIdx >= 0 && (size_t)idIdx < fields2.size() && fields2[idIdx] == reviewId) {
-                    chosen = line;
-                    // Pop served review item
-                    if (userDb) { std::string tmp; userDb->popReview(tmp); userDb->save(); }
-                    break;
-                }
-            }
-            rf.close();
-        }
-        if (chosen.empty()) {
-            // If not found, pop it from review to avoid infinite loop
-            std::string tmp; if (userDb->popReview(tmp)) userDb->save();
-        }
+bool Game::applyPuzzleFilter() {
+    puzzleFilterRows.clear();
+    if (!userDb || puzzleFilePath.empty() || !openPuzzleSource()) return false;
+    PuzzleFilter filter;
+    if (!PuzzleFilter::parse(userDb->getPuzzleFilter(), filter)) {
+        setStatusMessage("No puzzle filter set (Ctrl+F to type one)");
+        return false;
+    }
+    // Stays on until the background indexer finishes, then run() applies it
+    if (!puzzleTagsReady) {
+        puzzlePrefetcher.setFilter(puzzleFilterRows);
+        setStatusMessage("Filter: " + filter.describe() + " (indexing puzzle themes...)");
+        return true;
     }
+    if (!puzzleTagsOpened) {
+        setStatusMessage("Could not index puzzle themes");
+        return false;
+    }
+    std::string unknown;
+    puzzleFilterRows = puzzleTags.match(filter, &unknown);
+    if (!unknown.empty()) {
+        setStatusMessage("No puzzles tagged " + unknown);
+        return false;
+    }
+    if (puzzleFilterRows.empty()) {
+        setStatusMessage("No puzzles match " + filter.describe());
+        return false;
+    }
+    puzzlePrefetcher.setFilter(puzzleFilterRows);
+    setStatusMessage("Filter: " + filter.describe() + " (" + std::to_string(puzzleFilterRows.size()) + " puzzles)");
+    return true;
+}
 
-    // Use rating window around current rating if not chosen via review queue
-    int targetRating = userDb ? userDb->getRating() : 1500;
-    int window = 100;
-    for (int attempt = 0; attempt < 200 && chosen.empty(); ++attempt) {
-        std::streamoff offset = static_cast<std::streamoff>(rand()) % fileSize;
-        f.seekg(offset, std::ios::beg);
-        if (offset > 0) { std::string dummy; std::getline(f, dummy); }
-        std::string line;
-        if (!std::getline(f, line)) { f.clear(); f.seekg(0, std::ios::beg); std::getline(f, line); }
-        if (line.rfind("PuzzleId,", 0) == 0) { if (!std::getline(f, line)) { f.clear(); f.seekg(0, std::ios::beg); std::getline(f, line); std::getline(f, line); } }
-        if (!line.empty() && line.back() == '\r') line.pop_back();
-        if (line.empty()) continue;
-        auto fieldsTry = csvSplitLine(line);
-        int idIdx = -1, ratingIdx = -1;
-        for (size_t i = 0; i < puzzleHeaders.size(); ++i) {
-            std::string low = puzzleHeaders[i]; for (auto& c : low) c = (char)tolower((unsigned char)c);
-            if (low == "puzzleid") idIdx = (int)i;
-            else if (low == "rating") ratingIdx = (int)i;
-        }
-        if (ratingIdx >= 0 && (size_t)ratingIdx < fieldsTry.size()) {
-            int r = 0; try { r = std::stoi(fieldsTry[ratingIdx]); } catch (...) { r = targetRating; }
-            if (r >= targetRating - window && r <= targetRating + window) {
-                chosen = line;
-                break;
-            }
+void Game::editFilter(const sf::Event& event) {
+    if (event.type == sf::Event::TextEntered) {
+        // Control characters (including the one Ctrl+F itself types) are not text
+        if (event.text.unicode >= 32 && event.text.unicode != 127) appendUtf8(filterDraft, event.text.unicode);
+        return;
+    }
+    if (event.key.code == sf::Keyboard::BackSpace) {
+        // Drop a whole UTF-8 sequence, not just its last byte
+        while (!filterDraft.empty() && (static_cast<unsigned char>(filterDraft.back()) & 0xC0) == 0x80) filterDraft.pop_back();
+        if (!filterDraft.empty()) filterDraft.pop_back();
+    } else if (event.key.code == sf::Keyboard::Escape) {
+        editingFilter = false;
+        setStatusMessage("Puzzle filter unchanged");
+    } else if (event.key.code == sf::Keyboard::Return) {
+        editingFilter = false;
+        userDb->setPuzzleFilter(filterDraft);
+        userDb->save();
+        PuzzleFilter parsed;
+        if (PuzzleFilter::parse(filterDraft, parsed)) {
+            puzzleFilterOn = applyPuzzleFilter();
+        } else {
+            puzzleFilterOn = false;
+            puzzleFilterRows.clear();
+            puzzlePrefetcher.setFilter(puzzleFilterRows);
+            setStatusMessage("Puzzle filter cleared");
         }
     }
+}
 
-    f.close();
-    if (chosen.empty()) return false;
+bool Game::loadRandomPuzzle() {
+    if (puzzleFilePath.empty() || !openPuzzleSource()) return false;
 
-    std::vector<std::string> fields = csvSplitLine(chosen);
-    if (fields.size() < 3) return false;
+    // Everything below comes prepared by the prefetcher's worker when it kept
+    // up; it reads and parses here only what it has not got ready
+    PreparedPuzzle prepared;
+    bool loaded = false;
+    if (userDb) puzzlePrefetcher.setRating(userDb->getRating());
 
-    // Build metadata KVs for display
-    puzzleMetaKVs.clear();
-    const size_t count = std::min(puzzleHeaders.size(), fields.size());
-    for (size_t i = 0; i < count; ++i) {
-        puzzleMetaKVs.emplace_back(puzzleHeaders[i], fields[i]);
+    // If there is a pending review puzzle, serve it first
+    if (userDb && !userDb->getReviewQueue().empty()) {
+        loaded = puzzlePrefetcher.review(userDb->getReviewQueue().front(), prepared);
+        // Pop it whether served or no longer in the file, so it cannot block the queue
+        std::string tmp; if (userDb->popReview(tmp)) userDb->save();
     }
 
-    // Find FEN and Moves columns by name when possible
-    auto toLower = [](std::string s){ for (auto& c : s) c = (char)tolower((unsigned char)c); return s; };
-    auto findIndex = [&](const std::string& name) -> int {
-        std::string needle = toLower(name);
-        for (size_t i = 0; i < puzzleHeaders.size(); ++i) {
-            if (toLower(puzzleHeaders[i]) == needle) return (int)i;
-        }
-        return -1;
-    };
-    int fenIdx = findIndex("FEN");
-    int movesIdx = findIndex("Moves");
-    int idIdx = findIndex("PuzzleId");
-    if (fenIdx < 0) fenIdx = 1; // fallback
-    if (movesIdx < 0) movesIdx = 2; // fallback
-
-    std::string fen = (fenIdx >= 0 && (size_t)fenIdx < fields.size()) ? fields[fenIdx] : std::string();
-    std::string moves = (movesIdx >= 0 && (size_t)movesIdx < fields.size()) ? fields[movesIdx] : std::string();
-    if (idIdx >= 0 && (size_t)idIdx < fields.size()) currentPuzzleId = fields[idIdx];
-    if (!board->setFEN(fen)) return false;
+    // Otherwise a puzzle matching the filter when one is on (the match list is
+    // rebuilt if the file was reopened since), else an unseen puzzle rated
+    // near the current rating
+    if (!loaded) {
+        if (puzzleFilterOn && puzzleFilterRows.empty()) puzzleFilterOn = applyPuzzleFilter();
+        loaded = puzzlePrefetcher.next(prepared);
+    }
+    if (!loaded) return false;
+    // Have the next review puzzle read while this one is solved
+    puzzlePrefetcher.setReview(userDb && !userDb->getReviewQueue().empty() ? userDb->getReviewQueue().front() : std::string());
+    const Puzzle& puzzle = prepared.puzzle;
+
+    // Build metadata KVs for display, in the CSV's column order
+    puzzleMetaKVs.clear();
+    puzzleMetaKVs.emplace_back("PuzzleId", puzzle.id);
+    puzzleMetaKVs.emplace_back("FEN", puzzle.fen);
+    puzzleMetaKVs.emplace_back("Moves", joinWords(puzzle.moves));
+    puzzleMetaKVs.emplace_back("Rating", std::to_string(puzzle.rating));
+    puzzleMetaKVs.emplace_back("RatingDeviation", std::to_string(puzzle.ratingDeviation));
+    puzzleMetaKVs.emplace_back("Popularity", std::to_string(puzzle.popularity));
+    puzzleMetaKVs.emplace_back("NbPlays", std::to_string(puzzle.nbPlays));
+    puzzleMetaKVs.emplace_back("Themes", puzzle.themes);
+    puzzleMetaKVs.emplace_back("GameUrl", puzzle.gameUrl);
+    puzzleMetaKVs.emplace_back("OpeningTags", puzzle.openingTags);
+
+    currentPuzzleId = puzzle.id;
+    board->setPosition(prepared.position);
     // Save baseline puzzle position and first move to allow returning after side-lines
-    puzzleStartFEN = fen;
-    puzzleMoves = splitUciMoves(moves);
+    puzzleStartFEN = puzzle.fen;
+    puzzleMoves = puzzle.moves;
     puzzleIndex = 0;
-    lastAnalyzedFEN = board->getFEN();
+    lastAnalyzedHash = board->getHash();
 
     // Play the first move from the CSV to show the opponent's last/first move,
     // then let the user solve from the other side.
@@ -1318,6 +1771,15 @@ void Game::renderAnalysisPanel() {
 
         yOffset += 30.0f;
     }
+
+    // Depth reached so far; grows while infinite analysis runs
+    sf::Text depthText;
+    depthText.setFont(font);
+    depthText.setCharacterSize(11);
+    depthText.setFillColor(sf::Color(120, 120, 120));
+    depthText.setString("depth " + std::to_string(currentLines[0].depth));
+    depthText.setPosition(295.0f, 434.0f);
+    window->draw(depthText);
 }
 
 std::string Game::openFileDialog() {
@@ -1453,7 +1915,7 @@ std::string Game::openCSVFileDialog() {
     ofn.hwndOwner = window->getSystemHandle();
     ofn.lpstrFile = szFile;
     ofn.nMaxFile = sizeof(szFile);
-    ofn.lpstrFilter = "CSV Files (*.csv)\0*.csv\0All Files (*.*)\0*.*\0";
+    ofn.lpstrFilter = "Puzzle Files (*.csv;*.pzl)\0*.csv;*.pzl\0All Files (*.*)\0*.*\0";
     ofn.nFilterIndex = 1;
     ofn.lpstrFileTitle = NULL;
     ofn.nMaxFileTitle = 0;
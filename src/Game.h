@@ -2,9 +2,18 @@
 #define GAME_H
 #include "Board.h"
 #include "StockfishEngine.h"
+#include "SearchEngine.h"
+#include "EnginePool.h"
+#include "GameReview.h"
+#include "EvalCache.h"
+#include "SearchFuture.h"
 #include "EvalBar.h"
 #include "Arrow.h"
 #include "UserDB.h"
+#include "PuzzlePack.h"
+#include "PuzzlePrefetcher.h"
+#include "PuzzleStore.h"
+#include "PuzzleTagIndex.h"
 #include "Button.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Graphics/Color.hpp>
@@ -16,6 +25,8 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <atomic>
+#include <thread>
 
 class Game
 {
@@ -35,19 +46,46 @@ class Game
 		sf::Vector2i getWindow;
 		sf::Event event;
 		sf::Clock dtClock;
-		sf::Clock analysisClock;  // For periodic engine updates
 		float dt;
 		sf::Vector2i position;
 
 		// Engine and analysis components
-		StockfishEngine* engine;
+		AnalysisEngine* engine;     // Stockfish, or the built-in engine as a fallback
 		EvalBar* evalBar;
 		ArrowManager* arrowManager;
 		UserDB* userDb;
 		bool engineInitialized;
 		bool analysisRequested;
-		std::string lastAnalyzedFEN;
+		uint64_t shownLinesVersion;  // engine->getLinesVersion() of the lines on screen
+		uint64_t lastAnalyzedHash;  // Zobrist key of the last analysed position, 0 if none
+		EvalCache* evalCache = nullptr;  // analysis kept across sessions, in the user database
+		sf::Clock evalFlushClock;  // time since the cache last wrote its buffered entries
+		uint64_t analysisKey = 0;  // Zobrist key of the position the engine is analysing
+		int shownDepth = 0;        // depth of the lines on screen; shallower output is not shown
+		bool infiniteAnalysis = true;  // analyse until the position changes (I key)
+		SearchLimits analysisBudget;   // limits used when infinite analysis is off
         bool gameOver = false;
+
+		// Whole-game review (R key); the pool is started on first use
+		EnginePool* reviewPool = nullptr;
+		GameReview* review = nullptr;
+
+		// Play versus engine (P key). The opponent is an engine of its own, so it
+		// can ponder on the player's time without touching the analysis engine.
+		AnalysisEngine* opponent = nullptr;
+		bool playMode = false;
+		PieceColor engineColor = PieceColor::BLACK;
+		SearchFuture engineSearch;      // the engine's move search, or its ponder search
+		bool enginePondering = false;
+		std::string ponderMove;         // the reply the ponder search assumes
+		size_t playedMoves = 0;         // board->getMoveCount() when the clocks were last settled
+		int clockMs[2] = { 0, 0 };      // White, Black; excludes the running move
+		sf::Clock moveClock;            // time used on the current move
+		int ponderHits = 0;
+		int ponderMisses = 0;
+
+		// Engine latency overlay (M key); L writes the engine log to a file
+		bool showEngineMetrics = false;
 
 		// UI Buttons
 		std::vector<Button*> buttons;
@@ -94,14 +132,35 @@ class Game
 
 		// Engine and analysis methods
 		void initEngine();
+		AnalysisEngine* createEngine() const;
 		void updateAnalysis();
+		void showLines(const std::vector<EngineLine>& lines);
+		void startReview();
+		void updateReview();
 		void handleKeyboard(sf::Event::KeyEvent key);
 
+		// Play versus engine (GamePlay.cpp)
+		void startPlay();
+		void stopPlay();
+		void finishPlay(const std::string& result);
+		void updatePlay();
+		void requestEngineMove();
+		void startPondering(const std::string& expected);
+		bool checkPlayOver();
+		void settleClock(PieceColor mover);
+		void takeBackInPlay();
+		int clockRemaining(PieceColor side) const;
+		SearchLimits playLimits() const;
+		void renderPlayPanel();
+
 		// UI methods
 		void initButtons();
 		void updateButtons();
 		void renderUI();
 		void renderAnalysisPanel();
+		void renderReviewPanel();
+		void renderEngineMetrics();
+		void dumpEngineLog();
 		void setStatusMessage(const std::string& message);
         void renderCheckmateBanner();
 
@@ -109,15 +168,29 @@ class Game
         bool puzzleMode = false;
         bool puzzleSolved = false;
         sf::Clock puzzleSolvedClock;
-        // Puzzle metadata (headers and key-value pairs for display)
-        std::vector<std::string> puzzleHeaders;
+        // Puzzle metadata (key-value pairs for display)
         std::vector<std::pair<std::string, std::string>> puzzleMetaKVs;
         // Promotion dialog state
         bool promotionOpen = false;
         void renderPromotionDialog();
         std::string puzzleFilePath;
+        PuzzleSource* puzzleSource = nullptr; // puzzleFilePath: a PuzzleStore over the CSV or a PuzzlePack
+        PuzzlePrefetcher puzzlePrefetcher; // draws from puzzleSource and prepares the next puzzles ahead
+        PuzzleTagIndex puzzleTags;      // themes and opening tags of puzzleSource, built or loaded in the background
+        std::thread puzzleTagsThread;   // opens puzzleTags while the file is used; joined before the source changes
+        std::atomic<bool> puzzleTagsReady{false};
+        bool puzzleTagsOpened = false;  // puzzleTags.open succeeded; read only once puzzleTagsReady
+        bool puzzleFilterOn = false;
+        bool editingFilter = false;     // Ctrl+F: keys type into filterDraft instead of acting as shortcuts
+        std::string filterDraft;        // UTF-8
+        std::vector<uint32_t> puzzleFilterRows; // rows matching the saved filter while it is on
         std::vector<std::string> puzzleMoves;
         size_t puzzleIndex = 0; // index into puzzleMoves
+        bool openPuzzleSource();
+        void startPuzzleTags();
+        void stopPuzzleTags();
+        bool applyPuzzleFilter();
+        void editFilter(const sf::Event& event);
         bool loadRandomPuzzle();
         void renderPuzzleSolvedBanner();
         void renderPuzzleMetadataPanel();
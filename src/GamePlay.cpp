@@ -0,0 +1,296 @@
+// Play versus engine: the engine replies through Board::applyUCIMove and
+// ponders on the player's time, with a Fischer clock for both sides.
+
+#include "Game.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 5 minutes + 3 seconds per move
+const int PLAY_CLOCK_MS = 5 * 60 * 1000;
+const int PLAY_INCREMENT_MS = 3000;
+
+int sideIndex(PieceColor side) {
+	return side == PieceColor::WHITE ? 0 : 1;
+}
+
+PieceColor opposite(PieceColor side) {
+	return side == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+std::string formatClock(int ms) {
+	char buffer[16];
+	int tenths = ms / 100;
+	std::snprintf(buffer, sizeof(buffer), "%d:%02d.%d", tenths / 600, tenths / 10 % 60, tenths % 10);
+	return buffer;
+}
+
+// The game from its first position, plus `extra` if given, so the engine
+// knows which positions already occurred and can steer clear of a repetition
+bool sendGame(AnalysisEngine& engine, const Position& game, const std::string& extra = "") {
+	Position start = game;
+	std::vector<std::string> moves;
+	for (int ply = 0; ply < start.historySize(); ++ply) moves.push_back(moveToUCI(start.moveAt(ply)));
+	while (start.historySize() > 0) start.unmakeMove();
+	if (!extra.empty()) moves.push_back(extra);
+	return engine.sendPosition(start.getFEN(), moves);
+}
+
+// Neither side can mate: bare kings plus at most one minor piece, or only
+// bishops that all stand on squares of one color
+bool insufficientMaterial(const Position& pos) {
+	Bitboard majorsAndPawns = 0, knights = 0, bishops = 0;
+	for (PieceColor c : {PieceColor::WHITE, PieceColor::BLACK}) {
+		majorsAndPawns |= pos.pieces(c, PieceType::PAWN) | pos.pieces(c, PieceType::ROOK) | pos.pieces(c, PieceType::QUEEN);
+		knights |= pos.pieces(c, PieceType::KNIGHT);
+		bishops |= pos.pieces(c, PieceType::BISHOP);
+	}
+	if (majorsAndPawns) return false;
+	if (popCount(knights | bishops) <= 1) return true;
+	const Bitboard darkSquares = 0xAA55AA55AA55AA55ULL;
+	return !knights && ((bishops & darkSquares) == 0 || (bishops & ~darkSquares) == 0);
+}
+
+} // namespace
+
+void Game::startPlay() {
+	if (puzzleMode) {
+		setStatusMessage("Leave puzzle mode to play the engine");
+		return;
+	}
+	if (board->getIsCheckmate()) {
+		setStatusMessage("Game is over - start a new game");
+		return;
+	}
+
+	// A separate engine instance, so pondering never disturbs live analysis
+	if (!opponent) opponent = createEngine();
+	if (!opponent) {
+		setStatusMessage("No engine to play against");
+		return;
+	}
+
+	// Strength follows the puzzle rating: 600 plays at skill 0, 2600+ at full strength
+	int skill = userDb ? std::max(0, std::min(20, (userDb->getRating() - 600) / 100)) : 20;
+	opponent->setSkillLevel(skill);
+
+	// Live analysis pauses while playing; it would give the moves away
+	if (engineInitialized) engine->stopAnalysis();
+	analysisRequested = false;
+	currentLines.clear();
+	arrowManager->clearArrows();
+
+	// The player takes the side to move
+	playMode = true;
+	engineColor = opposite(board->getCurrentTurn());
+	clockMs[0] = clockMs[1] = PLAY_CLOCK_MS;
+	playedMoves = board->getMoveCount();
+	enginePondering = false;
+	ponderMove.clear();
+	ponderHits = ponderMisses = 0;
+	moveClock.restart();
+	setStatusMessage("Playing " + std::string(engineColor == PieceColor::WHITE ? "Black" : "White")
+	                 + " vs engine (skill " + std::to_string(skill) + ")");
+}
+
+void Game::stopPlay() {
+	if (!playMode) return;
+	playMode = false;
+	if (engineSearch.valid()) {
+		engineSearch.cancel();
+		engineSearch.wait();
+	}
+	engineSearch = SearchFuture();
+	enginePondering = false;
+	ponderMove.clear();
+}
+
+void Game::finishPlay(const std::string& result) {
+	stopPlay();
+	setStatusMessage(result);
+	std::cout << result << " (ponder hits " << ponderHits << ", misses " << ponderMisses << ")" << std::endl;
+}
+
+int Game::clockRemaining(PieceColor side) const {
+	int ms = clockMs[sideIndex(side)];
+	if (playMode && side == board->getCurrentTurn()) ms -= moveClock.getElapsedTime().asMilliseconds();
+	return std::max(0, ms);
+}
+
+SearchLimits Game::playLimits() const {
+	SearchLimits limits;
+	limits.whiteTimeMs = std::max(1, clockRemaining(PieceColor::WHITE));
+	limits.blackTimeMs = std::max(1, clockRemaining(PieceColor::BLACK));
+	limits.whiteIncMs = PLAY_INCREMENT_MS;
+	limits.blackIncMs = PLAY_INCREMENT_MS;
+	return limits;
+}
+
+void Game::requestEngineMove() {
+	enginePondering = false;
+	ponderMove.clear();
+	sendGame(*opponent, board->getPosition());
+	engineSearch = SearchFuture::start(*opponent, playLimits(), 1);
+	if (!engineSearch.valid()) finishPlay("Engine stopped responding");
+}
+
+void Game::startPondering(const std::string& expected) {
+	// Think on the position after the reply the engine expects
+	if (expected.empty() || board->getPosition().parseUCIMove(expected) == MOVE_NONE) return;
+
+	SearchLimits limits = playLimits();
+	limits.ponder = true;
+	sendGame(*opponent, board->getPosition(), expected);
+	engineSearch = SearchFuture::start(*opponent, limits, 1);
+	enginePondering = engineSearch.valid();
+	if (enginePondering) ponderMove = expected;
+}
+
+bool Game::checkPlayOver() {
+	PieceColor toMove = board->getCurrentTurn();
+	if (board->getIsCheckmate()) {
+		finishPlay(toMove == engineColor ? "Checkmate - you win" : "Checkmate - engine wins");
+		return true;
+	}
+	MoveList legal;
+	board->getPosition().generateLegalMoves(legal);
+	if (legal.empty()) {
+		finishPlay("Stalemate - draw");
+		return true;
+	}
+	if (board->isThreefoldRepetition()) {
+		finishPlay("Threefold repetition - draw");
+		return true;
+	}
+	if (board->getPosition().getHalfmoveClock() >= 100) {
+		finishPlay("Fifty-move rule - draw");
+		return true;
+	}
+	if (insufficientMaterial(board->getPosition())) {
+		finishPlay("Insufficient material - draw");
+		return true;
+	}
+	return false;
+}
+
+void Game::settleClock(PieceColor mover) {
+	int& clock = clockMs[sideIndex(mover)];
+	clock = std::max(0, clock - moveClock.getElapsedTime().asMilliseconds()) + PLAY_INCREMENT_MS;
+	moveClock.restart();
+	playedMoves = board->getMoveCount();
+}
+
+void Game::updatePlay() {
+	// A pending promotion choice is part of the player's move
+	if (!playMode || promotionOpen) return;
+
+	PieceColor toMove = board->getCurrentTurn();
+	if (clockRemaining(toMove) == 0) {
+		finishPlay(toMove == engineColor ? "Engine lost on time" : "You lost on time");
+		return;
+	}
+
+	// The player moved: on the move the engine expected, its ponder search
+	// simply becomes the real one, so the reply is usually already there
+	if (board->getMoveCount() != playedMoves) {
+		settleClock(opposite(toMove));
+		if (checkPlayOver()) return;
+		if (toMove != engineColor) return;
+
+		if (enginePondering && board->getLastMoveUCI() == ponderMove) {
+			opponent->ponderHit();
+			enginePondering = false;
+			ponderHits++;
+		} else {
+			if (enginePondering) {
+				ponderMisses++;
+				engineSearch.cancel();
+				engineSearch.wait();
+			}
+			requestEngineMove();
+		}
+		return;
+	}
+
+	// The engine's reply, once its search resolves
+	if (toMove != engineColor || enginePondering || !engineSearch.valid() || !engineSearch.ready()) return;
+	SearchResult result = engineSearch.get();
+	engineSearch = SearchFuture();
+	if (result.bestMove.empty() || !board->applyUCIMove(result.bestMove)) {
+		finishPlay("Engine returned no move");
+		return;
+	}
+	settleClock(engineColor);
+	if (checkPlayOver()) return;
+	startPondering(result.ponderMove);
+}
+
+void Game::takeBackInPlay() {
+	// Back to the player's turn: the engine's reply and the player's move
+	if (engineSearch.valid()) {
+		engineSearch.cancel();
+		engineSearch.wait();
+	}
+	engineSearch = SearchFuture();
+	enginePondering = false;
+	ponderMove.clear();
+
+	if (!board->canUndo()) {
+		setStatusMessage("No moves to undo");
+		return;
+	}
+	board->undoLastMove();
+	if (board->getCurrentTurn() == engineColor && board->canUndo()) board->undoLastMove();
+	playedMoves = board->getMoveCount();
+	moveClock.restart();
+	setStatusMessage("Move taken back");
+	if (board->getCurrentTurn() == engineColor) requestEngineMove();
+}
+
+void Game::renderPlayPanel() {
+	if (!playMode) return;
+
+	sf::RectangleShape panel;
+	panel.setSize(sf::Vector2f(352.0f, 98.0f));
+	panel.setPosition(0.0f, 352.0f);
+	panel.setFillColor(sf::Color(20, 20, 20));
+	window->draw(panel);
+
+	// Engine on top, player below, the side to move highlighted
+	const PieceColor rows[2] = { engineColor, opposite(engineColor) };
+	PieceColor toMove = board->getCurrentTurn();
+	float y = 358.0f;
+	for (PieceColor side : rows) {
+		sf::Text label;
+		label.setFont(font);
+		label.setCharacterSize(16);
+		sf::Color color = side == toMove ? sf::Color::White : sf::Color(140, 140, 140);
+		label.setFillColor(color);
+		std::string who = side == engineColor ? "Engine" : "You";
+		label.setString(who + (side == PieceColor::WHITE ? " (White)" : " (Black)"));
+		label.setPosition(10.0f, y);
+		window->draw(label);
+
+		sf::Text clock;
+		clock.setFont(font);
+		clock.setCharacterSize(18);
+		clock.setStyle(sf::Text::Bold);
+		int ms = clockRemaining(side);
+		clock.setFillColor(ms < 10000 ? sf::Color(230, 80, 80) : color);
+		clock.setString(formatClock(ms));
+		clock.setPosition(250.0f, y - 2.0f);
+		window->draw(clock);
+		y += 28.0f;
+	}
+
+	sf::Text status;
+	status.setFont(font);
+	status.setCharacterSize(12);
+	status.setFillColor(sf::Color(150, 150, 150));
+	std::string text = enginePondering ? "Pondering on " + ponderMove : (toMove == engineColor ? "Thinking..." : "");
+	text += "   ponder hits " + std::to_string(ponderHits) + "/" + std::to_string(ponderHits + ponderMisses);
+	status.setString(text);
+	status.setPosition(10.0f, y + 2.0f);
+	window->draw(status);
+}
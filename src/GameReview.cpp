@@ -0,0 +1,248 @@
+#include "GameReview.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+const int EVAL_CLAMP = 1000;
+
+// Engine line -> centipawns for the side to move, mates clamped
+int lineToCp(const EngineLine& line) {
+    if (line.mate != 0) return line.mate > 0 ? EVAL_CLAMP : -EVAL_CLAMP;
+    return std::max(-EVAL_CLAMP, std::min(EVAL_CLAMP, line.score));
+}
+
+// Expected score in percent for a centipawn advantage (Lichess' fit)
+double winPercent(int cp) {
+    return 50.0 + 50.0 * (2.0 / (1.0 + std::exp(-0.00368208 * cp)) - 1.0);
+}
+
+std::string formatEval(int cp) {
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%+.2f", cp / 100.0);
+    return buffer;
+}
+
+} // namespace
+
+const char* moveClassName(MoveClass c) {
+    switch (c) {
+        case MOVE_CLASS_BEST: return "best";
+        case MOVE_CLASS_GOOD: return "good";
+        case MOVE_CLASS_INACCURACY: return "inaccuracy";
+        case MOVE_CLASS_MISTAKE: return "mistake";
+        case MOVE_CLASS_BLUNDER: return "blunder";
+    }
+    return "";
+}
+
+GameReview::GameReview(EnginePool& enginePool, const SearchLimits& searchLimits)
+    : pool(enginePool), limits(searchLimits), settledCount(0), evaluatedCount(0) {
+}
+
+bool GameReview::start(const Position& game) {
+    Position replay = game;
+    std::vector<Move> moves;
+    for (int ply = 0; ply < replay.historySize(); ++ply) moves.push_back(replay.moveAt(ply));
+    while (replay.historySize() > 0) replay.unmakeMove();
+    return start(replay.getFEN(), moves);
+}
+
+bool GameReview::start(const std::string& startFEN, const std::vector<Move>& moves) {
+    cancel();
+    reviews.clear();
+    evals.clear();
+    settled.clear();
+    settledCount = 0;
+    evaluatedCount = 0;
+
+    Position pos;
+    if (startFEN.empty()) {
+        pos.setStartPosition();
+    } else if (!pos.setFEN(startFEN)) {
+        return false;
+    }
+
+    std::vector<std::string> fens;
+    for (size_t ply = 0; ply <= moves.size(); ++ply) {
+        fens.push_back(pos.getFEN());
+
+        PositionEval eval;
+        eval.sideToMove = pos.getSideToMove();
+        eval.done = false;
+        eval.analysed = false;
+        eval.whiteCp = 0;
+
+        // Mate and stalemate need no engine
+        MoveList legal;
+        pos.generateLegalMoves(legal);
+        if (legal.empty()) {
+            bool mated = pos.isKingInCheck(pos.getSideToMove());
+            eval.done = true;
+            eval.analysed = true;
+            eval.whiteCp = !mated ? 0 : pos.getSideToMove() == PieceColor::WHITE ? -EVAL_CLAMP : EVAL_CLAMP;
+        }
+        evals.push_back(eval);
+
+        if (ply == moves.size()) break;
+        Move m = moves[ply];
+        if (!legal.contains(m)) return false;
+
+        MoveReview review;
+        review.ply = static_cast<int>(ply);
+        review.moveNumber = pos.getFullmoveNumber();
+        review.move = m;
+        review.san = pos.moveToSAN(m);
+        review.mover = pos.getSideToMove();
+        review.evaluated = false;
+        review.evalBefore = 0;
+        review.evalAfter = 0;
+        review.cpLoss = 0;
+        review.moveClass = MOVE_CLASS_GOOD;
+        review.accuracy = 0.0;
+        reviews.push_back(review);
+        pos.makeMove(m);
+    }
+    settled.assign(reviews.size(), false);
+
+    for (size_t i = 0; i < evals.size(); ++i) {
+        if (evals[i].done) continue;
+        AnalysisJob job;
+        job.fen = fens[i];
+        job.limits = limits;
+        job.multiPV = 1;
+        jobPositions[pool.submit(job)] = i;
+    }
+    return true;
+}
+
+void GameReview::cancel() {
+    if (!jobPositions.empty()) pool.cancelAll();
+    jobPositions.clear();
+}
+
+std::vector<size_t> GameReview::update(bool wait) {
+    std::vector<size_t> finished;
+    AnalysisResult result;
+    bool have = wait && !jobPositions.empty() ? pool.waitResult(result) : pool.poll(result);
+    for (; have; have = pool.poll(result)) {
+        std::map<size_t, size_t>::iterator it = jobPositions.find(result.jobId);
+        if (it == jobPositions.end()) continue; // from an earlier, cancelled review
+        size_t index = it->second;
+        jobPositions.erase(it);
+
+        // No line means the engine failed or the job was cancelled; the
+        // position stays unscored rather than reading as an even game
+        PositionEval& eval = evals[index];
+        eval.done = true;
+        if (!result.lines.empty()) {
+            int cp = lineToCp(result.lines[0]);
+            eval.whiteCp = eval.sideToMove == PieceColor::WHITE ? cp : -cp;
+            eval.bestMove = result.lines[0].move;
+            eval.analysed = true;
+        }
+
+        if (index > 0 && settleMove(index - 1)) finished.push_back(index - 1);
+        if (index < reviews.size() && settleMove(index)) finished.push_back(index);
+    }
+
+    // Moves between two positions that needed no engine
+    for (size_t ply = 0; ply < reviews.size() && settledCount < reviews.size(); ++ply) {
+        if (settleMove(ply)) finished.push_back(ply);
+    }
+    return finished;
+}
+
+// Scores the move once neither position is waiting, if both were analysed;
+// true if it was settled just now
+bool GameReview::settleMove(size_t ply) {
+    if (settled[ply] || !evals[ply].done || !evals[ply + 1].done) return false;
+    settled[ply] = true;
+    settledCount++;
+    if (evals[ply].analysed && evals[ply + 1].analysed) finishMove(ply);
+    return true;
+}
+
+void GameReview::finishMove(size_t ply) {
+    MoveReview& review = reviews[ply];
+    review.evalBefore = evals[ply].whiteCp;
+    review.evalAfter = evals[ply + 1].whiteCp;
+    review.bestMove = evals[ply].bestMove;
+
+    const int sign = review.mover == PieceColor::WHITE ? 1 : -1;
+    const int before = sign * review.evalBefore;
+    const int after = sign * review.evalAfter;
+    const bool best = !review.bestMove.empty() && moveToUCI(review.move) == review.bestMove;
+    review.cpLoss = best ? 0 : std::max(0, before - after);
+
+    if (best) review.moveClass = MOVE_CLASS_BEST;
+    else if (review.cpLoss >= 300) review.moveClass = MOVE_CLASS_BLUNDER;
+    else if (review.cpLoss >= 100) review.moveClass = MOVE_CLASS_MISTAKE;
+    else if (review.cpLoss >= 50) review.moveClass = MOVE_CLASS_INACCURACY;
+    else review.moveClass = MOVE_CLASS_GOOD;
+
+    // Lichess' accuracy curve over the drop in winning chances
+    double drop = best ? 0.0 : std::max(0.0, winPercent(before) - winPercent(after));
+    review.accuracy = std::max(0.0, std::min(100.0, 103.1668 * std::exp(-0.04354 * drop) - 3.1669));
+    review.evaluated = true;
+    evaluatedCount++;
+}
+
+double GameReview::accuracy(PieceColor side) const {
+    double sum = 0.0;
+    int n = 0;
+    for (const MoveReview& r : reviews) {
+        if (r.evaluated && r.mover == side) {
+            sum += r.accuracy;
+            n++;
+        }
+    }
+    return n ? sum / n : 0.0;
+}
+
+int GameReview::averageCpLoss(PieceColor side) const {
+    int sum = 0;
+    int n = 0;
+    for (const MoveReview& r : reviews) {
+        if (r.evaluated && r.mover == side) {
+            sum += r.cpLoss;
+            n++;
+        }
+    }
+    return n ? sum / n : 0;
+}
+
+int GameReview::count(PieceColor side, MoveClass moveClass) const {
+    int n = 0;
+    for (const MoveReview& r : reviews) {
+        if (r.evaluated && r.mover == side && r.moveClass == moveClass) n++;
+    }
+    return n;
+}
+
+std::string GameReview::report() const {
+    std::ostringstream out;
+    char row[128];
+    for (const MoveReview& r : reviews) {
+        std::string number = std::to_string(r.moveNumber) + (r.mover == PieceColor::WHITE ? "." : "...");
+        if (!r.evaluated) {
+            std::snprintf(row, sizeof(row), "%6s %-8s  (not analysed)\n", number.c_str(), r.san.c_str());
+        } else {
+            std::snprintf(row, sizeof(row), "%6s %-8s %7s -> %-7s loss %4d  acc %5.1f  %-10s best %s\n",
+                          number.c_str(), r.san.c_str(), formatEval(r.evalBefore).c_str(), formatEval(r.evalAfter).c_str(),
+                          r.cpLoss, r.accuracy, moveClassName(r.moveClass), r.bestMove.c_str());
+        }
+        out << row;
+    }
+
+    const PieceColor sides[] = { PieceColor::WHITE, PieceColor::BLACK };
+    for (PieceColor side : sides) {
+        std::snprintf(row, sizeof(row), "%s: accuracy %.1f%%, average loss %d cp, %d inaccuracies, %d mistakes, %d blunders\n",
+                      side == PieceColor::WHITE ? "White" : "Black", accuracy(side), averageCpLoss(side),
+                      count(side, MOVE_CLASS_INACCURACY), count(side, MOVE_CLASS_MISTAKE), count(side, MOVE_CLASS_BLUNDER));
+        out << row;
+    }
+    return out.str();
+}
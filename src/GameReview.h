@@ -0,0 +1,90 @@
+#ifndef GAME_REVIEW_H
+#define GAME_REVIEW_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "EnginePool.h"
+#include "Position.h"
+
+enum MoveClass {
+    MOVE_CLASS_BEST,        // the engine's first choice
+    MOVE_CLASS_GOOD,
+    MOVE_CLASS_INACCURACY,  // loses 50+ centipawns
+    MOVE_CLASS_MISTAKE,     // 100+
+    MOVE_CLASS_BLUNDER      // 300+
+};
+
+const char* moveClassName(MoveClass c);
+
+// Review of one move. Evaluations are centipawns from White's point of
+// view, with mates and anything beyond +-1000 clamped to +-1000.
+struct MoveReview {
+    int ply;                // 0 = the first move reviewed
+    int moveNumber;         // as in the PGN ("12." / "12...")
+    Move move;
+    std::string san;
+    PieceColor mover;
+    bool evaluated;         // both surrounding positions have been analysed
+    int evalBefore;
+    int evalAfter;
+    std::string bestMove;   // engine's choice in the position before, UCI
+    int cpLoss;             // what the move gave away, from the mover's side, >= 0
+    MoveClass moveClass;
+    double accuracy;        // 0-100, from the change in winning chances
+};
+
+// Whole-game analysis. Every position of the game becomes one EnginePool
+// job, so the positions are analysed in parallel; update() folds in the
+// results that have arrived, so a UI can show moves as they complete.
+// While a review runs it consumes every result the pool produces.
+class GameReview {
+private:
+    struct PositionEval {
+        PieceColor sideToMove;  // engine scores are from this side
+        bool done;              // no analysis outstanding
+        bool analysed;          // whiteCp is real: mate, stalemate or an engine line
+        int whiteCp;
+        std::string bestMove;
+    };
+
+    EnginePool& pool;
+    SearchLimits limits;
+    std::vector<MoveReview> reviews;
+    std::vector<PositionEval> evals;        // reviews.size() + 1 positions
+    std::map<size_t, size_t> jobPositions;  // pool job id -> position index
+    std::vector<bool> settled;              // per move: both positions done
+    size_t settledCount;
+    size_t evaluatedCount;
+
+    bool settleMove(size_t ply);
+    void finishMove(size_t ply);
+
+public:
+    GameReview(EnginePool& enginePool, const SearchLimits& searchLimits);
+
+    // Queues the game starting at startFEN (empty: standard start) for analysis
+    bool start(const std::string& startFEN, const std::vector<Move>& moves);
+    // The same for the moves played so far in `game`
+    bool start(const Position& game);
+    void cancel();
+
+    // Takes in finished analysis; returns the plies whose review completed.
+    // A position the engine returned no line for (it failed, or the job was
+    // cancelled) is not analysed, and the moves next to it stay unevaluated.
+    // With wait, first blocks until the pool has a result (if any is due).
+    std::vector<size_t> update(bool wait = false);
+    bool isWaiting() const { return !jobPositions.empty(); } // analysis still outstanding
+    bool isComplete() const { return settledCount == reviews.size(); }
+    size_t evaluatedMoves() const { return evaluatedCount; }
+
+    const std::vector<MoveReview>& moves() const { return reviews; }
+    double accuracy(PieceColor side) const;            // mean of the side's move accuracies
+    int averageCpLoss(PieceColor side) const;
+    int count(PieceColor side, MoveClass moveClass) const;
+
+    std::string report() const;  // plain-text table plus a summary per side
+};
+
+#endif // GAME_REVIEW_H
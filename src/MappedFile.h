@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// A whole file mapped read-only into memory. Reads are page-cache hits once
+// the pages are resident, and nothing is copied out. Not copyable.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return bytes != nullptr; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Size and modification time of a file, which caches built from it
+    // (index sidecars) record to tell when they are stale
+    static bool stamp(const std::string& path, uint64_t& size, int64_t& time);
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+#endif // MAPPED_FILE_H
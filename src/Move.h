@@ -0,0 +1,69 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+#include "ChessTypes.h"
+
+// Packed 16-bit move:
+//   bits 0-5   from square
+//   bits 6-11  to square
+//   bits 12-13 promotion piece (0 = knight, 1 = bishop, 2 = rook, 3 = queen)
+//   bits 14-15 move kind (MoveFlag)
+typedef uint16_t Move;
+
+const Move MOVE_NONE = 0;
+
+enum MoveFlag {
+    MOVE_NORMAL = 0,
+    MOVE_PROMOTION = 1 << 14,
+    MOVE_EN_PASSANT = 2 << 14,
+    MOVE_CASTLING = 3 << 14
+};
+
+inline Move encodeMove(int from, int to, MoveFlag flag = MOVE_NORMAL, PieceType promotion = PieceType::KNIGHT) {
+    return static_cast<Move>(from | (to << 6) | ((static_cast<int>(promotion) - static_cast<int>(PieceType::KNIGHT)) << 12) | flag);
+}
+
+inline int moveFrom(Move m) { return m & 0x3F; }
+inline int moveTo(Move m) { return (m >> 6) & 0x3F; }
+inline MoveFlag moveFlag(Move m) { return static_cast<MoveFlag>(m & (3 << 14)); }
+inline PieceType movePromotion(Move m) { return static_cast<PieceType>(((m >> 12) & 3) + static_cast<int>(PieceType::KNIGHT)); }
+
+// "e2e4", "e7e8q"; castling is written as the king's two-square move
+inline std::string moveToUCI(Move m) {
+    if (m == MOVE_NONE) return "0000";
+    std::string s = squareToString(moveFrom(m)) + squareToString(moveTo(m));
+    s[0] = static_cast<char>(s[0] - 'A' + 'a');
+    s[2] = static_cast<char>(s[2] - 'A' + 'a');
+    if (moveFlag(m) == MOVE_PROMOTION) s.push_back(pieceTypeToChar(movePromotion(m)));
+    return s;
+}
+
+// Fixed-capacity move buffer meant to live on the stack; no heap allocation.
+// 218 is the most legal moves known in any position.
+const int MAX_MOVES = 256;
+
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count;
+
+    MoveList() : count(0) {}
+
+    void add(Move m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    Move operator[](int i) const { return moves[i]; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    bool contains(Move m) const {
+        for (int i = 0; i < count; ++i) {
+            if (moves[i] == m) return true;
+        }
+        return false;
+    }
+};
+
+#endif // MOVE_H
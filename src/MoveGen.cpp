@@ -0,0 +1,288 @@
+// Position legal move generation
+#include "Position.h"
+
+namespace {
+
+// Adds one move per promotion piece when the pawn reaches the last rank
+inline void addPawnMove(MoveList& list, int from, int to, bool promotes) {
+    if (promotes) {
+        list.add(encodeMove(from, to, MOVE_PROMOTION, PieceType::QUEEN));
+        list.add(encodeMove(from, to, MOVE_PROMOTION, PieceType::ROOK));
+        list.add(encodeMove(from, to, MOVE_PROMOTION, PieceType::BISHOP));
+        list.add(encodeMove(from, to, MOVE_PROMOTION, PieceType::KNIGHT));
+    } else {
+        list.add(encodeMove(from, to));
+    }
+}
+
+inline void addMoves(MoveList& list, int from, Bitboard targets) {
+    while (targets) list.add(encodeMove(from, popLsb(targets)));
+}
+
+} // namespace
+
+Bitboard Position::pinnedPieces(PieceColor c) const {
+    int ksq = kingSquare(c);
+    if (ksq == SQUARE_NONE) return 0;
+    PieceColor them = oppositeColor(c);
+    Bitboard queens = pieces(them, PieceType::QUEEN);
+    Bitboard snipers = (rookAttacks(ksq, 0) & (pieces(them, PieceType::ROOK) | queens))
+                     | (bishopAttacks(ksq, 0) & (pieces(them, PieceType::BISHOP) | queens));
+    Bitboard pinned = 0;
+    while (snipers) {
+        Bitboard blockers = betweenBB(ksq, popLsb(snipers)) & occupiedBB;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & pieces(c))) pinned |= blockers;
+    }
+    return pinned;
+}
+
+void Position::generateLegalMoves(MoveList& list) const {
+    list.clear();
+
+    const PieceColor us = sideToMove;
+    const PieceColor them = oppositeColor(us);
+    const Bitboard own = pieces(us);
+    const Bitboard enemy = pieces(them);
+    const int ksq = kingSquare(us);
+    if (ksq == SQUARE_NONE) return;
+
+    // King moves: the destination must be safe with the king lifted off its square
+    const Bitboard occWithoutKing = occupiedBB ^ squareBB(ksq);
+    Bitboard kingTargets = kingAttacks(ksq) & ~own;
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!(attackersTo(to, occWithoutKing) & enemy)) list.add(encodeMove(ksq, to));
+    }
+
+    const Bitboard checkers = attackersTo(ksq, occupiedBB) & enemy;
+    if (checkers && (checkers & (checkers - 1))) return; // double check: king moves only
+
+    // Non-king moves must land in checkMask; pinned pieces must also stay on their pin line
+    const Bitboard checkMask = checkers ? (betweenBB(ksq, lsb(checkers)) | checkers) : ~Bitboard(0);
+    const Bitboard pinned = pinnedPieces(us);
+    const Bitboard targetMask = ~own & checkMask;
+
+    auto pinMask = [&](int from) -> Bitboard {
+        return (pinned & squareBB(from)) ? lineBB(ksq, from) : ~Bitboard(0);
+    };
+
+    // Knights (a pinned knight can never move)
+    Bitboard knights = pieces(us, PieceType::KNIGHT) & ~pinned;
+    while (knights) {
+        int from = popLsb(knights);
+        addMoves(list, from, knightAttacks(from) & targetMask);
+    }
+
+    Bitboard queens = pieces(us, PieceType::QUEEN);
+    Bitboard diagonal = pieces(us, PieceType::BISHOP) | queens;
+    while (diagonal) {
+        int from = popLsb(diagonal);
+        addMoves(list, from, bishopAttacks(from, occupiedBB) & targetMask & pinMask(from));
+    }
+    Bitboard straight = pieces(us, PieceType::ROOK) | queens;
+    while (straight) {
+        int from = popLsb(straight);
+        addMoves(list, from, rookAttacks(from, occupiedBB) & targetMask & pinMask(from));
+    }
+
+    // Pawns
+    const int forward = (us == PieceColor::WHITE) ? 8 : -8;
+    const Bitboard startRank = (us == PieceColor::WHITE) ? (RANK_1_BB << 8) : (RANK_8_BB >> 8);
+    const Bitboard lastRank = (us == PieceColor::WHITE) ? RANK_8_BB : RANK_1_BB;
+    Bitboard pawns = pieces(us, PieceType::PAWN);
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard fromBB = squareBB(from);
+        Bitboard allowed = checkMask & pinMask(from);
+
+        Bitboard single = ((us == PieceColor::WHITE) ? (fromBB << 8) : (fromBB >> 8)) & ~occupiedBB;
+        if (single) {
+            int to = from + forward;
+            if (single & allowed) addPawnMove(list, from, to, (single & lastRank) != 0);
+            if ((fromBB & startRank) && !(squareBB(to + forward) & occupiedBB) && (squareBB(to + forward) & allowed)) {
+                list.add(encodeMove(from, to + forward));
+            }
+        }
+
+        Bitboard captures = pawnAttacks(us, from) & enemy & allowed;
+        while (captures) {
+            int to = popLsb(captures);
+            addPawnMove(list, from, to, (squareBB(to) & lastRank) != 0);
+        }
+
+        if (epSquare != SQUARE_NONE && (pawnAttacks(us, from) & squareBB(epSquare))) {
+            int capSq = epSquare - forward;
+            // Resolve by simulation: covers pins, checks by the captured pawn and the
+            // rank-4/5 case where both pawns leave the king's line at once
+            Bitboard occ = (occupiedBB ^ fromBB ^ squareBB(capSq)) | squareBB(epSquare);
+            Bitboard queensThem = pieces(them, PieceType::QUEEN);
+            bool exposed = (rookAttacks(ksq, occ) & (pieces(them, PieceType::ROOK) | queensThem))
+                        || (bishopAttacks(ksq, occ) & (pieces(them, PieceType::BISHOP) | queensThem));
+            bool resolvesCheck = !checkers || (checkers & squareBB(capSq)) || (checkMask & squareBB(epSquare));
+            if (!exposed && resolvesCheck) list.add(encodeMove(from, epSquare, MOVE_EN_PASSANT));
+        }
+    }
+
+    // Castling: never out of check, path empty, king never crosses an attacked square
+    if (!checkers) {
+        const int rank = (us == PieceColor::WHITE) ? 0 : 7;
+        const int homeKing = squareOf(4, rank);
+        const int rightK = (us == PieceColor::WHITE) ? WHITE_KINGSIDE : BLACK_KINGSIDE;
+        const int rightQ = (us == PieceColor::WHITE) ? WHITE_QUEENSIDE : BLACK_QUEENSIDE;
+        const Bitboard ourRooks = pieces(us, PieceType::ROOK);
+        if (ksq == homeKing) {
+            if ((castlingRights & rightK) && (ourRooks & squareBB(squareOf(7, rank)))
+                && !(betweenBB(ksq, squareOf(7, rank)) & occupiedBB)
+                && !isSquareAttacked(squareOf(5, rank), them) && !isSquareAttacked(squareOf(6, rank), them)) {
+                list.add(encodeMove(ksq, squareOf(6, rank), MOVE_CASTLING));
+            }
+            if ((castlingRights & rightQ) && (ourRooks & squareBB(squareOf(0, rank)))
+                && !(betweenBB(ksq, squareOf(0, rank)) & occupiedBB)
+                && !isSquareAttacked(squareOf(3, rank), them) && !isSquareAttacked(squareOf(2, rank), them)) {
+                list.add(encodeMove(ksq, squareOf(2, rank), MOVE_CASTLING));
+            }
+        }
+    }
+}
+
+Move Position::parseUCIMove(const std::string& uci) const {
+    if (uci.size() < 4) return MOVE_NONE;
+    int from = squareFromString(uci.substr(0, 2));
+    int to = squareFromString(uci.substr(2, 2));
+    PieceType promotion = uci.size() > 4 ? pieceTypeFromChar(uci[4]) : PieceType::NONE;
+    if (from == SQUARE_NONE || to == SQUARE_NONE) return MOVE_NONE;
+
+    MoveList moves;
+    generateLegalMoves(moves);
+    for (Move m : moves) {
+        if (moveFrom(m) != from || moveTo(m) != to) continue;
+        if (moveFlag(m) == MOVE_PROMOTION && movePromotion(m) != promotion) continue;
+        return m;
+    }
+    return MOVE_NONE;
+}
+
+Move Position::parseSANMove(const std::string& sanText) const {
+    // Drop check/mate marks and annotations ("Nf3+", "e8=Q#", "Bxc6!?")
+    std::string san = sanText;
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.pop_back();
+    }
+    if (san.size() >= 4 && san.compare(san.size() - 4, 4, "e.p.") == 0) san.erase(san.size() - 4);
+    if (san.size() < 2) return MOVE_NONE;
+
+    MoveList moves;
+    generateLegalMoves(moves);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        bool kingside = san.size() == 3;
+        for (Move m : moves) {
+            if (moveFlag(m) == MOVE_CASTLING && (moveTo(m) > moveFrom(m)) == kingside) return m;
+        }
+        return MOVE_NONE;
+    }
+
+    PieceType piece = PieceType::PAWN;
+    size_t i = 0;
+    if (san[0] >= 'A' && san[0] <= 'Z') {
+        piece = pieceTypeFromChar(san[0]);
+        if (piece == PieceType::NONE || piece == PieceType::PAWN) return MOVE_NONE;
+        i = 1;
+    }
+
+    // Promotion suffix: "=Q" or a bare trailing piece letter ("e8Q")
+    PieceType promotion = PieceType::NONE;
+    size_t end = san.size();
+    if (piece == PieceType::PAWN && end >= 2 && san[end - 1] >= 'A' && san[end - 1] <= 'Z') {
+        promotion = pieceTypeFromChar(san[end - 1]);
+        if (promotion == PieceType::NONE || promotion == PieceType::PAWN || promotion == PieceType::KING) return MOVE_NONE;
+        end -= (san[end - 2] == '=') ? 2 : 1;
+    }
+
+    // What is left: [from file][from rank][x]<to square>
+    if (end < i + 2) return MOVE_NONE;
+    int to = squareFromString(san.substr(end - 2, 2));
+    if (to == SQUARE_NONE) return MOVE_NONE;
+    int fromFile = -1;
+    int fromRank = -1;
+    for (size_t j = i; j < end - 2; ++j) {
+        char c = san[j];
+        if (c >= 'a' && c <= 'h') fromFile = c - 'a';
+        else if (c >= '1' && c <= '8') fromRank = c - '1';
+        else if (c != 'x' && c != ':' && c != '-') return MOVE_NONE;
+    }
+
+    Move found = MOVE_NONE;
+    for (Move m : moves) {
+        int from = moveFrom(m);
+        if (moveTo(m) != to || typeAt(from) != piece || moveFlag(m) == MOVE_CASTLING) continue;
+        if (fromFile >= 0 && fileOf(from) != fromFile) continue;
+        if (fromRank >= 0 && rankOf(from) != fromRank) continue;
+        if (moveFlag(m) == MOVE_PROMOTION ? movePromotion(m) != promotion : promotion != PieceType::NONE) continue;
+        if (found != MOVE_NONE) return MOVE_NONE; // ambiguous
+        found = m;
+    }
+    return found;
+}
+
+std::string Position::moveToSAN(Move m) {
+    const int from = moveFrom(m);
+    const int to = moveTo(m);
+    std::string san;
+
+    if (moveFlag(m) == MOVE_CASTLING) {
+        san = to > from ? "O-O" : "O-O-O";
+    } else {
+        const PieceType piece = typeAt(from);
+        const bool capture = moveFlag(m) == MOVE_EN_PASSANT || !isEmpty(to);
+        std::string target = squareToString(to);
+        target[0] = static_cast<char>(target[0] - 'A' + 'a');
+
+        if (piece == PieceType::PAWN) {
+            if (capture) {
+                san.push_back(static_cast<char>('a' + fileOf(from)));
+                san.push_back('x');
+            }
+            san += target;
+            if (moveFlag(m) == MOVE_PROMOTION) {
+                san.push_back('=');
+                san.push_back(static_cast<char>(pieceTypeToChar(movePromotion(m)) - 'a' + 'A'));
+            }
+        } else {
+            san.push_back(static_cast<char>(pieceTypeToChar(piece) - 'a' + 'A'));
+
+            // Disambiguate by file, then rank, then both
+            MoveList moves;
+            generateLegalMoves(moves);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (Move other : moves) {
+                int otherFrom = moveFrom(other);
+                if (other == m || moveTo(other) != to || otherFrom == from || typeAt(otherFrom) != piece) continue;
+                ambiguous = true;
+                if (fileOf(otherFrom) == fileOf(from)) sameFile = true;
+                if (rankOf(otherFrom) == rankOf(from)) sameRank = true;
+            }
+            if (ambiguous) {
+                if (!sameFile) {
+                    san.push_back(static_cast<char>('a' + fileOf(from)));
+                } else if (!sameRank) {
+                    san.push_back(static_cast<char>('1' + rankOf(from)));
+                } else {
+                    san.push_back(static_cast<char>('a' + fileOf(from)));
+                    san.push_back(static_cast<char>('1' + rankOf(from)));
+                }
+            }
+            if (capture) san.push_back('x');
+            san += target;
+        }
+    }
+
+    makeMove(m);
+    if (isKingInCheck(sideToMove)) {
+        MoveList replies;
+        generateLegalMoves(replies);
+        san.push_back(replies.empty() ? '#' : '+');
+    }
+    unmakeMove();
+    return san;
+}
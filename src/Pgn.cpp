@@ -0,0 +1,125 @@
+#include "Pgn.h"
+#include "Position.h"
+#include <cctype>
+
+std::string PgnGame::tag(const std::string& name) const {
+    for (const auto& t : tags) {
+        if (t.first == name) return t.second;
+    }
+    return std::string();
+}
+
+bool PgnReader::next(PgnGame& game) {
+    game = PgnGame();
+    bool haveTags = readTags(game);
+
+    // Skip blank space to see whether any movetext follows
+    while (in && std::isspace(in.peek())) in.get();
+    if (!haveTags && (!in || in.peek() == std::char_traits<char>::eof())) return false;
+
+    game.startFEN = game.tag("FEN");
+    readMovetext(game);
+    return true;
+}
+
+bool PgnReader::readTags(PgnGame& game) {
+    bool any = false;
+    for (;;) {
+        while (in && std::isspace(in.peek())) in.get();
+        int c = in.peek();
+        if (c == '%') { // escape line
+            std::string skip;
+            std::getline(in, skip);
+            continue;
+        }
+        if (c != '[') return any;
+
+        std::string line;
+        std::getline(in, line);
+        size_t nameStart = 1;
+        size_t nameEnd = line.find(' ', nameStart);
+        size_t valueStart = line.find('"');
+        size_t valueEnd = line.rfind('"');
+        if (nameEnd == std::string::npos || valueStart == std::string::npos || valueEnd <= valueStart) continue;
+
+        std::string value;
+        for (size_t i = valueStart + 1; i < valueEnd; ++i) {
+            if (line[i] == '\\' && i + 1 < valueEnd) ++i;
+            value.push_back(line[i]);
+        }
+        game.tags.push_back(std::make_pair(line.substr(nameStart, nameEnd - nameStart), value));
+        any = true;
+    }
+}
+
+void PgnReader::readMovetext(PgnGame& game) {
+    Position pos;
+    if (game.startFEN.empty()) {
+        pos.setStartPosition();
+    } else if (!pos.setFEN(game.startFEN)) {
+        game.error = "invalid FEN tag";
+    }
+
+    int variationDepth = 0;
+    for (;;) {
+        int c = in.peek();
+        if (c == std::char_traits<char>::eof()) break;
+
+        if (std::isspace(c)) {
+            in.get();
+        } else if (c == '{') {
+            while (in && in.get() != '}') {}
+        } else if (c == ';') {
+            std::string skip;
+            std::getline(in, skip);
+        } else if (c == '(') {
+            in.get();
+            variationDepth++;
+        } else if (c == ')') {
+            in.get();
+            if (variationDepth > 0) variationDepth--;
+        } else if (c == '[' && variationDepth == 0) {
+            break; // next game's tags, this one had no result
+        } else {
+            std::string token;
+            while (in) {
+                c = in.peek();
+                if (c == std::char_traits<char>::eof() || std::isspace(c) || c == '{' || c == '}'
+                    || c == '(' || c == ')' || c == ';' || c == '[') {
+                    break;
+                }
+                token.push_back(static_cast<char>(in.get()));
+            }
+            if (token.empty()) {
+                in.get(); // a stray character that cannot start a token
+                continue;
+            }
+            if (variationDepth > 0 || token[0] == '$') continue;
+
+            if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+                game.result = token;
+                break;
+            }
+
+            // "12." "12..." and "12.e4" carry a move number in front
+            size_t start = 0;
+            while (start < token.size() && std::isdigit(static_cast<unsigned char>(token[start]))) start++;
+            if (start < token.size() && token[start] == '.') {
+                while (start < token.size() && token[start] == '.') start++;
+            } else {
+                start = 0;
+            }
+            if (start == token.size() || !game.error.empty()) continue;
+
+            std::string san = token.substr(start);
+            Move m = pos.parseSANMove(san);
+            if (m == MOVE_NONE) {
+                game.error = "illegal or ambiguous move " + san + " at ply " + std::to_string(game.moves.size() + 1);
+                continue;
+            }
+            pos.makeMove(m);
+            game.moves.push_back(m);
+        }
+    }
+    if (game.result.empty()) game.result = "*";
+}
@@ -0,0 +1,38 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Move.h"
+
+// One game of a PGN file, main line only
+struct PgnGame {
+    std::vector<std::pair<std::string, std::string> > tags;
+    std::string startFEN;       // from a [FEN] tag, empty for the standard start
+    std::vector<Move> moves;
+    std::string result;         // "1-0", "0-1", "1/2-1/2" or "*"
+    std::string error;          // why the movetext stopped early, empty if it did not
+
+    std::string tag(const std::string& name) const; // empty if absent
+};
+
+// Reads games one at a time from a PGN stream. Comments, NAGs and
+// variations are skipped; moves are SAN, replayed on a Position so every
+// move in `moves` is legal. A game with an illegal or unreadable move keeps
+// the moves before it and sets `error`.
+class PgnReader {
+private:
+    std::istream& in;
+
+    bool readTags(PgnGame& game);
+    void readMovetext(PgnGame& game);
+
+public:
+    explicit PgnReader(std::istream& input) : in(input) {}
+
+    bool next(PgnGame& game); // false at the end of the input
+};
+
+#endif // PGN_H
@@ -0,0 +1,341 @@
+#include "Position.h"
+#include <sstream>
+#include <cctype>
+#include <algorithm>
+
+Position::Position() {
+    Bitboards::init();
+    Zobrist::init();
+    undoStack.reserve(MAX_GAME_PLY);
+    clear();
+}
+
+void Position::clear() {
+    for (int c = 0; c < 2; ++c) {
+        colorBB[c] = 0;
+        for (int t = 0; t < 6; ++t) pieceBB[c][t] = 0;
+    }
+    occupiedBB = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        boardType[sq] = PieceType::NONE;
+        boardColor[sq] = PieceColor::NONE;
+    }
+    sideToMove = PieceColor::WHITE;
+    castlingRights = 0;
+    epSquare = SQUARE_NONE;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    key = 0;
+    undoStack.clear();
+}
+
+void Position::setStartPosition() {
+    setFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+void Position::putPiece(PieceType type, PieceColor color, int sq) {
+    Bitboard b = squareBB(sq);
+    pieceBB[static_cast<int>(color)][static_cast<int>(type)] |= b;
+    colorBB[static_cast<int>(color)] |= b;
+    occupiedBB |= b;
+    boardType[sq] = type;
+    boardColor[sq] = color;
+    key ^= Zobrist::PieceSquare[static_cast<int>(color)][static_cast<int>(type)][sq];
+}
+
+void Position::removePiece(int sq) {
+    PieceType type = boardType[sq];
+    if (type == PieceType::NONE) return;
+    PieceColor color = boardColor[sq];
+    Bitboard b = squareBB(sq);
+    pieceBB[static_cast<int>(color)][static_cast<int>(type)] ^= b;
+    colorBB[static_cast<int>(color)] ^= b;
+    occupiedBB ^= b;
+    boardType[sq] = PieceType::NONE;
+    boardColor[sq] = PieceColor::NONE;
+    key ^= Zobrist::PieceSquare[static_cast<int>(color)][static_cast<int>(type)][sq];
+}
+
+void Position::movePiece(int from, int to) {
+    PieceType type = boardType[from];
+    PieceColor color = boardColor[from];
+    removePiece(from);
+    putPiece(type, color, to);
+}
+
+uint64_t Position::computeKey() const {
+    uint64_t k = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (boardType[sq] != PieceType::NONE) {
+            k ^= Zobrist::PieceSquare[static_cast<int>(boardColor[sq])][static_cast<int>(boardType[sq])][sq];
+        }
+    }
+    if (sideToMove == PieceColor::BLACK) k ^= Zobrist::SideToMove;
+    k ^= Zobrist::Castling[castlingRights & ALL_CASTLING];
+    if (epSquare != SQUARE_NONE) k ^= Zobrist::EnPassantFile[fileOf(epSquare)];
+    return k;
+}
+
+void Position::setSideToMove(PieceColor c) {
+    if (c != sideToMove) key ^= Zobrist::SideToMove;
+    sideToMove = c;
+}
+
+void Position::setCastlingRights(int rights) {
+    key ^= Zobrist::Castling[castlingRights & ALL_CASTLING] ^ Zobrist::Castling[rights & ALL_CASTLING];
+    castlingRights = rights;
+}
+
+void Position::setEnPassantSquare(int sq) {
+    if (epSquare != SQUARE_NONE) key ^= Zobrist::EnPassantFile[fileOf(epSquare)];
+    epSquare = sq;
+    if (epSquare != SQUARE_NONE) key ^= Zobrist::EnPassantFile[fileOf(epSquare)];
+}
+
+int Position::kingSquare(PieceColor c) const {
+    Bitboard k = pieces(c, PieceType::KING);
+    return k ? lsb(k) : SQUARE_NONE;
+}
+
+Bitboard Position::attackersTo(int sq, Bitboard occ) const {
+    Bitboard rooksQueens = pieceBB[0][(int)PieceType::ROOK] | pieceBB[0][(int)PieceType::QUEEN]
+                         | pieceBB[1][(int)PieceType::ROOK] | pieceBB[1][(int)PieceType::QUEEN];
+    Bitboard bishopsQueens = pieceBB[0][(int)PieceType::BISHOP] | pieceBB[0][(int)PieceType::QUEEN]
+                           | pieceBB[1][(int)PieceType::BISHOP] | pieceBB[1][(int)PieceType::QUEEN];
+    return (pawnAttacks(PieceColor::BLACK, sq) & pieces(PieceColor::WHITE, PieceType::PAWN))
+         | (pawnAttacks(PieceColor::WHITE, sq) & pieces(PieceColor::BLACK, PieceType::PAWN))
+         | (knightAttacks(sq) & (pieceBB[0][(int)PieceType::KNIGHT] | pieceBB[1][(int)PieceType::KNIGHT]))
+         | (kingAttacks(sq) & (pieceBB[0][(int)PieceType::KING] | pieceBB[1][(int)PieceType::KING]))
+         | (rookAttacks(sq, occ) & rooksQueens)
+         | (bishopAttacks(sq, occ) & bishopsQueens);
+}
+
+bool Position::isSquareAttacked(int sq, PieceColor byColor) const {
+    PieceColor defender = oppositeColor(byColor);
+    if (pawnAttacks(defender, sq) & pieces(byColor, PieceType::PAWN)) return true;
+    if (knightAttacks(sq) & pieces(byColor, PieceType::KNIGHT)) return true;
+    if (kingAttacks(sq) & pieces(byColor, PieceType::KING)) return true;
+    Bitboard queens = pieces(byColor, PieceType::QUEEN);
+    if (rookAttacks(sq, occupiedBB) & (pieces(byColor, PieceType::ROOK) | queens)) return true;
+    if (bishopAttacks(sq, occupiedBB) & (pieces(byColor, PieceType::BISHOP) | queens)) return true;
+    return false;
+}
+
+bool Position::isKingInCheck(PieceColor kingColor) const {
+    int k = kingSquare(kingColor);
+    if (k == SQUARE_NONE) return false;
+    return isSquareAttacked(k, oppositeColor(kingColor));
+}
+
+void Position::makeMove(Move m) {
+    const int from = moveFrom(m);
+    const int to = moveTo(m);
+    const MoveFlag flag = moveFlag(m);
+    const PieceColor us = sideToMove;
+    const PieceType moved = boardType[from];
+
+    UndoRecord undo;
+    undo.move = m;
+    undo.captured = PieceType::NONE;
+    undo.castlingRights = castlingRights;
+    undo.epSquare = epSquare;
+    undo.halfmoveClock = halfmoveClock;
+    undo.key = key;
+
+    if (flag == MOVE_CASTLING) {
+        bool kingside = to > from;
+        int rank = rankOf(from);
+        movePiece(from, to);
+        movePiece(squareOf(kingside ? 7 : 0, rank), squareOf(kingside ? 5 : 3, rank));
+    } else {
+        if (flag == MOVE_EN_PASSANT) {
+            removePiece(squareOf(fileOf(to), rankOf(from)));
+            undo.captured = PieceType::PAWN;
+        } else if (boardType[to] != PieceType::NONE) {
+            undo.captured = boardType[to];
+            removePiece(to);
+        }
+        movePiece(from, to);
+        if (flag == MOVE_PROMOTION) {
+            removePiece(to);
+            putPiece(movePromotion(m), us, to);
+        }
+    }
+
+    // Castling rights: king moves clear both, anything touching a corner clears that side
+    int rights = castlingRights;
+    if (moved == PieceType::KING) {
+        rights &= (us == PieceColor::WHITE) ? ~(WHITE_KINGSIDE | WHITE_QUEENSIDE) : ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+    }
+    Bitboard touched = squareBB(from) | squareBB(to);
+    if (touched & squareBB(squareOf(7, 0))) rights &= ~WHITE_KINGSIDE;
+    if (touched & squareBB(squareOf(0, 0))) rights &= ~WHITE_QUEENSIDE;
+    if (touched & squareBB(squareOf(7, 7))) rights &= ~BLACK_KINGSIDE;
+    if (touched & squareBB(squareOf(0, 7))) rights &= ~BLACK_QUEENSIDE;
+    if (rights != castlingRights) setCastlingRights(rights);
+
+    // The en passant square only exists while an enemy pawn can take on it,
+    // so transpositions share one key and FEN whatever the move order
+    int ep = SQUARE_NONE;
+    if (moved == PieceType::PAWN && (to - from == 16 || from - to == 16)) {
+        ep = (from + to) / 2;
+        if (!(pawnAttacks(us, ep) & pieces(oppositeColor(us), PieceType::PAWN))) ep = SQUARE_NONE;
+    }
+    setEnPassantSquare(ep);
+
+    halfmoveClock = (moved == PieceType::PAWN || undo.captured != PieceType::NONE) ? 0 : halfmoveClock + 1;
+    if (us == PieceColor::BLACK) fullmoveNumber++;
+    sideToMove = oppositeColor(us);
+    key ^= Zobrist::SideToMove;
+
+    undoStack.push_back(undo);
+}
+
+void Position::unmakeMove() {
+    if (undoStack.empty()) return;
+    const UndoRecord& undo = undoStack.back();
+    const int from = moveFrom(undo.move);
+    const int to = moveTo(undo.move);
+    const MoveFlag flag = moveFlag(undo.move);
+    const PieceColor us = oppositeColor(sideToMove);
+
+    if (flag == MOVE_CASTLING) {
+        bool kingside = to > from;
+        int rank = rankOf(from);
+        movePiece(to, from);
+        movePiece(squareOf(kingside ? 5 : 3, rank), squareOf(kingside ? 7 : 0, rank));
+    } else {
+        if (flag == MOVE_PROMOTION) {
+            removePiece(to);
+            putPiece(PieceType::PAWN, us, to);
+        }
+        movePiece(to, from);
+        if (undo.captured != PieceType::NONE) {
+            int capSq = (flag == MOVE_EN_PASSANT) ? squareOf(fileOf(to), rankOf(from)) : to;
+            putPiece(undo.captured, sideToMove, capSq);
+        }
+    }
+
+    castlingRights = undo.castlingRights;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    if (us == PieceColor::BLACK) fullmoveNumber--;
+    sideToMove = us;
+    key = undo.key;
+
+    undoStack.pop_back();
+}
+
+bool Position::isRepetition(int count) const {
+    // Only positions with the same side to move since the last irreversible
+    // move can repeat, so walk back two plies at a time within the clock
+    int plies = static_cast<int>(undoStack.size());
+    int limit = std::min(plies, halfmoveClock);
+    int repeats = 1;
+    for (int back = 2; back <= limit && repeats < count; back += 2) {
+        if (undoStack[plies - back].key == key) repeats++;
+    }
+    return repeats >= count;
+}
+
+bool Position::setFEN(const std::string& fen) {
+    // Expect: piece placement / active color / castling / en passant [/ halfmove / fullmove]
+    std::istringstream iss(fen);
+    std::string placement, active, castling, ep;
+    if (!(iss >> placement >> active >> castling >> ep)) return false;
+    int half = 0, full = 1;
+    if (!(iss >> half)) half = 0;
+    if (!(iss >> full)) full = 1;
+
+    Position parsed;
+    int rank = 7;
+    int file = 0;
+    for (size_t i = 0; i < placement.size(); ++i) {
+        char c = placement[i];
+        if (c == '/') {
+            rank--;
+            file = 0;
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            file += c - '0';
+            continue;
+        }
+        PieceType pt = pieceTypeFromChar(c);
+        if (pt == PieceType::NONE || file > 7 || rank < 0) return false;
+        PieceColor pc = std::isupper(static_cast<unsigned char>(c)) ? PieceColor::WHITE : PieceColor::BLACK;
+        parsed.putPiece(pt, pc, squareOf(file, rank));
+        file++;
+    }
+
+    parsed.sideToMove = (active == "b") ? PieceColor::BLACK : PieceColor::WHITE;
+
+    parsed.castlingRights = 0;
+    if (castling.find('K') != std::string::npos) parsed.castlingRights |= WHITE_KINGSIDE;
+    if (castling.find('Q') != std::string::npos) parsed.castlingRights |= WHITE_QUEENSIDE;
+    if (castling.find('k') != std::string::npos) parsed.castlingRights |= BLACK_KINGSIDE;
+    if (castling.find('q') != std::string::npos) parsed.castlingRights |= BLACK_QUEENSIDE;
+
+    parsed.epSquare = (ep == "-") ? SQUARE_NONE : squareFromString(ep);
+    // Dropped when no pawn can capture, as makeMove would have
+    if (parsed.epSquare != SQUARE_NONE
+        && !(pawnAttacks(oppositeColor(parsed.sideToMove), parsed.epSquare) & parsed.pieces(parsed.sideToMove, PieceType::PAWN))) {
+        parsed.epSquare = SQUARE_NONE;
+    }
+    parsed.halfmoveClock = half;
+    parsed.fullmoveNumber = full > 0 ? full : 1;
+    parsed.key = parsed.computeKey();
+
+    *this = parsed;
+    return true;
+}
+
+std::string Position::getFEN() const {
+    std::string fen;
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int emptyCount = 0;
+        for (int file = 0; file < 8; file++) {
+            int sq = squareOf(file, rank);
+            if (boardType[sq] == PieceType::NONE) {
+                emptyCount++;
+                continue;
+            }
+            if (emptyCount > 0) {
+                fen += std::to_string(emptyCount);
+                emptyCount = 0;
+            }
+            char pieceChar = pieceTypeToChar(boardType[sq]);
+            if (boardColor[sq] == PieceColor::WHITE) pieceChar = static_cast<char>(std::toupper(pieceChar));
+            fen += pieceChar;
+        }
+        if (emptyCount > 0) fen += std::to_string(emptyCount);
+        if (rank > 0) fen += '/';
+    }
+
+    fen += ' ';
+    fen += (sideToMove == PieceColor::WHITE) ? 'w' : 'b';
+
+    fen += ' ';
+    std::string castling;
+    if (castlingRights & WHITE_KINGSIDE) castling += 'K';
+    if (castlingRights & WHITE_QUEENSIDE) castling += 'Q';
+    if (castlingRights & BLACK_KINGSIDE) castling += 'k';
+    if (castlingRights & BLACK_QUEENSIDE) castling += 'q';
+    if (castling.empty()) castling = "-";
+    fen += castling;
+
+    fen += ' ';
+    if (epSquare == SQUARE_NONE) {
+        fen += '-';
+    } else {
+        // FEN uses lowercase files
+        std::string ep = squareToString(epSquare);
+        ep[0] = static_cast<char>(std::tolower(ep[0]));
+        fen += ep;
+    }
+
+    fen += ' ' + std::to_string(halfmoveClock);
+    fen += ' ' + std::to_string(fullmoveNumber);
+    return fen;
+}
@@ -0,0 +1,119 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <string>
+#include <vector>
+#include "ChessTypes.h"
+#include "Bitboard.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+// Everything makeMove cannot recompute on the way back. Plain data only, so
+// the undo stack never owns or points at anything.
+struct UndoRecord {
+    Move move;
+    PieceType captured;      // NONE if nothing was captured
+    int castlingRights;
+    int epSquare;
+    int halfmoveClock;
+    uint64_t key;
+};
+
+// Undo stack capacity reserved up front; only longer games ever reallocate
+const int MAX_GAME_PLY = 1024;
+
+// Bitboard position: 12 piece bitboards (2 colors x 6 types), per-color and
+// total occupancy, plus a 64-entry mailbox so "what is on this square" is O(1).
+// This is the single source of truth for Board; no rendering state lives here.
+class Position {
+private:
+    Bitboard pieceBB[2][6];
+    Bitboard colorBB[2];
+    Bitboard occupiedBB;
+    PieceType boardType[64];
+    PieceColor boardColor[64];
+
+    PieceColor sideToMove;
+    int castlingRights;   // CastlingRight bitmask
+    int epSquare;         // en passant target square or SQUARE_NONE
+    int halfmoveClock;
+    int fullmoveNumber;
+
+    uint64_t key;         // Zobrist key, kept up to date by every mutator
+
+    std::vector<UndoRecord> undoStack;
+
+public:
+    Position();
+
+    void clear();
+    void setStartPosition();
+    bool setFEN(const std::string& fen);
+    std::string getFEN() const;
+
+    // Piece placement primitives (keep bitboards and mailbox in sync)
+    void putPiece(PieceType type, PieceColor color, int sq);
+    void removePiece(int sq);
+    void movePiece(int from, int to);
+
+    // Queries
+    Bitboard pieces(PieceColor c, PieceType t) const { return pieceBB[static_cast<int>(c)][static_cast<int>(t)]; }
+    Bitboard pieces(PieceColor c) const { return colorBB[static_cast<int>(c)]; }
+    Bitboard occupied() const { return occupiedBB; }
+    PieceType typeAt(int sq) const { return boardType[sq]; }
+    PieceColor colorAt(int sq) const { return boardColor[sq]; }
+    bool isEmpty(int sq) const { return boardType[sq] == PieceType::NONE; }
+    int kingSquare(PieceColor c) const;
+
+    // All pieces of either color attacking sq given the occupancy occ
+    Bitboard attackersTo(int sq, Bitboard occ) const;
+    bool isSquareAttacked(int sq, PieceColor byColor) const;
+    bool isKingInCheck(PieceColor kingColor) const;
+
+    // Legal move generation (MoveGen.cpp). Pins and checks are resolved with
+    // masks up front, so no move is tried and taken back.
+    void generateLegalMoves(MoveList& list) const;
+    Bitboard pinnedPieces(PieceColor c) const;
+
+    // Legal move matching a UCI string ("e2e4", "e7e8q"), MOVE_NONE otherwise
+    Move parseUCIMove(const std::string& uci) const;
+
+    // Standard algebraic notation ("Nbd7", "exd6", "e8=Q+", "O-O"). Parsing
+    // ignores check marks and annotations and rejects ambiguous moves.
+    Move parseSANMove(const std::string& san) const;
+    std::string moveToSAN(Move m); // m must be legal; makes and unmakes it for the check mark
+
+    // Plays a legal move: captures, en passant, castling, promotion, rights,
+    // en passant square, clocks and side to move. A pawn reaching the last rank
+    // with a MOVE_NORMAL encoding stays a pawn (Board's promotion dialog).
+    // No I/O and, within MAX_GAME_PLY, no allocation.
+    void makeMove(Move m);
+    // Takes back the last makeMove exactly, key included
+    void unmakeMove();
+    int historySize() const { return static_cast<int>(undoStack.size()); }
+    Move lastMove() const { return undoStack.empty() ? MOVE_NONE : undoStack.back().move; }
+    Move moveAt(int ply) const { return undoStack[ply].move; } // ply 0 is the first move played
+
+    // True when the current position has occurred `count` times (this one
+    // included) since the last capture or pawn move
+    bool isRepetition(int count) const;
+
+    // Zobrist key of the current position. computeKey() rebuilds it from
+    // scratch and should always equal getKey().
+    uint64_t getKey() const { return key; }
+    uint64_t computeKey() const;
+
+    // Game state (setters keep the key in sync)
+    PieceColor getSideToMove() const { return sideToMove; }
+    void setSideToMove(PieceColor c);
+    int getCastlingRights() const { return castlingRights; }
+    void setCastlingRights(int rights);
+    int getEnPassantSquare() const { return epSquare; }
+    void setEnPassantSquare(int sq);
+    int getHalfmoveClock() const { return halfmoveClock; }
+    void setHalfmoveClock(int n) { halfmoveClock = n; }
+    int getFullmoveNumber() const { return fullmoveNumber; }
+    void setFullmoveNumber(int n) { fullmoveNumber = n; }
+};
+
+#endif // POSITION_H
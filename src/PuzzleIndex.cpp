@@ -0,0 +1,259 @@
+#include "PuzzleIndex.h"
+#include "CsvScanner.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char INDEX_MAGIC[8] = { 'P', 'Z', 'L', 'I', 'D', 'X', 0, 0 };
+const uint32_t INDEX_VERSION = 2;  // 2: rows split by CsvScanner, quoted newlines inside the field
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerLength;      // bytes of CSV header text following this struct
+    uint64_t csvSize;           // the CSV the index was built from
+    int64_t csvTime;
+    uint64_t rows;
+    uint64_t tableSize;
+};
+
+int headerColumn(const std::string& header, const char* name) {
+    int column = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i <= header.size(); ++i) {
+        if (i < header.size() && header[i] != ',') continue;
+        std::string field = header.substr(begin, i - begin);
+        if (field.size() >= 2 && field[0] == '"' && field[field.size() - 1] == '"') field = field.substr(1, field.size() - 2);
+        for (auto& c : field) c = (char)tolower((unsigned char)c);
+        if (field == name) return column;
+        column++;
+        begin = i + 1;
+    }
+    return -1;
+}
+
+int parseRating(const char* text, size_t length) {
+    int value = 0;
+    for (size_t i = 0; i < length && text[i] >= '0' && text[i] <= '9'; ++i) value = value * 10 + (text[i] - '0');
+    return std::min(value, 32767);
+}
+
+// Gathers what the index keeps of each row as the scanner walks the file
+struct IndexVisitor {
+    int idColumn;
+    int ratingColumn;
+    uint64_t base;                  // offset of the scanned text in the file
+    std::vector<uint64_t>& offsets;
+    std::vector<int16_t> rowRatings;
+    std::string idText;             // all ids back to back; idEnds marks where each stops
+    std::vector<uint32_t> idEnds;
+    int column;
+    int rating;
+    const char* id;
+    size_t idLength;
+
+    IndexVisitor(int idCol, int ratingCol, uint64_t textOffset, std::vector<uint64_t>& rowOffsets)
+        : idColumn(idCol), ratingColumn(ratingCol), base(textOffset), offsets(rowOffsets),
+          column(0), rating(0), id(nullptr), idLength(0) {}
+
+    void field(const char* data, size_t length) {
+        if (column == ratingColumn) rating = parseRating(data, length);
+        if (column == idColumn) {
+            id = data;
+            idLength = length;
+        }
+        column++;
+    }
+
+    void row(size_t begin, size_t end) {
+        if (end > begin) {
+            offsets.push_back(base + begin);
+            rowRatings.push_back(static_cast<int16_t>(rating));
+            idText.append(id ? id : "", idLength);
+            idEnds.push_back(static_cast<uint32_t>(idText.size()));
+        }
+        column = 0;
+        rating = 0;
+        id = nullptr;
+        idLength = 0;
+    }
+};
+
+const CsvScanner scanner;
+
+} // namespace
+
+bool PuzzleIndex::open(const std::string& path, const char* data, size_t dataSize) {
+    clear();
+    uint64_t csvSize = 0;
+    int64_t csvTime = 0;
+    if (!MappedFile::stamp(path, csvSize, csvTime)) return false;
+    csvPath = path;
+
+    std::string indexPath = path + ".idx";
+    if (load(indexPath, csvSize, csvTime)) return true;
+
+    std::cout << "Indexing puzzles in " << path << "..." << std::endl;
+    if (!build(data, dataSize)) {
+        clear();
+        return false;
+    }
+    // An index that cannot be written (read-only folder) still serves this session
+    if (!save(indexPath, csvSize, csvTime)) std::cout << "Could not write " << indexPath << std::endl;
+    std::cout << "Indexed " << size() << " puzzles" << std::endl;
+    return true;
+}
+
+void PuzzleIndex::clear() {
+    csvPath.clear();
+    header.clear();
+    offsets.clear();
+    byRating.clear();
+    ratings.clear();
+    idTable.clear();
+}
+
+size_t PuzzleIndex::findId(const std::string& id) const {
+    if (idTable.empty()) return NOT_FOUND;
+    uint64_t h = hashPuzzleId(id.data(), id.size());
+    uint32_t tag = static_cast<uint32_t>(h >> 32);
+    size_t mask = idTable.size() - 1;
+    for (size_t slot = h & mask; idTable[slot].row != 0; slot = (slot + 1) & mask) {
+        if (idTable[slot].tag == tag) return idTable[slot].row - 1;
+    }
+    return NOT_FOUND;
+}
+
+void PuzzleIndex::insertId(const char* id, size_t length, uint32_t row) {
+    uint64_t h = hashPuzzleId(id, length);
+    size_t mask = idTable.size() - 1;
+    size_t slot = h & mask;
+    while (idTable[slot].row != 0) slot = (slot + 1) & mask;
+    idTable[slot].tag = static_cast<uint32_t>(h >> 32);
+    idTable[slot].row = row + 1;
+}
+
+bool PuzzleIndex::build(const char* data, size_t dataSize) {
+    const char* end = data + dataSize;
+    const char* line = static_cast<const char*>(std::memchr(data, '\n', dataSize));
+    if (!line) return false;
+    header.assign(data, line);
+    if (!header.empty() && header[header.size() - 1] == '\r') header.erase(header.size() - 1);
+    line++;
+
+    int idColumn = headerColumn(header, "puzzleid");
+    int ratingColumn = headerColumn(header, "rating");
+    if (idColumn < 0 || ratingColumn < 0) return false;
+
+    // One pass over the rows, keeping the id and rating of each non-blank line
+    IndexVisitor scanned(idColumn, ratingColumn, static_cast<uint64_t>(line - data), offsets);
+    scanner.scan(line, end - line, scanned);
+    offsets.push_back(static_cast<uint64_t>(dataSize));
+
+    const std::vector<int16_t>& rowRatings = scanned.rowRatings;
+    size_t count = rowRatings.size();
+    byRating.resize(count);
+    for (size_t i = 0; i < count; ++i) byRating[i] = static_cast<uint32_t>(i);
+    std::stable_sort(byRating.begin(), byRating.end(),
+                     [&rowRatings](uint32_t a, uint32_t b) { return rowRatings[a] < rowRatings[b]; });
+    ratings.resize(count);
+    for (size_t i = 0; i < count; ++i) ratings[i] = rowRatings[byRating[i]];
+
+    // At most half full, so probes stay short
+    size_t tableSize = 16;
+    while (tableSize < count * 2) tableSize <<= 1;
+    IdSlot empty = { 0, 0 };
+    idTable.assign(tableSize, empty);
+    uint32_t idStart = 0;
+    for (size_t i = 0; i < count; ++i) {
+        insertId(scanned.idText.data() + idStart, scanned.idEnds[i] - idStart, static_cast<uint32_t>(i));
+        idStart = scanned.idEnds[i];
+    }
+    return true;
+}
+
+bool PuzzleIndex::load(const std::string& indexPath, uint64_t csvSize, int64_t csvTime) {
+    std::ifstream in(indexPath, std::ios::in | std::ios::binary);
+    if (!in.is_open()) return false;
+
+    IndexHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    if (std::memcmp(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || h.version != INDEX_VERSION
+        || h.csvSize != csvSize || h.csvTime != csvTime) {
+        return false;
+    }
+
+    // A damaged sidecar must not size the tables: the counts have to
+    // account for exactly the bytes the file holds
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(sizeof(h), std::ios::beg);
+    uint64_t bytesPerRow = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(int16_t);
+    uint64_t available = fileSize - sizeof(h);
+    if (h.headerLength > available || h.rows > available / bytesPerRow || h.tableSize > available / sizeof(IdSlot)
+        || h.rows > UINT32_MAX || h.tableSize == 0 || (h.tableSize & (h.tableSize - 1)) != 0
+        || h.headerLength + (h.rows * bytesPerRow + sizeof(uint64_t)) + h.tableSize * sizeof(IdSlot) != available) {
+        return false;
+    }
+
+    header.resize(h.headerLength);
+    offsets.resize(h.rows + 1);
+    byRating.resize(h.rows);
+    ratings.resize(h.rows);
+    idTable.resize(h.tableSize);
+    in.read(&header[0], h.headerLength);
+    in.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(byRating.data()), byRating.size() * sizeof(uint32_t));
+    in.read(reinterpret_cast<char*>(ratings.data()), ratings.size() * sizeof(int16_t));
+    in.read(reinterpret_cast<char*>(idTable.data()), idTable.size() * sizeof(IdSlot));
+
+    // Every row must lie inside the CSV, and every reference point at a row
+    bool valid = static_cast<bool>(in) && offsets.back() <= csvSize;
+    for (size_t i = 1; valid && i < offsets.size(); ++i) valid = offsets[i - 1] <= offsets[i];
+    for (size_t i = 0; valid && i < byRating.size(); ++i) valid = byRating[i] < h.rows;
+    for (size_t i = 0; valid && i < idTable.size(); ++i) valid = idTable[i].row <= h.rows;
+    if (!valid) {
+        std::string path = csvPath;
+        clear();
+        csvPath = path;
+        return false;
+    }
+    return true;
+}
+
+bool PuzzleIndex::save(const std::string& indexPath, uint64_t csvSize, int64_t csvTime) const {
+    // Written aside and renamed, so a crash never leaves a half index behind
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        IndexHeader h;
+        std::memcpy(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        h.version = INDEX_VERSION;
+        h.headerLength = static_cast<uint32_t>(header.size());
+        h.csvSize = csvSize;
+        h.csvTime = csvTime;
+        h.rows = byRating.size();
+        h.tableSize = idTable.size();
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(header.data(), header.size());
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(byRating.data()), byRating.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(ratings.data()), ratings.size() * sizeof(int16_t));
+        out.write(reinterpret_cast<const char*>(idTable.data()), idTable.size() * sizeof(IdSlot));
+        if (!out) {
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    std::remove(indexPath.c_str());
+    return std::rename(tempPath.c_str(), indexPath.c_str()) == 0;
+}
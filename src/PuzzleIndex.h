@@ -0,0 +1,60 @@
+#ifndef PUZZLE_INDEX_H
+#define PUZZLE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PuzzleSource.h"
+
+// Sidecar index over a Lichess puzzle CSV, kept next to it as "<csv>.idx":
+// the byte offset of every row, the rows sorted by rating, and a hash table
+// from PuzzleId to row. It is built in one pass over the CSV the first time
+// the file is used and reused for as long as the CSV's size and modification
+// time are unchanged. Rows are numbered from 0, header excluded.
+class PuzzleIndex {
+public:
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    // Loads the sidecar, building (and writing) it first from the CSV's bytes
+    // [data, data + size) if it is missing or stale
+    bool open(const std::string& csvPath, const char* data, size_t size);
+    void clear();
+
+    const std::string& getCsvPath() const { return csvPath; }
+    const std::string& getHeader() const { return header; }   // the CSV's first line
+    size_t size() const { return byRating.size(); }
+
+    // Row bytes are [rowOffset, rowEnd), line ending included
+    uint64_t rowOffset(size_t row) const { return offsets[row]; }
+    uint64_t rowEnd(size_t row) const { return offsets[row + 1]; }
+
+    // Row whose PuzzleId hashes like `id`, or NOT_FOUND. Tags are 32 bits, so
+    // the caller confirms the id against the row it reads
+    size_t findId(const std::string& id) const;
+
+    RatingOrder ratingOrder() const {
+        RatingOrder order = { byRating.data(), ratings.data(), byRating.size() };
+        return order;
+    }
+
+private:
+    struct IdSlot {
+        uint32_t tag;       // high half of the id's hash
+        uint32_t row;       // row + 1; 0 is an empty slot
+    };
+
+    std::string csvPath;
+    std::string header;
+    std::vector<uint64_t> offsets;      // size() + 1 entries; the last is the end of the data
+    std::vector<uint32_t> byRating;     // rows, lowest rating first
+    std::vector<int16_t> ratings;       // their ratings, sorted
+    std::vector<IdSlot> idTable;        // open addressing, power-of-two size
+
+    bool build(const char* data, size_t size);
+    bool load(const std::string& indexPath, uint64_t csvSize, int64_t csvTime);
+    bool save(const std::string& indexPath, uint64_t csvSize, int64_t csvTime) const;
+    void insertId(const char* id, size_t length, uint32_t row);
+};
+
+#endif // PUZZLE_INDEX_H
@@ -0,0 +1,555 @@
+#include "PuzzlePack.h"
+#include "Move.h"
+#include "UciInfo.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
+
+// Fixed-size puzzle record; all multi-byte fields are naturally aligned
+struct PuzzlePackRecord {
+    uint8_t board[32];          // a nibble per square, a1 = square 0 in the low nibble of byte 0
+    uint8_t flags;              // PACK_BLACK_TO_MOVE, castling rights, PACK_LICHESS_URL
+    uint8_t epFile;             // en passant file + 1, 0 if none
+    uint8_t halfmoveClock;
+    uint8_t moveCount;
+    uint16_t fullmoveNumber;
+    int16_t rating;
+    uint16_t ratingDeviation;
+    int8_t popularity;
+    uint8_t urlLength;          // 0: no URL
+    uint32_t nbPlays;
+    uint32_t firstMove;         // into the move section
+    uint32_t urlOffset;         // into the URL section
+    uint32_t themeSet;          // into the theme sets; 0 is the empty set
+    uint16_t openingSet;        // into the opening sets; 0 is the empty set
+    uint16_t reserved;
+};
+
+static_assert(sizeof(PuzzlePackRecord) == 64, "puzzle records are 64 bytes");
+
+namespace {
+
+const char PACK_MAGIC[8] = { 'P', 'Z', 'L', 'P', 'A', 'C', 'K', 0 };
+const uint32_t PACK_VERSION = 1;
+
+const size_t ID_BYTES = 8;
+const size_t MAX_THEMES = 128;          // bits in a theme set
+const size_t OPENING_TAGS = 3;          // per puzzle; Lichess writes a family and a variation
+const size_t MAX_OPENING_SETS = 65536;
+
+const uint8_t PACK_BLACK_TO_MOVE = 1 << 0;
+const uint8_t PACK_CASTLE_WK = 1 << 1;
+const uint8_t PACK_CASTLE_WQ = 1 << 2;
+const uint8_t PACK_CASTLE_BK = 1 << 3;
+const uint8_t PACK_CASTLE_BQ = 1 << 4;
+const uint8_t PACK_LICHESS_URL = 1 << 5;   // URL stored without LICHESS_PREFIX
+
+const char LICHESS_PREFIX[] = "https://lichess.org/";
+const size_t LICHESS_PREFIX_LENGTH = sizeof(LICHESS_PREFIX) - 1;
+
+// Nibble code -> FEN letter; 0 is an empty square, '?' codes are unused
+const char PIECE_CODES[] = "?PNBRQK??pnbrqk?";
+
+enum PackSectionId {
+    SECTION_RECORDS,
+    SECTION_MOVES,
+    SECTION_URLS,
+    SECTION_IDS,
+    SECTION_ID_TABLE,
+    SECTION_BY_RATING,
+    SECTION_RATINGS,
+    SECTION_THEME_NAMES,
+    SECTION_THEME_SETS,
+    SECTION_OPENING_NAMES,
+    SECTION_OPENING_SETS,
+    SECTION_COUNT
+};
+
+struct PackSection {
+    uint64_t offset;            // from the start of the file, 8-byte aligned
+    uint64_t bytes;
+};
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+    uint64_t idTableSize;       // slots, a power of two
+    PackSection sections[SECTION_COUNT];
+};
+
+bool encodeFen(const std::string& fen, PuzzlePackRecord& r) {
+    std::istringstream parts(fen);
+    std::string placement, side, castling, ep;
+    int halfmove = 0;
+    int fullmove = 1;
+    if (!(parts >> placement >> side >> castling >> ep)) return false;
+    parts >> halfmove >> fullmove;
+
+    int rank = 7;
+    int file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return false;
+        } else {
+            const char* code = c == '?' ? nullptr : std::strchr(PIECE_CODES, c);
+            if (!code || file > 7) return false;
+            int square = rank * 8 + file;
+            r.board[square / 2] |= static_cast<uint8_t>((code - PIECE_CODES) << ((square & 1) * 4));
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8) return false;
+
+    if (side == "b") r.flags |= PACK_BLACK_TO_MOVE;
+    else if (side != "w") return false;
+    for (char c : castling) {
+        if (c == 'K') r.flags |= PACK_CASTLE_WK;
+        else if (c == 'Q') r.flags |= PACK_CASTLE_WQ;
+        else if (c == 'k') r.flags |= PACK_CASTLE_BK;
+        else if (c == 'q') r.flags |= PACK_CASTLE_BQ;
+        else if (c != '-') return false;
+    }
+    if (ep != "-") {
+        if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || (ep[1] != '3' && ep[1] != '6')) return false;
+        r.epFile = static_cast<uint8_t>(ep[0] - 'a' + 1);
+    }
+    r.halfmoveClock = static_cast<uint8_t>(std::max(0, std::min(255, halfmove)));
+    r.fullmoveNumber = static_cast<uint16_t>(std::max(1, std::min(65535, fullmove)));
+    return true;
+}
+
+std::string decodeFen(const PuzzlePackRecord& r) {
+    std::string fen;
+    fen.reserve(96);
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            int square = rank * 8 + file;
+            int code = (r.board[square / 2] >> ((square & 1) * 4)) & 15;
+            if (code == 0) {
+                empty++;
+                continue;
+            }
+            if (empty) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += PIECE_CODES[code];
+        }
+        if (empty) fen += static_cast<char>('0' + empty);
+        if (rank > 0) fen += '/';
+    }
+    bool blackToMove = (r.flags & PACK_BLACK_TO_MOVE) != 0;
+    fen += blackToMove ? " b " : " w ";
+    size_t castlingStart = fen.size();
+    if (r.flags & PACK_CASTLE_WK) fen += 'K';
+    if (r.flags & PACK_CASTLE_WQ) fen += 'Q';
+    if (r.flags & PACK_CASTLE_BK) fen += 'k';
+    if (r.flags & PACK_CASTLE_BQ) fen += 'q';
+    if (fen.size() == castlingStart) fen += '-';
+    fen += ' ';
+    if (r.epFile) {
+        fen += static_cast<char>('a' + r.epFile - 1);
+        fen += blackToMove ? '3' : '6';
+    } else {
+        fen += '-';
+    }
+    fen += ' ' + std::to_string(r.halfmoveClock) + ' ' + std::to_string(r.fullmoveNumber);
+    return fen;
+}
+
+std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    std::string word;
+    while (in >> word) words.push_back(word);
+    return words;
+}
+
+std::vector<std::string> splitNames(const char* text, size_t bytes) {
+    std::vector<std::string> names;
+    size_t start = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        if (text[i] != '\n') continue;
+        names.push_back(std::string(text + start, i - start));
+        start = i + 1;
+    }
+    return names;
+}
+
+template <typename T>
+T clampTo(long long value) {
+    const long long lo = static_cast<long long>(std::numeric_limits<T>::min());
+    const long long hi = static_cast<long long>(std::numeric_limits<T>::max());
+    return static_cast<T>(std::max(lo, std::min(hi, value)));
+}
+
+} // namespace
+
+PuzzlePack::PuzzlePack() {
+    close();
+}
+
+bool PuzzlePack::isPack(const std::string& filePath) {
+    std::ifstream in(filePath, std::ios::in | std::ios::binary);
+    char magic[sizeof(PACK_MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, PACK_MAGIC, sizeof(magic)) == 0;
+}
+
+bool PuzzlePack::open(const std::string& packPath) {
+    close();
+    if (!file.open(packPath) || file.size() < sizeof(PackHeader)) {
+        close();
+        return false;
+    }
+    PackHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || h.version != PACK_VERSION
+        || h.recordSize != sizeof(PuzzlePackRecord) || h.idTableSize == 0 || (h.idTableSize & (h.idTableSize - 1)) != 0) {
+        close();
+        return false;
+    }
+    for (int i = 0; i < SECTION_COUNT; ++i) {
+        const PackSection& s = h.sections[i];
+        if (s.offset % 8 != 0 || s.offset > file.size() || s.bytes > file.size() - s.offset) {
+            close();
+            return false;
+        }
+    }
+    const PackSection* s = h.sections;
+    if (s[SECTION_RECORDS].bytes != h.count * sizeof(PuzzlePackRecord) || s[SECTION_IDS].bytes != h.count * ID_BYTES
+        || s[SECTION_ID_TABLE].bytes != h.idTableSize * sizeof(uint32_t)
+        || s[SECTION_BY_RATING].bytes != h.count * sizeof(uint32_t) || s[SECTION_RATINGS].bytes != h.count * sizeof(int16_t)) {
+        close();
+        return false;
+    }
+
+    const char* base = file.data();
+    count = static_cast<size_t>(h.count);
+    records = reinterpret_cast<const PuzzlePackRecord*>(base + s[SECTION_RECORDS].offset);
+    moves = reinterpret_cast<const uint16_t*>(base + s[SECTION_MOVES].offset);
+    moveTotal = static_cast<size_t>(s[SECTION_MOVES].bytes / sizeof(uint16_t));
+    urls = base + s[SECTION_URLS].offset;
+    urlBytes = static_cast<size_t>(s[SECTION_URLS].bytes);
+    ids = base + s[SECTION_IDS].offset;
+    idTable = reinterpret_cast<const uint32_t*>(base + s[SECTION_ID_TABLE].offset);
+    idTableSize = static_cast<size_t>(h.idTableSize);
+    byRating = reinterpret_cast<const uint32_t*>(base + s[SECTION_BY_RATING].offset);
+    ratings = reinterpret_cast<const int16_t*>(base + s[SECTION_RATINGS].offset);
+    themeSets = reinterpret_cast<const uint64_t*>(base + s[SECTION_THEME_SETS].offset);
+    themeSetCount = static_cast<size_t>(s[SECTION_THEME_SETS].bytes / (2 * sizeof(uint64_t)));
+    openingSets = reinterpret_cast<const uint16_t*>(base + s[SECTION_OPENING_SETS].offset);
+    openingSetCount = static_cast<size_t>(s[SECTION_OPENING_SETS].bytes / (OPENING_TAGS * sizeof(uint16_t)));
+    themeNames = splitNames(base + s[SECTION_THEME_NAMES].offset, static_cast<size_t>(s[SECTION_THEME_NAMES].bytes));
+    openingNames = splitNames(base + s[SECTION_OPENING_NAMES].offset, static_cast<size_t>(s[SECTION_OPENING_NAMES].bytes));
+    path = packPath;
+    return true;
+}
+
+void PuzzlePack::close() {
+    file.close();
+    path.clear();
+    count = 0;
+    records = nullptr;
+    moves = nullptr;
+    moveTotal = 0;
+    urls = nullptr;
+    urlBytes = 0;
+    ids = nullptr;
+    idTable = nullptr;
+    idTableSize = 0;
+    byRating = nullptr;
+    ratings = nullptr;
+    themeSets = nullptr;
+    themeSetCount = 0;
+    openingSets = nullptr;
+    openingSetCount = 0;
+    themeNames.clear();
+    openingNames.clear();
+}
+
+bool PuzzlePack::load(size_t row, Puzzle& out) const {
+    if (!loadTags(row, out)) return false;
+    const PuzzlePackRecord& r = records[row];
+    if (r.firstMove > moveTotal || r.moveCount > moveTotal - r.firstMove) return false;
+
+    out.fen = decodeFen(r);
+    out.moves.clear();
+    for (int i = 0; i < r.moveCount; ++i) out.moves.push_back(moveToUCI(moves[r.firstMove + i]));
+    out.ratingDeviation = r.ratingDeviation;
+    out.popularity = r.popularity;
+    out.nbPlays = static_cast<int>(r.nbPlays);
+    out.gameUrl.clear();
+    if (r.urlLength > 0 && r.urlOffset <= urlBytes && r.urlLength <= urlBytes - r.urlOffset) {
+        if (r.flags & PACK_LICHESS_URL) out.gameUrl = LICHESS_PREFIX;
+        out.gameUrl.append(urls + r.urlOffset, r.urlLength);
+    }
+    return true;
+}
+
+bool PuzzlePack::loadTags(size_t row, Puzzle& out) const {
+    if (row >= count) return false;
+    const PuzzlePackRecord& r = records[row];
+    const char* id = ids + row * ID_BYTES;
+    size_t idLength = 0;
+    while (idLength < ID_BYTES && id[idLength] != 0) idLength++;
+    out.id.assign(id, idLength);
+    out.rating = r.rating;
+
+    out.themes.clear();
+    if (r.themeSet < themeSetCount) {
+        const uint64_t* set = themeSets + 2 * r.themeSet;
+        for (size_t bit = 0; bit < MAX_THEMES && bit < themeNames.size(); ++bit) {
+            if (!(set[bit / 64] & (1ULL << (bit % 64)))) continue;
+            if (!out.themes.empty()) out.themes += ' ';
+            out.themes += themeNames[bit];
+        }
+    }
+    out.openingTags.clear();
+    if (r.openingSet < openingSetCount) {
+        const uint16_t* set = openingSets + OPENING_TAGS * r.openingSet;
+        for (size_t i = 0; i < OPENING_TAGS && set[i] != 0 && set[i] <= openingNames.size(); ++i) {
+            if (!out.openingTags.empty()) out.openingTags += ' ';
+            out.openingTags += openingNames[set[i] - 1];
+        }
+    }
+    return true;
+}
+
+size_t PuzzlePack::findId(const std::string& id) const {
+    if (idTableSize == 0 || id.empty() || id.size() > ID_BYTES) return NOT_FOUND;
+    size_t mask = idTableSize - 1;
+    for (size_t slot = hashPuzzleId(id.data(), id.size()) & mask; idTable[slot] != 0; slot = (slot + 1) & mask) {
+        size_t row = idTable[slot] - 1;
+        if (row >= count) break;
+        const char* stored = ids + row * ID_BYTES;
+        if (std::memcmp(stored, id.data(), id.size()) == 0 && (id.size() == ID_BYTES || stored[id.size()] == 0)) return row;
+    }
+    return NOT_FOUND;
+}
+
+RatingOrder PuzzlePack::ratingOrder() const {
+    RatingOrder order = { byRating, ratings, count };
+    return order;
+}
+
+bool PuzzlePack::write(const PuzzleSource& source, const std::string& outPath, size_t& skipped, std::string& error) {
+    skipped = 0;
+    std::vector<PuzzlePackRecord> records;
+    std::vector<uint16_t> moveCodes;
+    std::string urlText;
+    std::string idBytes;
+    std::vector<int16_t> rowRatings;
+    records.reserve(source.size());
+
+    // Set 0 of both tables is the empty set
+    std::map<std::string, size_t> themeBits;
+    std::vector<std::string> themeNames;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> themeSetIds;
+    std::vector<uint64_t> themeSets(2, 0);
+    themeSetIds[std::make_pair(0ULL, 0ULL)] = 0;
+    std::map<std::string, uint16_t> openingIds;
+    std::vector<std::string> openingNames;
+    std::map<uint64_t, uint16_t> openingSetIds;
+    std::vector<uint16_t> openingSets(OPENING_TAGS, 0);
+    openingSetIds[0] = 0;
+    size_t droppedThemes = 0;
+    size_t droppedOpenings = 0;
+    size_t droppedOpeningSets = 0;
+
+    Puzzle p;
+    for (size_t i = 0; i < source.size(); ++i) {
+        PuzzlePackRecord r;
+        std::memset(&r, 0, sizeof(r));
+        if (!source.load(i, p) || p.id.empty() || p.id.size() > ID_BYTES || p.moves.size() > 255
+            || !encodeFen(p.fen, r)) {
+            skipped++;
+            continue;
+        }
+
+        size_t firstMove = moveCodes.size();
+        bool movesOk = true;
+        for (const std::string& text : p.moves) {
+            Move m = parseUciMoveText(text.data(), text.size());
+            movesOk = movesOk && m != MOVE_NONE;
+            moveCodes.push_back(m);
+        }
+        if (!movesOk) {
+            moveCodes.resize(firstMove);
+            skipped++;
+            continue;
+        }
+        r.firstMove = static_cast<uint32_t>(firstMove);
+        r.moveCount = static_cast<uint8_t>(p.moves.size());
+        r.rating = clampTo<int16_t>(p.rating);
+        r.ratingDeviation = clampTo<uint16_t>(p.ratingDeviation);
+        r.popularity = clampTo<int8_t>(p.popularity);
+        r.nbPlays = clampTo<uint32_t>(p.nbPlays);
+
+        uint64_t themeMask[2] = { 0, 0 };
+        for (const std::string& name : splitWords(p.themes)) {
+            std::map<std::string, size_t>::iterator it = themeBits.find(name);
+            if (it == themeBits.end()) {
+                if (themeNames.size() >= MAX_THEMES) {
+                    droppedThemes++;
+                    continue;
+                }
+                it = themeBits.insert(std::make_pair(name, themeNames.size())).first;
+                themeNames.push_back(name);
+            }
+            themeMask[it->second / 64] |= 1ULL << (it->second % 64);
+        }
+        std::pair<uint64_t, uint64_t> themeKey(themeMask[0], themeMask[1]);
+        std::map<std::pair<uint64_t, uint64_t>, uint32_t>::iterator themeSet = themeSetIds.find(themeKey);
+        if (themeSet == themeSetIds.end()) {
+            themeSet = themeSetIds.insert(std::make_pair(themeKey, static_cast<uint32_t>(themeSets.size() / 2))).first;
+            themeSets.push_back(themeMask[0]);
+            themeSets.push_back(themeMask[1]);
+        }
+        r.themeSet = themeSet->second;
+
+        uint16_t tags[OPENING_TAGS] = { 0, 0, 0 };
+        std::vector<std::string> tagNames = splitWords(p.openingTags);
+        if (tagNames.size() > OPENING_TAGS) droppedOpenings += tagNames.size() - OPENING_TAGS;
+        for (size_t t = 0; t < tagNames.size() && t < OPENING_TAGS; ++t) {
+            std::map<std::string, uint16_t>::iterator it = openingIds.find(tagNames[t]);
+            if (it == openingIds.end()) {
+                if (openingNames.size() >= 65535) {
+                    droppedOpenings++;
+                    continue;
+                }
+                openingNames.push_back(tagNames[t]);
+                it = openingIds.insert(std::make_pair(tagNames[t], static_cast<uint16_t>(openingNames.size()))).first;
+            }
+            tags[t] = it->second;
+        }
+        uint64_t openingKey = tags[0] | (static_cast<uint64_t>(tags[1]) << 16) | (static_cast<uint64_t>(tags[2]) << 32);
+        std::map<uint64_t, uint16_t>::iterator openingSet = openingSetIds.find(openingKey);
+        if (openingSet == openingSetIds.end()) {
+            if (openingSets.size() / OPENING_TAGS < MAX_OPENING_SETS) {
+                uint16_t next = static_cast<uint16_t>(openingSets.size() / OPENING_TAGS);
+                openingSet = openingSetIds.insert(std::make_pair(openingKey, next)).first;
+                openingSets.insert(openingSets.end(), tags, tags + OPENING_TAGS);
+            } else {
+                droppedOpeningSets++;
+            }
+        }
+        r.openingSet = openingSet == openingSetIds.end() ? 0 : openingSet->second;
+
+        std::string url = p.gameUrl;
+        if (url.compare(0, LICHESS_PREFIX_LENGTH, LICHESS_PREFIX) == 0) {
+            url.erase(0, LICHESS_PREFIX_LENGTH);
+            r.flags |= PACK_LICHESS_URL;
+        }
+        if (!url.empty() && url.size() <= 255) {
+            r.urlOffset = static_cast<uint32_t>(urlText.size());
+            r.urlLength = static_cast<uint8_t>(url.size());
+            urlText += url;
+        }
+
+        idBytes.append(p.id);
+        idBytes.append(ID_BYTES - p.id.size(), '\0');
+        rowRatings.push_back(r.rating);
+        records.push_back(r);
+    }
+    // Puzzles keep their place when tags do not fit; the caller is told what was lost
+    std::vector<std::string> notes;
+    if (droppedThemes > 0) notes.push_back("themes past the first 128 were dropped");
+    if (droppedOpenings > 0) {
+        notes.push_back(std::to_string(droppedOpenings) + " opening tags past the third of a puzzle or the first 65535 names were dropped");
+    }
+    if (droppedOpeningSets > 0) {
+        notes.push_back(std::to_string(droppedOpeningSets) + " puzzles lost their openings past the first 65536 combinations");
+    }
+    for (size_t i = 0; i < notes.size(); ++i) error += (i ? "; " : "") + notes[i];
+
+    size_t rows = records.size();
+    std::vector<uint32_t> byRating(rows);
+    for (size_t i = 0; i < rows; ++i) byRating[i] = static_cast<uint32_t>(i);
+    std::stable_sort(byRating.begin(), byRating.end(),
+                     [&rowRatings](uint32_t a, uint32_t b) { return rowRatings[a] < rowRatings[b]; });
+    std::vector<int16_t> sortedRatings(rows);
+    for (size_t i = 0; i < rows; ++i) sortedRatings[i] = rowRatings[byRating[i]];
+
+    size_t tableSize = 16;
+    while (tableSize < rows * 2) tableSize <<= 1;
+    std::vector<uint32_t> idTable(tableSize, 0);
+    for (size_t i = 0; i < rows; ++i) {
+        const char* id = idBytes.data() + i * ID_BYTES;
+        size_t length = 0;
+        while (length < ID_BYTES && id[length] != 0) length++;
+        size_t slot = hashPuzzleId(id, length) & (tableSize - 1);
+        while (idTable[slot] != 0) slot = (slot + 1) & (tableSize - 1);
+        idTable[slot] = static_cast<uint32_t>(i + 1);
+    }
+
+    std::string themeText;
+    for (const std::string& name : themeNames) themeText += name + '\n';
+    std::string openingText;
+    for (const std::string& name : openingNames) openingText += name + '\n';
+
+    // Written aside and renamed, so a failed conversion never leaves a half
+    // pack where the old one was
+    std::string tempPath = outPath + ".tmp";
+    std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "cannot write " + tempPath;
+        return false;
+    }
+    PackHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    h.version = PACK_VERSION;
+    h.recordSize = sizeof(PuzzlePackRecord);
+    h.count = rows;
+    h.idTableSize = tableSize;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    uint64_t offset = sizeof(h);
+    auto section = [&](PackSectionId id, const void* data, size_t bytes) {
+        static const char zeros[8] = { 0 };
+        size_t pad = static_cast<size_t>((8 - offset % 8) % 8);
+        out.write(zeros, pad);
+        offset += pad;
+        h.sections[id].offset = offset;
+        h.sections[id].bytes = bytes;
+        out.write(static_cast<const char*>(data), bytes);
+        offset += bytes;
+    };
+    section(SECTION_RECORDS, records.data(), rows * sizeof(PuzzlePackRecord));
+    section(SECTION_MOVES, moveCodes.data(), moveCodes.size() * sizeof(uint16_t));
+    section(SECTION_URLS, urlText.data(), urlText.size());
+    section(SECTION_IDS, idBytes.data(), idBytes.size());
+    section(SECTION_ID_TABLE, idTable.data(), idTable.size() * sizeof(uint32_t));
+    section(SECTION_BY_RATING, byRating.data(), byRating.size() * sizeof(uint32_t));
+    section(SECTION_RATINGS, sortedRatings.data(), sortedRatings.size() * sizeof(int16_t));
+    section(SECTION_THEME_NAMES, themeText.data(), themeText.size());
+    section(SECTION_THEME_SETS, themeSets.data(), themeSets.size() * sizeof(uint64_t));
+    section(SECTION_OPENING_NAMES, openingText.data(), openingText.size());
+    section(SECTION_OPENING_SETS, openingSets.data(), openingSets.size() * sizeof(uint16_t));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.close();
+    if (!out) {
+        std::remove(tempPath.c_str());
+        error = "write to " + tempPath + " failed";
+        return false;
+    }
+    std::remove(outPath.c_str());
+    if (std::rename(tempPath.c_str(), outPath.c_str()) != 0) {
+        error = "cannot replace " + outPath;
+        return false;
+    }
+    return true;
+}
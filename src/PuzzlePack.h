@@ -0,0 +1,69 @@
+#ifndef PUZZLE_PACK_H
+#define PUZZLE_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PuzzleSource.h"
+
+struct PuzzlePackRecord;
+
+// Binary puzzle collection (".pzl"), converted once from the Lichess CSV by
+// tools/puzzlepack and mapped whole. A puzzle is a fixed 64-byte record: the
+// board as a nibble per square, side to move, castling and en passant in
+// three bytes, rating, deviation, popularity and plays as integers, and
+// indexes into shared tables for its moves (16-bit Move codes), themes (a
+// bitmask per distinct theme set, so their order is not kept), opening tags
+// and game URL. The file also carries the id table and the rating order, so
+// nothing is built on load.
+class PuzzlePack : public PuzzleSource {
+public:
+    PuzzlePack();
+
+    bool open(const std::string& path) override;
+    void close() override;
+    bool isOpen() const override { return file.isOpen(); }
+    const std::string& getPath() const override { return path; }
+
+    size_t size() const override { return count; }
+    bool load(size_t row, Puzzle& out) const override;
+    bool loadTags(size_t row, Puzzle& out) const override;
+    size_t findId(const std::string& id) const override;
+    RatingOrder ratingOrder() const override;
+
+    // True if the file starts like a pack, so callers can pick the reader
+    static bool isPack(const std::string& path);
+
+    // Converts every puzzle of `source` into a pack at `outPath`. Puzzles that
+    // do not fit the format (bad FEN, id over 8 characters) are skipped and
+    // counted in `skipped`; false and `error` set if the file cannot be written.
+    // Themes and opening tags that do not fit are dropped from their puzzle
+    // and described in `error`, which is then set on success as well.
+    static bool write(const PuzzleSource& source, const std::string& outPath,
+                      size_t& skipped, std::string& error);
+
+private:
+    MappedFile file;
+    std::string path;
+    size_t count;
+    const PuzzlePackRecord* records;
+    const uint16_t* moves;
+    size_t moveTotal;
+    const char* urls;
+    size_t urlBytes;
+    const char* ids;                    // 8 bytes per row, NUL padded
+    const uint32_t* idTable;            // row + 1, 0 for an empty slot
+    size_t idTableSize;
+    const uint32_t* byRating;
+    const int16_t* ratings;
+    const uint64_t* themeSets;          // two words per set
+    size_t themeSetCount;
+    const uint16_t* openingSets;        // three tag numbers + 1 per set
+    size_t openingSetCount;
+    std::vector<std::string> themeNames;
+    std::vector<std::string> openingNames;
+};
+
+#endif // PUZZLE_PACK_H
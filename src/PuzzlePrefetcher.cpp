@@ -0,0 +1,242 @@
+#include "PuzzlePrefetcher.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <utility>
+
+namespace {
+
+// Half-width of the rating band draws start from, as before the prefetcher
+const int RATING_WINDOW = 100;
+// Draws in a row that fail to set up before the worker stops trying
+const int MAX_FAILURES = 64;
+
+} // namespace
+
+PuzzlePrefetcher::PuzzlePrefetcher(size_t prefetchDepth)
+    : stopping(false), reading(false), generation(0), session(0), source(nullptr), depth(prefetchDepth), rating(1500),
+      filterNext(0), rng(static_cast<unsigned int>(std::time(nullptr))), failures(0), reviewFound(false) {
+    worker = std::thread(&PuzzlePrefetcher::run, this);
+}
+
+PuzzlePrefetcher::~PuzzlePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void PuzzlePrefetcher::reset(const PuzzleSource* newSource) {
+    std::unique_lock<std::mutex> lock(mutex);
+    generation++;
+    session++;
+    idle.wait(lock, [this]() { return !reading; });
+    source = newSource;
+    RatingOrder none = { nullptr, nullptr, 0 };
+    sampler.reset(source ? source->ratingOrder() : none);
+    filterRows.clear();
+    filterNext = 0;
+    draws.clear();
+    reviewId.clear();
+    preparedReviewId.clear();
+    lastHanded = PreparedPuzzle();
+    failures = 0;
+    wake.notify_one();
+}
+
+void PuzzlePrefetcher::setDepth(size_t newDepth) {
+    std::lock_guard<std::mutex> lock(mutex);
+    depth = newDepth;
+    while (draws.size() > depth) {
+        release(draws.back().position);
+        draws.pop_back();
+    }
+    wake.notify_one();
+}
+
+size_t PuzzlePrefetcher::getDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return depth;
+}
+
+void PuzzlePrefetcher::setRating(int newRating) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rating = newRating;
+    dropStale();
+    wake.notify_one();
+}
+
+void PuzzlePrefetcher::setFilter(const std::vector<uint32_t>& rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Served in a shuffled order, so no match repeats until all have come up
+    filterRows = rows;
+    std::shuffle(filterRows.begin(), filterRows.end(), rng);
+    filterNext = 0;
+    generation++;
+    clearDraws();
+    failures = 0;
+    wake.notify_one();
+}
+
+void PuzzlePrefetcher::setReview(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id == reviewId) return;
+    reviewId = id;
+    wake.notify_one();
+}
+
+size_t PuzzlePrefetcher::ready() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return draws.size();
+}
+
+bool PuzzlePrefetcher::next(PreparedPuzzle& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    dropStale();
+    if (!draws.empty()) {
+        out = std::move(draws.front().prepared);
+        draws.pop_front();
+        lastHanded = out;
+        wake.notify_one();
+        return true;
+    }
+
+    // Nothing prepared yet (the first puzzle, depth 0, or the worker fell behind)
+    if (!source) return false;
+    for (int attempt = 0; attempt < MAX_FAILURES; ++attempt) {
+        size_t row = 0;
+        size_t position = PuzzleSampler::NOT_FOUND;
+        if (!pick(row, position)) return false;
+        if (prepare(*source, row, out)) {
+            lastHanded = out;
+            wake.notify_one();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PuzzlePrefetcher::review(const std::string& id, PreparedPuzzle& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id.empty()) return false;
+    if (id == preparedReviewId) {
+        bool found = reviewFound;
+        if (found) out = std::move(reviewPuzzle);
+        preparedReviewId.clear();
+        if (id == reviewId) reviewId.clear();
+        if (found) lastHanded = out;
+        return found;
+    }
+    if (id == lastHanded.puzzle.id) {
+        out = lastHanded;
+        return true;
+    }
+
+    if (!source) return false;
+    size_t row = source->findId(id);
+    if (row == PuzzleSource::NOT_FOUND || !prepare(*source, row, out)) return false;
+    lastHanded = out;
+    return true;
+}
+
+bool PuzzlePrefetcher::pick(size_t& row, size_t& position) {
+    position = PuzzleSampler::NOT_FOUND;
+    if (!filterRows.empty()) {
+        if (filterNext == filterRows.size()) {
+            // Every match has been served; start the next round
+            std::shuffle(filterRows.begin(), filterRows.end(), rng);
+            filterNext = 0;
+        }
+        row = filterRows[filterNext++];
+        return true;
+    }
+    row = sampler.pick(rating, RATING_WINDOW, rng);
+    if (row == PuzzleSampler::NOT_FOUND) return false;
+    position = sampler.getLastPosition();
+    return true;
+}
+
+void PuzzlePrefetcher::release(size_t position) {
+    if (position != PuzzleSampler::NOT_FOUND) sampler.release(position);
+}
+
+void PuzzlePrefetcher::clearDraws() {
+    for (const Draw& draw : draws) release(draw.position);
+    draws.clear();
+}
+
+void PuzzlePrefetcher::dropStale() {
+    // A filter sets its own rating range, so only sampler draws go stale
+    if (!filterRows.empty()) return;
+    for (std::deque<Draw>::iterator it = draws.begin(); it != draws.end();) {
+        // Dropped draws were never served, so the sampler may hand them out again
+        if (std::abs(it->rating - rating) > RATING_SLACK) {
+            release(it->position);
+            it = draws.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool PuzzlePrefetcher::prepare(const PuzzleSource& from, size_t row, PreparedPuzzle& out) {
+    if (!from.load(row, out.puzzle) || !out.position.setFEN(out.puzzle.fen)) return false;
+    // The opening move is the opponent's, played on the board before the player's turn
+    return out.puzzle.moves.empty() || out.position.parseUCIMove(out.puzzle.moves[0]) != MOVE_NONE;
+}
+
+void PuzzlePrefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        bool wantReview = source && depth > 0 && !reviewId.empty() && reviewId != preparedReviewId;
+        bool wantDraw = source && draws.size() < depth && failures < MAX_FAILURES;
+        if (!wantReview && !wantDraw) {
+            wake.wait(lock);
+            continue;
+        }
+
+        // Choose under the lock, read and set up outside it
+        const PuzzleSource* from = source;
+        uint64_t startGeneration = generation;
+        uint64_t startSession = session;
+        std::string id = reviewId;
+        int drawnFor = rating;
+        size_t row = PuzzleSource::NOT_FOUND;
+        size_t position = PuzzleSampler::NOT_FOUND;
+        if (!wantReview && !pick(row, position)) {
+            failures = MAX_FAILURES;
+            continue;
+        }
+
+        reading = true;
+        lock.unlock();
+        PreparedPuzzle prepared;
+        if (wantReview) row = from->findId(id);
+        bool ok = row != PuzzleSource::NOT_FOUND && prepare(*from, row, prepared);
+        lock.lock();
+        reading = false;
+        idle.notify_all();
+
+        if (generation != startGeneration) {
+            if (session == startSession && ok) release(position);
+            continue;
+        }
+        if (wantReview) {
+            if (id != reviewId) continue;
+            preparedReviewId = id;
+            reviewFound = ok;
+            if (ok) reviewPuzzle = std::move(prepared);
+        } else if (ok) {
+            failures = 0;
+            Draw draw;
+            draw.prepared = std::move(prepared);
+            draw.rating = drawnFor;
+            draw.position = position;
+            draws.push_back(std::move(draw));
+        } else {
+            failures++;
+        }
+    }
+}
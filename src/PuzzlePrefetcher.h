@@ -0,0 +1,102 @@
+#ifndef PUZZLE_PREFETCHER_H
+#define PUZZLE_PREFETCHER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Position.h"
+#include "PuzzleSampler.h"
+#include "PuzzleSource.h"
+
+// A puzzle read from its source and set up: the fields, and the position its
+// FEN describes with the opening move checked to be legal there
+struct PreparedPuzzle {
+    Puzzle puzzle;
+    Position position;
+};
+
+// Keeps the next few puzzles, and the next one of the review queue, read and
+// set up by a worker thread while the current puzzle is being solved, so
+// handing one out does no file access or parsing on the caller's thread.
+// Puzzles are drawn the way Game draws them: from the filter's matches when
+// a filter is set, in a shuffled order so none repeats before all have been
+// served, otherwise from a PuzzleSampler around the player's rating.
+// Whatever is not prepared in time is drawn and read by the caller.
+//
+// All methods are for one caller thread (the UI); only the worker runs
+// alongside it.
+class PuzzlePrefetcher {
+public:
+    // Prepared draws more than this far from the current rating are dropped
+    static const int RATING_SLACK = 50;
+
+    explicit PuzzlePrefetcher(size_t depth = 2);
+    ~PuzzlePrefetcher();
+
+    // Draws from `source` from now on, or nothing if null; drops everything
+    // prepared and waits out a read in progress, so the previous source may
+    // be closed once this returns
+    void reset(const PuzzleSource* source);
+
+    // Draws kept ready; 0 prepares nothing ahead
+    void setDepth(size_t depth);
+    size_t getDepth() const;
+
+    void setRating(int rating);
+    void setFilter(const std::vector<uint32_t>& rows);     // empty: no filter
+    void setReview(const std::string& id);                  // the review puzzle to have ready; "" for none
+
+    // The next drawn puzzle. False only if the source has none that set up.
+    bool next(PreparedPuzzle& out);
+    // The puzzle `id`, for the review queue. False if the source lacks it.
+    bool review(const std::string& id, PreparedPuzzle& out);
+
+    size_t ready() const;   // draws prepared and waiting
+
+private:
+    struct Draw {
+        PreparedPuzzle prepared;
+        int rating;             // the rating it was drawn for
+        size_t position;        // the sampler's position for it, NOT_FOUND for a filter draw
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;       // work to do, or stopping
+    std::condition_variable idle;       // the worker finished a read
+    std::thread worker;
+    bool stopping;
+    bool reading;                       // the worker is reading outside the lock
+    uint64_t generation;                // bumped whenever prepared draws go stale
+    uint64_t session;                   // bumped when the sampler restarts; older positions mean nothing
+
+    const PuzzleSource* source;
+    size_t depth;
+    int rating;
+    PuzzleSampler sampler;
+    std::vector<uint32_t> filterRows;   // shuffled; drawn in order from filterNext
+    size_t filterNext;
+    std::mt19937 rng;
+    int failures;                       // draws in a row that did not set up
+
+    std::deque<Draw> draws;
+    std::string reviewId;               // wanted
+    std::string preparedReviewId;       // what reviewPuzzle holds, "" if nothing
+    bool reviewFound;
+    PreparedPuzzle reviewPuzzle;
+    PreparedPuzzle lastHanded;          // a missed puzzle goes straight to the review queue
+
+    void run();
+    bool pick(size_t& row, size_t& position);  // with the lock held
+    void release(size_t position);     // with the lock held; puts back an unserved sampler draw
+    void clearDraws();                  // with the lock held; releases what they drew
+    void dropStale();                   // with the lock held
+    static bool prepare(const PuzzleSource& from, size_t row, PreparedPuzzle& out);
+};
+
+#endif // PUZZLE_PREFETCHER_H
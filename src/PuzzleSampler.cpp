@@ -0,0 +1,110 @@
+#include "PuzzleSampler.h"
+#include "Bitboard.h"
+#include <algorithm>
+
+namespace {
+
+// Random positions tried in a band before it counts as used up
+const int PROBES = 8;
+// Fewer candidates than this and the band is widened straight away
+const size_t MIN_BAND = 16;
+// Past this half-width a band covers any real rating range
+const int MAX_WINDOW = 4096;
+
+} // namespace
+
+PuzzleSampler::PuzzleSampler() : minRating(0), seenTotal(0), lastWindow(0), lastPosition(NOT_FOUND) {
+    order.rows = nullptr;
+    order.ratings = nullptr;
+    order.count = 0;
+}
+
+void PuzzleSampler::reset(const RatingOrder& newOrder) {
+    order = newOrder;
+    ratingStart.clear();
+    seen.assign((order.count + 63) / 64, 0);
+    seenTotal = 0;
+    lastWindow = 0;
+    lastPosition = NOT_FOUND;
+    if (order.count == 0) return;
+
+    // One entry per rating from the lowest to one past the highest
+    minRating = order.ratings[0];
+    int maxRating = order.ratings[order.count - 1];
+    ratingStart.resize(static_cast<size_t>(maxRating - minRating) + 2);
+    size_t position = 0;
+    for (size_t r = 0; r < ratingStart.size(); ++r) {
+        while (position < order.count && order.ratings[position] < minRating + static_cast<int>(r)) position++;
+        ratingStart[r] = static_cast<uint32_t>(position);
+    }
+}
+
+size_t PuzzleSampler::positionOf(int rating) const {
+    if (rating <= minRating) return 0;
+    size_t r = static_cast<size_t>(rating - minRating);
+    return r < ratingStart.size() ? ratingStart[r] : order.count;
+}
+
+size_t PuzzleSampler::claim(size_t position) {
+    seen[position / 64] |= 1ULL << (position % 64);
+    seenTotal++;
+    lastPosition = position;
+    return order.rows[position];
+}
+
+void PuzzleSampler::release(size_t position) {
+    // A round that restarted since the pick has already cleared it
+    if (position >= order.count || !isSeen(position)) return;
+    seen[position / 64] &= ~(1ULL << (position % 64));
+    seenTotal--;
+}
+
+size_t PuzzleSampler::firstUnseen(size_t first, size_t last, size_t from) const {
+    // Word at a time from `from` to the end of the band, then from its start
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t begin = pass == 0 ? from : first;
+        size_t end = pass == 0 ? last : from;
+        for (size_t position = begin; position < end;) {
+            uint64_t free = ~seen[position / 64] & (~0ULL << (position % 64));
+            if (free) {
+                size_t found = (position & ~static_cast<size_t>(63)) + lsb(free);
+                if (found < end) return found;
+                break;
+            }
+            position = (position | 63) + 1;
+        }
+    }
+    return NOT_FOUND;
+}
+
+size_t PuzzleSampler::pick(int rating, int window, std::mt19937& rng) {
+    if (order.count == 0) return NOT_FOUND;
+    if (seenTotal == order.count) {
+        // Everything has been served once; start the next round
+        std::fill(seen.begin(), seen.end(), 0);
+        seenTotal = 0;
+    }
+
+    for (window = std::max(window, 1);; window *= 2) {
+        size_t first = positionOf(rating - window);
+        size_t last = positionOf(rating + window + 1);
+        bool widest = window >= MAX_WINDOW || (first == 0 && last == order.count);
+        if (last - first >= MIN_BAND || (widest && first < last)) {
+            std::uniform_int_distribution<size_t> pickPosition(first, last - 1);
+            for (int probe = 0; probe < PROBES; ++probe) {
+                size_t position = pickPosition(rng);
+                if (!isSeen(position)) {
+                    lastWindow = window;
+                    return claim(position);
+                }
+            }
+        }
+        if (widest) break;
+    }
+
+    // Nearly every puzzle has been seen: the next unseen one at or above the
+    // rating, so the word scan only happens once the collection runs out
+    lastWindow = MAX_WINDOW;
+    size_t position = firstUnseen(0, order.count, std::min(positionOf(rating), order.count - 1));
+    return position == NOT_FOUND ? NOT_FOUND : claim(position);
+}
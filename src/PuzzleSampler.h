@@ -0,0 +1,52 @@
+#ifndef PUZZLE_SAMPLER_H
+#define PUZZLE_SAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "PuzzleSource.h"
+
+// Draws puzzles near a rating, evenly from the rows of a source's rating
+// order. A table of where every rating starts in that order turns a band
+// [rating - window, rating + window] into a range of positions without a
+// search; a pick tries a few random positions in the band and doubles the
+// window when the band is thin or already used up. Positions handed out are
+// kept in a bitset, so a puzzle does not come back until every other one has;
+// a pick that was never served can be released back into the draw.
+class PuzzleSampler {
+public:
+    static const size_t NOT_FOUND = PuzzleSource::NOT_FOUND;
+
+    PuzzleSampler();
+
+    // Starts a new session over `order`, which must outlive the sampler's use
+    void reset(const RatingOrder& order);
+
+    // A row rated about `rating`, preferring the narrowest band that has
+    // unseen puzzles. NOT_FOUND only if the source is empty.
+    size_t pick(int rating, int window, std::mt19937& rng);
+    // Makes the puzzle at `position` (see getLastPosition) drawable again
+    void release(size_t position);
+
+    size_t size() const { return order.count; }
+    size_t seenCount() const { return seenTotal; }
+    int getLastWindow() const { return lastWindow; }   // half-width the last pick came from
+    size_t getLastPosition() const { return lastPosition; } // rating-order position of the last pick
+
+private:
+    RatingOrder order;
+    int minRating;
+    std::vector<uint32_t> ratingStart;  // ratingStart[r - minRating] = first position rated >= r
+    std::vector<uint64_t> seen;         // by position in the rating order
+    size_t seenTotal;
+    int lastWindow;
+    size_t lastPosition;
+
+    size_t positionOf(int rating) const;
+    bool isSeen(size_t position) const { return (seen[position / 64] >> (position % 64)) & 1; }
+    size_t claim(size_t position);
+    size_t firstUnseen(size_t first, size_t last, size_t from) const;
+};
+
+#endif // PUZZLE_SAMPLER_H
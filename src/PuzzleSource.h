@@ -0,0 +1,67 @@
+#ifndef PUZZLE_SOURCE_H
+#define PUZZLE_SOURCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One puzzle, decoded and ready to set up on the board
+struct Puzzle {
+    std::string id;
+    std::string fen;
+    std::vector<std::string> moves;     // UCI; the first is the opponent's move
+    int rating = 0;
+    int ratingDeviation = 0;
+    int popularity = 0;
+    int nbPlays = 0;
+    std::string themes;                 // space separated, as Lichess writes them
+    std::string gameUrl;
+    std::string openingTags;
+};
+
+// Rows ordered by rating, over arrays the source owns. Rows rated lo..hi are
+// positions [lowerBound(lo), upperBound(hi)).
+struct RatingOrder {
+    const uint32_t* rows;
+    const int16_t* ratings;
+    size_t count;
+
+    size_t lowerBound(int rating) const { return std::lower_bound(ratings, ratings + count, rating) - ratings; }
+    size_t upperBound(int rating) const { return std::upper_bound(ratings, ratings + count, rating) - ratings; }
+};
+
+// Hash of a PuzzleId, for the id tables of the index and the pack (FNV-1a)
+inline uint64_t hashPuzzleId(const char* id, size_t length) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(id[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// A puzzle collection the game can draw from: the Lichess CSV (PuzzleStore)
+// or its binary conversion (PuzzlePack). Rows are numbered from 0.
+class PuzzleSource {
+public:
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    virtual ~PuzzleSource() {}
+
+    virtual bool open(const std::string& path) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual const std::string& getPath() const = 0;
+
+    virtual size_t size() const = 0;
+    virtual bool load(size_t row, Puzzle& out) const = 0;
+    // Fills at least id, rating, themes and openingTags; sources override it
+    // to skip the board and moves when only those are wanted
+    virtual bool loadTags(size_t row, Puzzle& out) const { return load(row, out); }
+    virtual size_t findId(const std::string& id) const = 0;    // NOT_FOUND if absent
+    virtual RatingOrder ratingOrder() const = 0;
+};
+
+#endif // PUZZLE_SOURCE_H
@@ -0,0 +1,114 @@
+#include "PuzzleStore.h"
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+// Header names as Lichess writes them, by PuzzleColumn
+const char* const COLUMN_NAMES[PUZZLE_COLUMN_COUNT] = {
+    "puzzleid", "fen", "moves", "rating", "ratingdeviation",
+    "popularity", "nbplays", "themes", "gameurl", "openingtags"
+};
+
+// Shared by every store; the kernel is picked once for this CPU
+const CsvScanner scanner;
+
+} // namespace
+
+PuzzleStore::PuzzleStore() {
+    for (int c = 0; c < PUZZLE_COLUMN_COUNT; ++c) columns[c] = -1;
+}
+
+bool PuzzleStore::open(const std::string& csvPath) {
+    close();
+    if (!file.open(csvPath) || !index.open(csvPath, file.data(), file.size())) {
+        close();
+        return false;
+    }
+
+    const char* data = file.data();
+    const char* newline = static_cast<const char*>(std::memchr(data, '\n', file.size()));
+    size_t length = newline ? static_cast<size_t>(newline - data) : file.size();
+    if (length > 0 && data[length - 1] == '\r') length--;
+    PuzzleRow header;
+    split(data, length, header);
+    for (int i = 0; i < header.count; ++i) {
+        std::string name = header.fields[i].str();
+        headers.push_back(name);
+        for (auto& c : name) c = (char)tolower((unsigned char)c);
+        for (int c = 0; c < PUZZLE_COLUMN_COUNT; ++c) {
+            if (name == COLUMN_NAMES[c]) columns[c] = i;
+        }
+    }
+    return true;
+}
+
+void PuzzleStore::close() {
+    index.clear();
+    file.close();
+    headers.clear();
+    for (int c = 0; c < PUZZLE_COLUMN_COUNT; ++c) columns[c] = -1;
+}
+
+bool PuzzleStore::row(size_t i, PuzzleRow& out) const {
+    out.count = 0;
+    if (i >= index.size()) return false;
+    const char* line = file.data() + index.rowOffset(i);
+    size_t length = static_cast<size_t>(index.rowEnd(i) - index.rowOffset(i));
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) length--;
+    split(line, length, out);
+    return true;
+}
+
+CsvField PuzzleStore::field(const PuzzleRow& row, PuzzleColumn c) const {
+    int i = columns[c];
+    if (i < 0 || i >= row.count) {
+        CsvField empty = { "", 0 };
+        return empty;
+    }
+    return row.fields[i];
+}
+
+size_t PuzzleStore::findId(const std::string& id) const {
+    size_t i = index.findId(id);
+    PuzzleRow r;
+    if (i == PuzzleIndex::NOT_FOUND || !row(i, r) || !field(r, PUZZLE_ID).equals(id)) return NOT_FOUND;
+    return i;
+}
+
+bool PuzzleStore::load(size_t i, Puzzle& out) const {
+    PuzzleRow r;
+    if (!row(i, r)) return false;
+    out.id = field(r, PUZZLE_ID).str();
+    out.fen = field(r, PUZZLE_FEN).str();
+    out.moves.clear();
+    CsvField moves = field(r, PUZZLE_MOVES);
+    size_t start = 0;
+    for (size_t k = 0; k <= moves.length; ++k) {
+        if (k < moves.length && moves.data[k] != ' ') continue;
+        if (k > start) out.moves.push_back(std::string(moves.data + start, k - start));
+        start = k + 1;
+    }
+    out.rating = std::atoi(field(r, PUZZLE_RATING).str().c_str());
+    out.ratingDeviation = std::atoi(field(r, PUZZLE_RATING_DEVIATION).str().c_str());
+    out.popularity = std::atoi(field(r, PUZZLE_POPULARITY).str().c_str());
+    out.nbPlays = std::atoi(field(r, PUZZLE_NB_PLAYS).str().c_str());
+    out.themes = field(r, PUZZLE_THEMES).str();
+    out.gameUrl = field(r, PUZZLE_GAME_URL).str();
+    out.openingTags = field(r, PUZZLE_OPENING_TAGS).str();
+    return !out.fen.empty();
+}
+
+bool PuzzleStore::loadTags(size_t i, Puzzle& out) const {
+    PuzzleRow r;
+    if (!row(i, r)) return false;
+    out.id = field(r, PUZZLE_ID).str();
+    out.rating = std::atoi(field(r, PUZZLE_RATING).str().c_str());
+    out.themes = field(r, PUZZLE_THEMES).str();
+    out.openingTags = field(r, PUZZLE_OPENING_TAGS).str();
+    return true;
+}
+
+void PuzzleStore::split(const char* line, size_t length, PuzzleRow& out) {
+    out.count = static_cast<int>(scanner.split(line, length, out.fields, PuzzleRow::MAX_FIELDS));
+}
@@ -0,0 +1,73 @@
+#ifndef PUZZLE_STORE_H
+#define PUZZLE_STORE_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "CsvScanner.h"
+#include "MappedFile.h"
+#include "PuzzleIndex.h"
+#include "PuzzleSource.h"
+
+// Columns of the Lichess puzzle CSV, found by header name in any order
+enum PuzzleColumn {
+    PUZZLE_ID,
+    PUZZLE_FEN,
+    PUZZLE_MOVES,
+    PUZZLE_RATING,
+    PUZZLE_RATING_DEVIATION,
+    PUZZLE_POPULARITY,
+    PUZZLE_NB_PLAYS,
+    PUZZLE_THEMES,
+    PUZZLE_GAME_URL,
+    PUZZLE_OPENING_TAGS,
+    PUZZLE_COLUMN_COUNT
+};
+
+// One row split into fields, without copying or allocating
+struct PuzzleRow {
+    static const int MAX_FIELDS = 16;   // later fields are ignored
+
+    CsvField fields[MAX_FIELDS];
+    int count;
+};
+
+// Read-only access to a puzzle CSV: the file is mapped once, the header is
+// parsed once into a column map, and rows come back as slices of the mapping.
+// The PuzzleIndex sidecar provides row offsets, ids and the rating order.
+class PuzzleStore : public PuzzleSource {
+public:
+    PuzzleStore();
+
+    bool open(const std::string& csvPath) override;
+    void close() override;
+    bool isOpen() const override { return file.isOpen(); }
+    const std::string& getPath() const override { return index.getCsvPath(); }
+
+    size_t size() const override { return index.size(); }
+    bool load(size_t row, Puzzle& out) const override;
+    bool loadTags(size_t row, Puzzle& out) const override;
+    // Row of the puzzle with this id, checked against the row itself
+    size_t findId(const std::string& id) const override;
+    RatingOrder ratingOrder() const override { return index.ratingOrder(); }
+
+    const std::vector<std::string>& getHeaders() const { return headers; }
+
+    // Field index of a column, -1 if the file lacks it
+    int column(PuzzleColumn c) const { return columns[c]; }
+
+    bool row(size_t index, PuzzleRow& out) const;
+    // The column's field of a split row; empty if the file or row lacks it
+    CsvField field(const PuzzleRow& row, PuzzleColumn c) const;
+
+private:
+    MappedFile file;
+    PuzzleIndex index;
+    std::vector<std::string> headers;
+    int columns[PUZZLE_COLUMN_COUNT];
+
+    static void split(const char* line, size_t length, PuzzleRow& out);
+};
+
+#endif // PUZZLE_STORE_H
@@ -0,0 +1,283 @@
+#include "PuzzleTagIndex.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char TAGS_MAGIC[8] = { 'P', 'Z', 'L', 'T', 'A', 'G', 0, 0 };
+const uint32_t TAGS_VERSION = 1;
+
+struct TagsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tagCount;
+    uint64_t sourceSize;        // the source the tags were built from
+    int64_t sourceTime;
+    uint64_t rows;
+};
+
+std::string lowercase(const std::string& text) {
+    std::string out(text);
+    for (auto& c : out) c = (char)tolower((unsigned char)c);
+    return out;
+}
+
+bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '+' || c == ',';
+}
+
+// "1600-1800" -> 1600, 1800
+bool parseRange(const std::string& token, int& lo, int& hi) {
+    size_t dash = token.find('-');
+    if (dash == 0 || dash == std::string::npos || dash + 1 == token.size()) return false;
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (i != dash && !isdigit((unsigned char)token[i])) return false;
+    }
+    lo = std::atoi(token.substr(0, dash).c_str());
+    hi = std::atoi(token.substr(dash + 1).c_str());
+    if (lo > hi) std::swap(lo, hi);
+    return true;
+}
+
+} // namespace
+
+bool PuzzleFilter::parse(const std::string& text, PuzzleFilter& out) {
+    out = PuzzleFilter();
+    // En and em dashes read as '-', and spaces around a dash are dropped so
+    // "1600 – 1800" is one token
+    std::string normal;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text.compare(i, 3, "\xE2\x80\x93") == 0 || text.compare(i, 3, "\xE2\x80\x94") == 0) {
+            normal += '-';
+            i += 2;
+        } else {
+            normal += text[i];
+        }
+    }
+    std::string compact;
+    for (size_t i = 0; i < normal.size(); ++i) {
+        if (normal[i] == ' ' && ((i + 1 < normal.size() && normal[i + 1] == '-') || (!compact.empty() && compact.back() == '-'))) {
+            continue;
+        }
+        compact += normal[i];
+    }
+
+    size_t start = 0;
+    for (size_t i = 0; i <= compact.size(); ++i) {
+        if (i < compact.size() && !isSeparator(compact[i])) continue;
+        if (i > start) {
+            std::string token = compact.substr(start, i - start);
+            int lo = 0;
+            int hi = 0;
+            if (parseRange(token, lo, hi)) {
+                out.minRating = lo;
+                out.maxRating = hi;
+            } else if (std::find(out.tags.begin(), out.tags.end(), token) == out.tags.end()) {
+                out.tags.push_back(token);
+            }
+        }
+        start = i + 1;
+    }
+    return !out.empty();
+}
+
+std::string PuzzleFilter::describe() const {
+    std::string text;
+    for (size_t i = 0; i < tags.size(); ++i) {
+        if (i) text += " + ";
+        text += tags[i];
+    }
+    if (hasRatingRange()) {
+        if (!text.empty()) text += ", ";
+        text += std::to_string(minRating) + "-" + std::to_string(maxRating);
+    }
+    return text;
+}
+
+bool PuzzleTagIndex::open(const PuzzleSource& source) {
+    clear();
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!source.isOpen() || !MappedFile::stamp(source.getPath(), sourceSize, sourceTime)) return false;
+    sourcePath = source.getPath();
+
+    std::string tagsPath = sourcePath + ".tags";
+    if (load(tagsPath, sourceSize, sourceTime) && size() == source.size()) return true;
+
+    clear();
+    sourcePath = source.getPath();
+    std::cout << "Indexing puzzle themes in " << sourcePath << "..." << std::endl;
+    if (!build(source)) {
+        clear();
+        return false;
+    }
+    // Like the row index, an unwritable folder only costs a rebuild next session
+    if (!save(tagsPath, sourceSize, sourceTime)) std::cout << "Could not write " << tagsPath << std::endl;
+    std::cout << "Indexed " << tagCount() << " themes and opening tags" << std::endl;
+    return true;
+}
+
+void PuzzleTagIndex::clear() {
+    sourcePath.clear();
+    rowRatings.clear();
+    names.clear();
+    sets.clear();
+    byName.clear();
+}
+
+const RowSet* PuzzleTagIndex::find(const std::string& tag) const {
+    std::unordered_map<std::string, size_t>::const_iterator it = byName.find(lowercase(tag));
+    return it == byName.end() ? nullptr : &sets[it->second];
+}
+
+size_t PuzzleTagIndex::addName(const std::string& name) {
+    std::string key = lowercase(name);
+    std::unordered_map<std::string, size_t>::iterator it = byName.find(key);
+    if (it != byName.end()) return it->second;
+    names.push_back(name);
+    sets.push_back(RowSet());
+    byName[key] = sets.size() - 1;
+    return sets.size() - 1;
+}
+
+std::vector<uint32_t> PuzzleTagIndex::match(const PuzzleFilter& filter, std::string* unknownTag) const {
+    std::vector<uint32_t> rows;
+    std::vector<const RowSet*> wanted;
+    for (const std::string& tag : filter.tags) {
+        const RowSet* set = find(tag);
+        if (!set) {
+            if (unknownTag) *unknownTag = tag;
+            return rows;
+        }
+        wanted.push_back(set);
+    }
+
+    bool anyRating = !filter.hasRatingRange();
+    int lo = filter.minRating;
+    int hi = filter.maxRating;
+    auto keep = [&](uint32_t row) {
+        int rating = rowRatings[row];
+        if (anyRating || (rating >= lo && rating <= hi)) rows.push_back(row);
+    };
+
+    if (wanted.empty()) {
+        for (size_t row = 0; row < rowRatings.size(); ++row) keep(static_cast<uint32_t>(row));
+        return rows;
+    }
+    // Smallest first, so every intersection is at most as large as the rarest tag
+    std::sort(wanted.begin(), wanted.end(), [](const RowSet* a, const RowSet* b) { return a->size() < b->size(); });
+    if (wanted.size() == 1) {
+        wanted[0]->forEach(keep);
+        return rows;
+    }
+    RowSet common = RowSet::intersect(*wanted[0], *wanted[1]);
+    for (size_t i = 2; i < wanted.size() && !common.empty(); ++i) common = RowSet::intersect(common, *wanted[i]);
+    common.forEach(keep);
+    return rows;
+}
+
+bool PuzzleTagIndex::build(const PuzzleSource& source) {
+    Puzzle p;
+    rowRatings.reserve(source.size());
+    std::string word;
+    for (size_t row = 0; row < source.size(); ++row) {
+        if (!source.loadTags(row, p)) {
+            p.rating = 0;
+            p.themes.clear();
+            p.openingTags.clear();
+        }
+        rowRatings.push_back(static_cast<int16_t>(std::max(-32768, std::min(32767, p.rating))));
+        const std::string* lists[2] = { &p.themes, &p.openingTags };
+        for (const std::string* list : lists) {
+            size_t start = 0;
+            for (size_t i = 0; i <= list->size(); ++i) {
+                if (i < list->size() && (*list)[i] != ' ') continue;
+                if (i > start) {
+                    word.assign(*list, start, i - start);
+                    sets[addName(word)].add(static_cast<uint32_t>(row));
+                }
+                start = i + 1;
+            }
+        }
+    }
+    return true;
+}
+
+bool PuzzleTagIndex::load(const std::string& tagsPath, uint64_t sourceSize, int64_t sourceTime) {
+    std::ifstream in(tagsPath, std::ios::in | std::ios::binary);
+    if (!in.is_open()) return false;
+
+    TagsHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    if (std::memcmp(h.magic, TAGS_MAGIC, sizeof(TAGS_MAGIC)) != 0 || h.version != TAGS_VERSION
+        || h.sourceSize != sourceSize || h.sourceTime != sourceTime) {
+        return false;
+    }
+
+    // As with the row index, a damaged sidecar must not size anything: the
+    // counts are checked against the bytes left before each allocation
+    in.seekg(0, std::ios::end);
+    uint64_t remaining = static_cast<uint64_t>(in.tellg()) - sizeof(h);
+    in.seekg(sizeof(h), std::ios::beg);
+    // Each tag takes at least a name length, one name byte and a group count
+    const uint64_t minTagBytes = sizeof(uint32_t) + 1 + sizeof(uint32_t);
+    if (!in || h.rows > remaining / sizeof(int16_t) || h.rows > UINT32_MAX
+        || h.tagCount > (remaining - h.rows * sizeof(int16_t)) / minTagBytes) {
+        return false;
+    }
+
+    rowRatings.resize(h.rows);
+    if (!in.read(reinterpret_cast<char*>(rowRatings.data()), rowRatings.size() * sizeof(int16_t))) return false;
+    remaining -= h.rows * sizeof(int16_t);
+    std::string name;
+    for (uint32_t t = 0; t < h.tagCount; ++t) {
+        uint32_t nameLength = 0;
+        if (remaining < sizeof(nameLength)) return false;
+        in.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        remaining -= sizeof(nameLength);
+        if (!in || nameLength == 0 || nameLength > 1024 || nameLength > remaining) return false;
+        name.resize(nameLength);
+        if (!in.read(&name[0], nameLength)) return false;
+        remaining -= nameLength;
+        if (!sets[addName(name)].read(in, remaining, h.rows)) return false;
+    }
+    // Every byte accounted for, and no name listed twice
+    return remaining == 0 && sets.size() == h.tagCount;
+}
+
+bool PuzzleTagIndex::save(const std::string& tagsPath, uint64_t sourceSize, int64_t sourceTime) const {
+    std::string tempPath = tagsPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        TagsHeader h;
+        std::memcpy(h.magic, TAGS_MAGIC, sizeof(TAGS_MAGIC));
+        h.version = TAGS_VERSION;
+        h.tagCount = static_cast<uint32_t>(sets.size());
+        h.sourceSize = sourceSize;
+        h.sourceTime = sourceTime;
+        h.rows = rowRatings.size();
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(rowRatings.data()), rowRatings.size() * sizeof(int16_t));
+        for (size_t t = 0; t < sets.size(); ++t) {
+            uint32_t nameLength = static_cast<uint32_t>(names[t].size());
+            out.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+            out.write(names[t].data(), nameLength);
+            sets[t].write(out);
+        }
+        if (!out) {
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    std::remove(tagsPath.c_str());
+    return std::rename(tempPath.c_str(), tagsPath.c_str()) == 0;
+}
@@ -0,0 +1,60 @@
+#ifndef PUZZLE_TAG_INDEX_H
+#define PUZZLE_TAG_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PuzzleSource.h"
+#include "RowSet.h"
+
+// What to draw puzzles from, written like "fork + endgame, 1600-1800": theme
+// or opening-tag names a puzzle must all have, and optionally a rating range.
+// Names and the range may be separated by spaces, '+' or ','.
+struct PuzzleFilter {
+    std::vector<std::string> tags;
+    int minRating = 0;
+    int maxRating = 0;      // both 0: any rating
+
+    bool empty() const { return tags.empty() && minRating == 0 && maxRating == 0; }
+    bool hasRatingRange() const { return minRating != 0 || maxRating != 0; }
+
+    // False if `text` names nothing to filter by
+    static bool parse(const std::string& text, PuzzleFilter& out);
+    std::string describe() const;
+};
+
+// Inverted index over a puzzle source: for every theme and opening tag, the
+// set of rows carrying it as a RowSet, plus each row's rating. Kept next to
+// the source as "<path>.tags" and rebuilt when the source's size or
+// modification time changes. Tag names match case-insensitively.
+class PuzzleTagIndex {
+public:
+    bool open(const PuzzleSource& source);
+    void clear();
+
+    const std::string& getPath() const { return sourcePath; }
+    size_t size() const { return rowRatings.size(); }
+    size_t tagCount() const { return sets.size(); }
+    const RowSet* find(const std::string& tag) const;   // nullptr if no puzzle has it
+
+    // Rows with every tag of `filter` and a rating in its range, ascending.
+    // A tag no puzzle carries makes the result empty and is reported in
+    // `unknownTag` when given.
+    std::vector<uint32_t> match(const PuzzleFilter& filter, std::string* unknownTag = nullptr) const;
+
+private:
+    std::string sourcePath;
+    std::vector<int16_t> rowRatings;
+    std::vector<std::string> names;
+    std::vector<RowSet> sets;                           // parallel to names
+    std::unordered_map<std::string, size_t> byName;    // lowercase name -> index into sets
+
+    bool build(const PuzzleSource& source);
+    bool load(const std::string& tagsPath, uint64_t sourceSize, int64_t sourceTime);
+    bool save(const std::string& tagsPath, uint64_t sourceSize, int64_t sourceTime) const;
+    size_t addName(const std::string& name);
+};
+
+#endif // PUZZLE_TAG_INDEX_H
@@ -0,0 +1,178 @@
+#include "RowSet.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <utility>
+
+namespace {
+
+const size_t BITMAP_WORDS = 65536 / 64;
+
+} // namespace
+
+void RowSet::add(uint32_t row) {
+    uint16_t key = static_cast<uint16_t>(row >> 16);
+    uint16_t low = static_cast<uint16_t>(row & 0xFFFF);
+    if (groups.empty() || groups.back().key != key) {
+        Group g;
+        g.key = key;
+        g.cardinality = 0;
+        groups.push_back(g);
+    }
+    Group& g = groups.back();
+    if (g.bits.empty()) {
+        if (!g.array.empty() && g.array.back() == low) return;
+        g.array.push_back(low);
+        if (g.array.size() > ARRAY_LIMIT) toBitmap(g);
+    } else {
+        if ((g.bits[low / 64] >> (low % 64)) & 1) return;
+        g.bits[low / 64] |= 1ULL << (low % 64);
+    }
+    g.cardinality++;
+    count++;
+}
+
+bool RowSet::contains(uint32_t row) const {
+    uint16_t key = static_cast<uint16_t>(row >> 16);
+    uint16_t low = static_cast<uint16_t>(row & 0xFFFF);
+    std::vector<Group>::const_iterator g = std::lower_bound(groups.begin(), groups.end(), key,
+        [](const Group& group, uint16_t k) { return group.key < k; });
+    if (g == groups.end() || g->key != key) return false;
+    if (g->bits.empty()) return std::binary_search(g->array.begin(), g->array.end(), low);
+    return (g->bits[low / 64] >> (low % 64)) & 1;
+}
+
+void RowSet::toBitmap(Group& g) {
+    g.bits.assign(BITMAP_WORDS, 0);
+    for (uint16_t low : g.array) g.bits[low / 64] |= 1ULL << (low % 64);
+    std::vector<uint16_t>().swap(g.array);
+}
+
+bool RowSet::intersectGroups(const Group& a, const Group& b, Group& out) {
+    out.key = a.key;
+    out.array.clear();
+    out.bits.clear();
+    if (!a.bits.empty() && !b.bits.empty()) {
+        // Word AND. Members are listed as they turn up, which is cheaper than
+        // counting every word while the result is sparse enough to end up as
+        // an array; past ARRAY_LIMIT the words are kept and only counted.
+        const uint64_t* x = a.bits.data();
+        const uint64_t* y = b.bits.data();
+        uint32_t cardinality = 0;
+        size_t w = 0;
+        out.array.reserve(std::min(a.cardinality, b.cardinality) / 4);
+        for (; w < BITMAP_WORDS && out.array.size() <= ARRAY_LIMIT; ++w) {
+            for (uint64_t word = x[w] & y[w]; word; word &= word - 1) {
+                out.array.push_back(static_cast<uint16_t>(w * 64 + lsb(word)));
+            }
+        }
+        cardinality = static_cast<uint32_t>(out.array.size());
+        if (cardinality > ARRAY_LIMIT) {
+            out.bits.resize(BITMAP_WORDS);
+            for (size_t v = 0; v < BITMAP_WORDS; ++v) out.bits[v] = x[v] & y[v];
+            for (; w < BITMAP_WORDS; ++w) cardinality += popCount(out.bits[w]);
+            std::vector<uint16_t>().swap(out.array);
+        }
+        out.cardinality = cardinality;
+    } else if (a.bits.empty() && b.bits.empty()) {
+        // Merge two sorted arrays
+        out.array.resize(std::min(a.array.size(), b.array.size()));
+        std::vector<uint16_t>::iterator end = std::set_intersection(a.array.begin(), a.array.end(),
+                                                                    b.array.begin(), b.array.end(), out.array.begin());
+        out.array.erase(end, out.array.end());
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    } else {
+        // Probe the bitmap for each member of the array
+        const Group& sparse = a.bits.empty() ? a : b;
+        const Group& dense = a.bits.empty() ? b : a;
+        out.array.reserve(sparse.array.size());
+        for (uint16_t low : sparse.array) {
+            if ((dense.bits[low / 64] >> (low % 64)) & 1) out.array.push_back(low);
+        }
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    }
+    return out.cardinality > 0;
+}
+
+RowSet RowSet::intersect(const RowSet& a, const RowSet& b) {
+    RowSet out;
+    std::vector<Group>::const_iterator i = a.groups.begin();
+    std::vector<Group>::const_iterator j = b.groups.begin();
+    Group g;
+    while (i != a.groups.end() && j != b.groups.end()) {
+        if (i->key < j->key) {
+            ++i;
+        } else if (j->key < i->key) {
+            ++j;
+        } else {
+            if (intersectGroups(*i, *j, g)) {
+                out.count += g.cardinality;
+                out.groups.push_back(std::move(g));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+void RowSet::write(std::ostream& out) const {
+    uint32_t groupCount = static_cast<uint32_t>(groups.size());
+    out.write(reinterpret_cast<const char*>(&groupCount), sizeof(groupCount));
+    for (const Group& g : groups) {
+        out.write(reinterpret_cast<const char*>(&g.key), sizeof(g.key));
+        out.write(reinterpret_cast<const char*>(&g.cardinality), sizeof(g.cardinality));
+        // The cardinality tells the reader which form follows
+        if (g.bits.empty()) out.write(reinterpret_cast<const char*>(g.array.data()), g.array.size() * sizeof(uint16_t));
+        else out.write(reinterpret_cast<const char*>(g.bits.data()), g.bits.size() * sizeof(uint64_t));
+    }
+}
+
+bool RowSet::read(std::istream& in, uint64_t& remaining, uint64_t rowLimit) {
+    groups.clear();
+    count = 0;
+    uint32_t groupCount = 0;
+    const uint64_t groupHeader = sizeof(uint16_t) + sizeof(uint32_t);
+    if (remaining < sizeof(groupCount) || !in.read(reinterpret_cast<char*>(&groupCount), sizeof(groupCount))) return false;
+    remaining -= sizeof(groupCount);
+    // Every group holds at least one row, so its header and one member must fit
+    if (groupCount > 65536 || groupCount > remaining / (groupHeader + sizeof(uint16_t))) return false;
+    groups.resize(groupCount);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        Group& g = groups[i];
+        if (remaining < groupHeader) return false;
+        in.read(reinterpret_cast<char*>(&g.key), sizeof(g.key));
+        in.read(reinterpret_cast<char*>(&g.cardinality), sizeof(g.cardinality));
+        remaining -= groupHeader;
+        if (!in || g.cardinality == 0 || g.cardinality > 65536) return false;
+        if (i > 0 && g.key <= groups[i - 1].key) return false;
+
+        uint32_t highest = 0;
+        if (g.cardinality <= ARRAY_LIMIT) {
+            uint64_t bytes = g.cardinality * sizeof(uint16_t);
+            if (remaining < bytes) return false;
+            g.array.resize(g.cardinality);
+            if (!in.read(reinterpret_cast<char*>(g.array.data()), bytes)) return false;
+            remaining -= bytes;
+            for (size_t m = 1; m < g.array.size(); ++m) {
+                if (g.array[m] <= g.array[m - 1]) return false;
+            }
+            highest = g.array.back();
+        } else {
+            uint64_t bytes = BITMAP_WORDS * sizeof(uint64_t);
+            if (remaining < bytes) return false;
+            g.bits.resize(BITMAP_WORDS);
+            if (!in.read(reinterpret_cast<char*>(g.bits.data()), bytes)) return false;
+            remaining -= bytes;
+            uint32_t members = 0;
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                members += popCount(g.bits[w]);
+                if (g.bits[w]) highest = static_cast<uint32_t>(w * 64 + msb(g.bits[w]));
+            }
+            if (members != g.cardinality) return false;
+        }
+        if ((static_cast<uint64_t>(g.key) << 16 | highest) >= rowLimit) return false;
+        count += g.cardinality;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef ROW_SET_H
+#define ROW_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "Bitboard.h"
+
+// Compressed set of row numbers, laid out like a Roaring bitmap: rows are
+// grouped by their high 16 bits, and each group keeps its low halves as a
+// sorted array while it has at most ARRAY_LIMIT members and as a 65536-bit
+// bitmap once denser. Sparse tags cost two bytes a row, dense ones a bit,
+// and intersection works group by group with whichever of merge, probe or
+// word AND fits the two sides.
+class RowSet {
+public:
+    static const uint32_t ARRAY_LIMIT = 4096;
+
+    RowSet() : count(0) {}
+
+    // Rows must be added in increasing order; adding the last row again is a no-op
+    void add(uint32_t row);
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool contains(uint32_t row) const;
+
+    static RowSet intersect(const RowSet& a, const RowSet& b);
+
+    // Calls f(row) for every row, in increasing order
+    template <typename F>
+    void forEach(F f) const {
+        for (const Group& g : groups) {
+            uint32_t high = static_cast<uint32_t>(g.key) << 16;
+            if (g.bits.empty()) {
+                for (uint16_t low : g.array) f(high | low);
+                continue;
+            }
+            for (size_t w = 0; w < g.bits.size(); ++w) {
+                for (uint64_t word = g.bits[w]; word; word &= word - 1) {
+                    f(high | static_cast<uint32_t>(w * 64 + lsb(word)));
+                }
+            }
+        }
+    }
+
+    void write(std::ostream& out) const;
+    // Reads what write() wrote, taking at most `remaining` bytes (reduced by
+    // what was read). False if the data is not a well-formed set of rows
+    // below `rowLimit`, so a damaged file is rebuilt rather than trusted.
+    bool read(std::istream& in, uint64_t& remaining, uint64_t rowLimit);
+
+private:
+    struct Group {
+        uint16_t key;                   // high 16 bits of its rows
+        uint32_t cardinality;
+        std::vector<uint16_t> array;    // while cardinality <= ARRAY_LIMIT
+        std::vector<uint64_t> bits;     // 1024 words once denser
+    };
+
+    std::vector<Group> groups;          // by key
+    size_t count;
+
+    static void toBitmap(Group& g);
+    static bool intersectGroups(const Group& a, const Group& b, Group& out);
+};
+
+#endif // ROW_SET_H
@@ -0,0 +1,299 @@
+#include "Search.h"
+#include "Evaluate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Move ordering scores; captures are ranked by MVV-LVA inside their band
+const int ORDER_TT_MOVE = 1 << 30;
+const int ORDER_CAPTURE = 1 << 28;
+const int ORDER_KILLER_1 = 1 << 27;
+const int ORDER_KILLER_2 = ORDER_KILLER_1 - 1;
+const int HISTORY_MAX = 1 << 20;
+
+bool isTactical(const Position& pos, Move m) {
+    return moveFlag(m) == MOVE_EN_PASSANT || moveFlag(m) == MOVE_PROMOTION
+        || (moveFlag(m) != MOVE_CASTLING && !pos.isEmpty(moveTo(m)));
+}
+
+// Brings the highest scored remaining move to index i
+void pickNext(MoveList& moves, int scores[], int i) {
+    int best = i;
+    for (int j = i + 1; j < moves.count; ++j) {
+        if (scores[j] > scores[best]) best = j;
+    }
+    if (best != i) {
+        std::swap(moves.moves[i], moves.moves[best]);
+        std::swap(scores[i], scores[best]);
+    }
+}
+
+} // namespace
+
+SearchWorker::SearchWorker(const Position& root, TranspositionTable& table, const std::atomic<bool>& stopFlag, int workerId)
+    : pos(root), tt(table), stop(stopFlag), id(workerId), nodes(0), maxNodes(UINT64_MAX),
+      hasDeadline(false), limitReached(false), completedDepth(0) {
+    std::memset(killers, 0, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+    std::memset(pvLength, 0, sizeof(pvLength));
+
+    MoveList moves;
+    pos.generateLegalMoves(moves);
+    for (Move m : moves) {
+        RootMove rm;
+        rm.move = m;
+        rm.score = -SCORE_INFINITE;
+        rm.previousScore = -SCORE_INFINITE;
+        rm.pv.push_back(m);
+        rootMoves.push_back(rm);
+    }
+}
+
+void SearchWorker::restrictRootMoves(const std::vector<Move>& moves) {
+    std::vector<RootMove> kept;
+    for (const RootMove& rm : rootMoves) {
+        if (std::find(moves.begin(), moves.end(), rm.move) != moves.end()) kept.push_back(rm);
+    }
+    if (!kept.empty()) rootMoves.swap(kept);
+}
+
+void SearchWorker::iterate(int maxDepth, int multiPV, const std::function<void(int, size_t)>& onDepth) {
+    if (rootMoves.empty()) return;
+    size_t lines = static_cast<size_t>(multiPV < 1 ? 1 : multiPV);
+    if (lines > rootMoves.size()) lines = rootMoves.size();
+
+    // Helpers start one depth later on odd ids so threads spread over the tree
+    for (int depth = 1 + (id & 1); depth <= maxDepth; ++depth) {
+        for (RootMove& rm : rootMoves) {
+            rm.previousScore = rm.score;
+            rm.score = -SCORE_INFINITE;
+        }
+
+        for (size_t pvIndex = 0; pvIndex < lines; ++pvIndex) {
+            searchRoot(-SCORE_INFINITE, SCORE_INFINITE, depth, pvIndex);
+            if (stopped()) break;
+            // Best first; moves that failed low keep last iteration's order
+            std::stable_sort(rootMoves.begin() + pvIndex, rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+                return a.score > b.score;
+            });
+        }
+
+        // An interrupted iteration is incomplete and never reported
+        if (stopped()) break;
+        completedDepth = depth;
+        if (id == 0) onDepth(depth, lines);
+    }
+}
+
+int SearchWorker::searchRoot(int alpha, int beta, int depth, size_t pvIndex) {
+    pvLength[0] = 0;
+    bool first = true;
+    for (size_t i = pvIndex; i < rootMoves.size(); ++i) {
+        RootMove& rm = rootMoves[i];
+        pos.makeMove(rm.move);
+        nodes++;
+        int score;
+        if (first) {
+            score = -search(-beta, -alpha, depth - 1, 1);
+        } else {
+            score = -search(-alpha - 1, -alpha, depth - 1, 1);
+            if (score > alpha && score < beta) score = -search(-beta, -alpha, depth - 1, 1);
+        }
+        pos.unmakeMove();
+        if (stopped()) return alpha;
+
+        if (first || score > alpha) {
+            rm.score = score;
+            rm.pv.assign(1, rm.move);
+            for (int p = 1; p < pvLength[1]; ++p) rm.pv.push_back(pv[1][p]);
+            alpha = score;
+            first = false;
+        }
+    }
+    return alpha;
+}
+
+void SearchWorker::updatePV(int ply, Move move) {
+    pv[ply][ply] = move;
+    int childLength = pvLength[ply + 1];
+    for (int p = ply + 1; p < childLength; ++p) pv[ply][p] = pv[ply + 1][p];
+    pvLength[ply] = childLength > ply + 1 ? childLength : ply + 1;
+}
+
+void SearchWorker::orderMoves(MoveList& moves, int scores[], Move ttMove, int ply) const {
+    const int side = static_cast<int>(pos.getSideToMove());
+    for (int i = 0; i < moves.count; ++i) {
+        Move m = moves.moves[i];
+        if (m == ttMove) {
+            scores[i] = ORDER_TT_MOVE;
+        } else if (isTactical(pos, m)) {
+            PieceType victim = moveFlag(m) == MOVE_EN_PASSANT ? PieceType::PAWN : pos.typeAt(moveTo(m));
+            int victimValue = victim == PieceType::NONE ? 0 : PieceValue[static_cast<int>(victim)];
+            if (moveFlag(m) == MOVE_PROMOTION) victimValue += PieceValue[static_cast<int>(movePromotion(m))];
+            scores[i] = ORDER_CAPTURE + victimValue * 8 - static_cast<int>(pos.typeAt(moveFrom(m)));
+        } else if (m == killers[ply][0]) {
+            scores[i] = ORDER_KILLER_1;
+        } else if (m == killers[ply][1]) {
+            scores[i] = ORDER_KILLER_2;
+        } else {
+            scores[i] = history[side][moveFrom(m)][moveTo(m)];
+        }
+    }
+}
+
+bool SearchWorker::checkLimits() {
+    if (stopped()) return true;
+    if (completedDepth == 0) return false;
+    // The clock is read only every 1024 nodes
+    if (nodes >= maxNodes || (hasDeadline && (nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline)) {
+        limitReached = true;
+    }
+    return limitReached;
+}
+
+int SearchWorker::search(int alpha, int beta, int depth, int ply) {
+    pvLength[ply] = ply;
+    if (checkLimits()) return 0;
+
+    // Draws by rule; one earlier occurrence is enough inside the search
+    if (pos.getHalfmoveClock() >= 100 || pos.isRepetition(2)) return 0;
+    if (ply >= MAX_PLY - 1) return evaluate(pos);
+
+    // Mate distance pruning: no line from here beats a mate already found
+    alpha = std::max(alpha, -SCORE_MATE + ply);
+    beta = std::min(beta, SCORE_MATE - ply - 1);
+    if (alpha >= beta) return alpha;
+
+    const bool inCheck = pos.isKingInCheck(pos.getSideToMove());
+    if (inCheck) depth++;
+    if (depth <= 0) return quiesce(alpha, beta, ply);
+
+    const bool pvNode = beta - alpha > 1;
+    const uint64_t key = pos.getKey();
+    TTEntry entry;
+    Move ttMove = MOVE_NONE;
+    if (tt.probe(key, entry)) {
+        ttMove = entry.move;
+        int ttScore = scoreFromTT(entry.score, ply);
+        if (!pvNode && entry.depth >= depth) {
+            if (entry.bound == BOUND_EXACT
+                || (entry.bound == BOUND_LOWER && ttScore >= beta)
+                || (entry.bound == BOUND_UPPER && ttScore <= alpha)) {
+                return ttScore;
+            }
+        }
+    }
+
+    MoveList moves;
+    pos.generateLegalMoves(moves);
+    if (moves.empty()) return inCheck ? -SCORE_MATE + ply : 0;
+
+    int scores[MAX_MOVES];
+    orderMoves(moves, scores, ttMove, ply);
+
+    const int side = static_cast<int>(pos.getSideToMove());
+    const int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITE;
+    Move bestMove = MOVE_NONE;
+
+    for (int i = 0; i < moves.count; ++i) {
+        pickNext(moves, scores, i);
+        Move m = moves.moves[i];
+        bool quiet = !isTactical(pos, m);
+
+        pos.makeMove(m);
+        nodes++;
+        int score;
+        if (i == 0) {
+            score = -search(-beta, -alpha, depth - 1, ply + 1);
+        } else {
+            // Late quiet moves get a reduced null-window look first
+            int reduction = (quiet && !inCheck && depth >= 3 && i >= 3) ? 1 : 0;
+            score = -search(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+            if (score > alpha && (reduction || score < beta)) {
+                score = -search(-beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        pos.unmakeMove();
+        if (stopped()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = m;
+            if (score > alpha) {
+                alpha = score;
+                updatePV(ply, m);
+                if (alpha >= beta) {
+                    if (quiet) {
+                        if (killers[ply][0] != m) {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = m;
+                        }
+                        int& h = history[side][moveFrom(m)][moveTo(m)];
+                        h += depth * depth;
+                        if (h > HISTORY_MAX) {
+                            for (int f = 0; f < 64; ++f) {
+                                for (int t = 0; t < 64; ++t) history[side][f][t] /= 2;
+                            }
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+    tt.store(key, bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+int SearchWorker::quiesce(int alpha, int beta, int ply) {
+    pvLength[ply] = ply;
+    if (checkLimits()) return 0;
+    if (ply >= MAX_PLY - 1) return evaluate(pos);
+
+    const bool inCheck = pos.isKingInCheck(pos.getSideToMove());
+    int bestScore = -SCORE_INFINITE;
+    if (!inCheck) {
+        // Stand pat: the side to move can always decline to capture
+        bestScore = evaluate(pos);
+        if (bestScore >= beta) return bestScore;
+        if (bestScore > alpha) alpha = bestScore;
+    }
+
+    MoveList moves;
+    pos.generateLegalMoves(moves);
+    if (moves.empty()) return inCheck ? -SCORE_MATE + ply : bestScore;
+
+    // Only captures and promotions, unless every evasion has to be tried
+    if (!inCheck) {
+        int kept = 0;
+        for (int i = 0; i < moves.count; ++i) {
+            if (isTactical(pos, moves.moves[i])) moves.moves[kept++] = moves.moves[i];
+        }
+        moves.count = kept;
+    }
+
+    int scores[MAX_MOVES];
+    orderMoves(moves, scores, MOVE_NONE, ply);
+
+    for (int i = 0; i < moves.count; ++i) {
+        pickNext(moves, scores, i);
+        pos.makeMove(moves.moves[i]);
+        nodes++;
+        int score = -quiesce(-beta, -alpha, ply + 1);
+        pos.unmakeMove();
+        if (stopped()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+    return bestScore;
+}
@@ -0,0 +1,83 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Position.h"
+#include "TranspositionTable.h"
+
+const int MAX_PLY = 128;
+const int SCORE_INFINITE = 32001;
+const int SCORE_MATE = 32000;                       // mate at the root
+const int SCORE_MATE_BOUND = SCORE_MATE - MAX_PLY;  // anything beyond is a mate score
+
+// A root move with the score and principal variation of its last search
+struct RootMove {
+    Move move;
+    int score;
+    int previousScore;
+    std::vector<Move> pv;
+};
+
+// One search thread: iterative deepening alpha-beta (PVS) with quiescence,
+// TT cutoffs and move ordering by TT move, MVV-LVA, killers and history.
+// Several workers searching the same root and sharing one TT is Lazy SMP;
+// only the main worker's results are reported.
+class SearchWorker {
+private:
+    Position pos;
+    TranspositionTable& tt;
+    const std::atomic<bool>& stop;
+    int id;
+
+    uint64_t nodes;
+    uint64_t maxNodes;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+    bool limitReached;
+    Move killers[MAX_PLY][2];
+    int history[2][64][64];
+    Move pv[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+
+    int search(int alpha, int beta, int depth, int ply);
+    int quiesce(int alpha, int beta, int ply);
+    int searchRoot(int alpha, int beta, int depth, size_t pvIndex);
+    void orderMoves(MoveList& moves, int scores[], Move ttMove, int ply) const;
+    void updatePV(int ply, Move move);
+    bool stopped() const { return limitReached || stop.load(std::memory_order_relaxed); }
+    bool checkLimits();
+
+public:
+    std::vector<RootMove> rootMoves;
+    int completedDepth;
+
+    SearchWorker(const Position& root, TranspositionTable& table, const std::atomic<bool>& stopFlag, int workerId);
+
+    // Ends the search after maxNodes nodes of this worker or at the deadline,
+    // but never before depth 1 is complete, so there is always a move
+    void setNodeLimit(uint64_t limit) { maxNodes = limit; }
+    void setDeadline(std::chrono::steady_clock::time_point time) { deadline = time; hasDeadline = true; }
+    // Drops every root move not in `moves`; ignored if none of them is legal
+    void restrictRootMoves(const std::vector<Move>& moves);
+
+    // Searches depth 1..maxDepth (helpers start at staggered depths) until done
+    // or stopped. onDepth(depth, lines) runs on the main worker after each
+    // completed depth, with the best `lines` root moves sorted to the front.
+    void iterate(int maxDepth, int multiPV, const std::function<void(int, size_t)>& onDepth);
+
+    uint64_t getNodes() const { return nodes; }
+};
+
+// Score for a mate found at `ply` converted to/from the TT's root-relative form
+inline int scoreToTT(int score, int ply) {
+    return score >= SCORE_MATE_BOUND ? score + ply : score <= -SCORE_MATE_BOUND ? score - ply : score;
+}
+inline int scoreFromTT(int score, int ply) {
+    return score >= SCORE_MATE_BOUND ? score - ply : score <= -SCORE_MATE_BOUND ? score + ply : score;
+}
+
+#endif // SEARCH_H
@@ -0,0 +1,334 @@
+#include "SearchEngine.h"
+#include "Search.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+EngineLine toEngineLine(const RootMove& rm, int depth) {
+    EngineLine line;
+    line.move = moveToUCI(rm.move);
+    for (Move m : rm.pv) line.pv.push_back(moveToUCI(m));
+    line.depth = depth;
+    line.mate = 0;
+    line.score = rm.score;
+
+    // Same conventions as the UCI parser: mate in moves, score pinned to +-10000
+    if (rm.score >= SCORE_MATE_BOUND || rm.score <= -SCORE_MATE_BOUND) {
+        int plies = SCORE_MATE - std::abs(rm.score);
+        int moves = (plies + 1) / 2;
+        line.mate = rm.score > 0 ? moves : -moves;
+        line.score = rm.score > 0 ? 10000 : -10000;
+    }
+    return line;
+}
+
+// Share of the clock for one move: the remaining time spread over the moves
+// left (30 assumed in sudden death) plus most of the increment, always
+// leaving a reserve for the time it takes to play the move
+int allocateTimeMs(int timeMs, int incMs, int movesToGo) {
+    int moves = movesToGo > 0 ? std::min(movesToGo, 50) : 30;
+    int budget = timeMs / moves + incMs * 3 / 4;
+    int reserve = std::min(50, timeMs / 2);
+    return std::max(1, std::min(budget, timeMs - reserve));
+}
+
+} // namespace
+
+SearchEngine::SearchEngine()
+    : tt(16), multiPV(1), threadCount(1), skillLevel(20),
+      isRunning(false), isReady(false),
+      stopFlag(false), searching(false), stopRequested(false), nodesSearched(0), linesVersion(0),
+      pondering(false) {
+    rootPosition.setStartPosition();
+}
+
+SearchEngine::~SearchEngine() {
+    shutdown();
+}
+
+bool SearchEngine::initialize(const std::string& enginePath) {
+    (void)enginePath;
+    std::cout << "Initializing built-in engine (" << threadCount << " thread"
+              << (threadCount == 1 ? "" : "s") << ")" << std::endl;
+    isRunning = true;
+    isReady = true;
+    return true;
+}
+
+void SearchEngine::shutdown() {
+    if (isRunning) {
+        stopAnalysis();
+        isRunning = false;
+        isReady = false;
+        std::cout << "Built-in engine shut down" << std::endl;
+    }
+}
+
+bool SearchEngine::sendPosition(const std::string& fen) {
+    if (!isReady) return false;
+    stopAnalysis();
+    std::string command = "position fen " + fen;
+    log.recordSent(command.data(), command.size());
+    return rootPosition.setFEN(fen);
+}
+
+bool SearchEngine::sendPosition(const std::string& startFen, const std::vector<std::string>& uciMoves) {
+    if (!isReady) return false;
+    stopAnalysis();
+    std::string command = "position fen " + startFen;
+    if (!uciMoves.empty()) command += " moves";
+    for (const std::string& uci : uciMoves) command += " " + uci;
+    log.recordSent(command.data(), command.size());
+
+    // Played out rather than set, so the search sees the earlier positions
+    if (!rootPosition.setFEN(startFen)) return false;
+    for (const std::string& uci : uciMoves) {
+        Move m = rootPosition.parseUCIMove(uci);
+        if (m == MOVE_NONE) return false;
+        rootPosition.makeMove(m);
+    }
+    return true;
+}
+
+bool SearchEngine::startAnalysis(int depth, int multiPVCount) {
+    SearchLimits limits;
+    limits.depth = std::max(1, depth);
+    return startSearch(limits, multiPVCount);
+}
+
+bool SearchEngine::startSearch(const SearchLimits& requested, int multiPVCount, const SearchCallback& onDone) {
+    if (!isReady) return false;
+    stopAnalysis();
+    setMultiPV(multiPVCount);
+
+    // A ponder search runs unbounded; its limits apply once ponderHit() comes
+    SearchLimits limits = requested;
+    if (requested.ponder) {
+        ponderLimits = requested;
+        ponderLimits.ponder = false;
+        limits.infinite = true;
+    }
+
+    const bool bounded = !limits.infinite;
+    int maxDepth = bounded && limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    if (skillLevel < 20) maxDepth = std::min(maxDepth, skillLevel + 1);
+    const uint64_t maxNodes = bounded ? limits.nodes : 0;
+    const int movetimeMs = bounded ? moveTimeMs(limits) : 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(movetimeMs);
+
+    std::vector<Move> searchMoves;
+    for (const std::string& uci : limits.searchMoves) {
+        Move m = rootPosition.parseUCIMove(uci);
+        if (m != MOVE_NONE) searchMoves.push_back(m);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        lines.clear();
+        linesVersion++;
+        searchCallback = onDone;
+        pondering = requested.ponder;
+    }
+    ponderStart = std::chrono::steady_clock::now();
+    char command[96];
+    int length = std::snprintf(command, sizeof(command), "go%s depth %d movetime %d nodes %llu",
+                               requested.ponder ? " ponder" : "", maxDepth, movetimeMs,
+                               static_cast<unsigned long long>(maxNodes));
+    log.recordSent(command, static_cast<size_t>(std::max(0, length)));
+
+    tt.newSearch();
+    stopFlag = false;
+    stopRequested = false;
+    nodesSearched = 0;
+    searching = true;
+
+    // Every worker searches the same root; they cooperate only through the TT.
+    // Worker 0 reports lines and stops the helpers when it is done.
+    std::shared_ptr<std::atomic<int> > active = std::make_shared<std::atomic<int> >(threadCount);
+    const Position root = rootPosition;
+    const int lineCount = multiPV;
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, root, maxDepth, maxNodes, movetimeMs, deadline, searchMoves, lineCount, i, active]() {
+            SearchWorker worker(root, tt, stopFlag, i);
+            if (maxNodes > 0) worker.setNodeLimit(maxNodes);
+            if (movetimeMs > 0) worker.setDeadline(deadline);
+            if (!searchMoves.empty()) worker.restrictRootMoves(searchMoves);
+            worker.iterate(maxDepth, i == 0 ? lineCount : 1, [this, &worker](int completed, size_t count) {
+                std::vector<EngineLine> result;
+                for (size_t n = 0; n < count; ++n) result.push_back(toEngineLine(worker.rootMoves[n], completed));
+                char info[64];
+                int length = std::snprintf(info, sizeof(info), "info depth %d nodes %llu pv %s", completed,
+                                           static_cast<unsigned long long>(worker.getNodes()), result[0].move.c_str());
+                log.recordReceived(info, static_cast<size_t>(std::max(0, length)));
+                log.recordDepth(completed);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                lines.swap(result);
+                linesVersion++;
+            });
+            if (i == 0) stopFlag = true;
+            nodesSearched += worker.getNodes();
+            if (--(*active) == 0) {
+                // The callback runs before waiters are released, so anyone
+                // woken by waitForSearch also sees its effects. A ponder
+                // search holds its result for ponderHit() or stopAnalysis().
+                SearchCallback callback;
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (!pondering) callback.swap(searchCallback);
+                }
+                log.recordBestMove();
+                if (callback) callback(currentResult(stopRequested.load()));
+                std::lock_guard<std::mutex> lock(resultMutex);
+                searching = false;
+                searchDone.notify_all();
+            }
+        });
+    }
+    return true;
+}
+
+void SearchEngine::stopAnalysis() {
+    if (searching.load()) stopRequested = true;
+    stopFlag = true;
+    joinWorkers();
+
+    // A ponder search that is stopped still reports, like any other
+    SearchCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        pondering = false;
+        callback.swap(searchCallback);
+    }
+    if (callback) callback(currentResult(true));
+}
+
+void SearchEngine::ponderHit() {
+    SearchCallback callback;
+    bool running;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!pondering) return;
+        pondering = false;
+        running = searching.load();
+        callback.swap(searchCallback);
+    }
+    if (!callback) return; // the search reported as pondering ended
+
+    // The ponder search already ran out of depth: its move is ready now
+    if (!running) {
+        callback(currentResult(false));
+        return;
+    }
+
+    // Time spent pondering counts toward the move: once it covers the
+    // budget, the ponder search's own result is the answer
+    stopFlag = true;
+    joinWorkers();
+    SearchLimits limits = ponderLimits;
+    int budget = moveTimeMs(limits);
+    if (budget > 0) {
+        int pondered = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - ponderStart).count());
+        if (pondered >= budget) {
+            callback(currentResult(false));
+            return;
+        }
+        limits.movetimeMs = budget - pondered;
+        limits.whiteTimeMs = limits.blackTimeMs = 0;
+    }
+
+    // Otherwise workers cannot take new limits mid-search, so the search
+    // restarts under them; the transposition table makes the lost depths cheap
+    startSearch(limits, multiPV, callback);
+}
+
+int SearchEngine::moveTimeMs(const SearchLimits& limits) const {
+    int movetimeMs = limits.movetimeMs;
+
+    // A clock turns into a fixed time for this move
+    const bool whiteToMove = rootPosition.getSideToMove() == PieceColor::WHITE;
+    const int clockMs = whiteToMove ? limits.whiteTimeMs : limits.blackTimeMs;
+    if (clockMs > 0) {
+        int budget = allocateTimeMs(clockMs, whiteToMove ? limits.whiteIncMs : limits.blackIncMs, limits.movesToGo);
+        movetimeMs = movetimeMs > 0 ? std::min(movetimeMs, budget) : budget;
+    }
+    return movetimeMs;
+}
+
+SearchResult SearchEngine::currentResult(bool stopped) {
+    SearchResult result;
+    result.lines = getBestLines(-1);
+    if (!result.lines.empty()) {
+        result.bestMove = result.lines[0].move;
+        if (result.lines[0].pv.size() > 1) result.ponderMove = result.lines[0].pv[1];
+    }
+    result.stopped = stopped;
+    return result;
+}
+
+bool SearchEngine::waitForSearch(int timeoutMs) {
+    if (timeoutMs >= 0) {
+        std::unique_lock<std::mutex> lock(resultMutex);
+        if (!searchDone.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return !searching.load(); })) {
+            return false;
+        }
+    }
+    joinWorkers();
+    return true;
+}
+
+void SearchEngine::joinWorkers() {
+    for (std::thread& t : workers) {
+        if (t.joinable()) t.join();
+    }
+    workers.clear();
+}
+
+std::vector<EngineLine> SearchEngine::getBestLines(int count) {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    std::vector<EngineLine> result = lines;
+    if (count >= 0 && result.size() > (size_t)count) {
+        result.resize(count);
+    }
+    return result;
+}
+
+int SearchEngine::getEvaluation() {
+    auto best = getBestLines(1);
+    if (!best.empty()) {
+        return best[0].score;
+    }
+    return 0;
+}
+
+std::string SearchEngine::getBestMove() {
+    auto best = getBestLines(1);
+    if (!best.empty()) {
+        return best[0].move;
+    }
+    return "";
+}
+
+void SearchEngine::setMultiPV(int count) {
+    multiPV = std::max(1, std::min(count, MAX_MOVES));
+}
+
+void SearchEngine::setSkillLevel(int level) {
+    if (level < 0) level = 0;
+    if (level > 20) level = 20;
+    skillLevel = level;
+}
+
+void SearchEngine::setThreads(int count) {
+    threadCount = std::max(1, std::min(count, 64));
+}
+
+void SearchEngine::setHashSize(int megabytes) {
+    stopAnalysis();
+    tt.resize(static_cast<size_t>(std::max(1, megabytes)));
+}
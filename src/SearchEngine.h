@@ -0,0 +1,92 @@
+#ifndef SEARCH_ENGINE_H
+#define SEARCH_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AnalysisEngine.h"
+#include "EngineLog.h"
+#include "Position.h"
+#include "TranspositionTable.h"
+
+// In-process analysis engine, used when no external engine can be started.
+// Searches on worker threads (Lazy SMP over a shared transposition table)
+// and publishes the multi-PV lines of every completed depth.
+//
+// Throughput target: at least 2M nodes/second on one core of a current
+// desktop CPU, measured with "make bench" (tools/bench.cpp).
+class SearchEngine : public AnalysisEngine {
+private:
+    Position rootPosition;
+    TranspositionTable tt;
+    int multiPV;
+    int threadCount;
+    int skillLevel;
+    bool isRunning;
+    bool isReady;
+
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopFlag;
+    std::atomic<bool> searching;
+    std::atomic<bool> stopRequested;    // the running search was stopped from outside
+    std::atomic<uint64_t> nodesSearched;
+    std::atomic<uint64_t> linesVersion;
+
+    mutable std::mutex resultMutex;
+    std::vector<EngineLine> lines;  // guarded by resultMutex
+    std::condition_variable searchDone; // with resultMutex; signalled when `searching` clears
+    SearchCallback searchCallback;  // guarded by resultMutex; taken by whoever reports the result
+    bool pondering;                 // guarded by resultMutex; the result waits for ponderHit/stop
+    SearchLimits ponderLimits;      // limits of the ponder search after a hit
+    std::chrono::steady_clock::time_point ponderStart;
+    EngineLog log;                  // commands and completed depths, as a UCI engine would show them
+
+    void joinWorkers();
+    SearchResult currentResult(bool stopped);
+    int moveTimeMs(const SearchLimits& limits) const; // time for this move, 0 if unbounded
+
+public:
+    SearchEngine();
+    ~SearchEngine() override;
+
+    // Engine lifecycle (the path is ignored; nothing is spawned)
+    bool initialize(const std::string& enginePath = "") override;
+    void shutdown() override;
+
+    // Analysis
+    bool sendPosition(const std::string& fen) override;
+    bool sendPosition(const std::string& startFen, const std::vector<std::string>& uciMoves) override;
+    bool startAnalysis(int depth = 20, int multiPV = 1) override;
+    bool startSearch(const SearchLimits& limits, int multiPV = 1,
+                     const SearchCallback& onDone = SearchCallback()) override; // nodes count per thread
+    void stopAnalysis() override;
+    void ponderHit() override; // restarts under the real limits; the TT keeps the ponder work
+    bool waitForSearch(int timeoutMs = -1) override;
+
+    // Get analysis results (lines of the deepest completed iteration)
+    std::vector<EngineLine> getBestLines(int count = 3) override;
+    uint64_t getLinesVersion() const override { return linesVersion.load(); }
+    int getEvaluation() override;
+    std::string getBestMove() override;
+
+    // Configuration
+    void setMultiPV(int count) override;
+    void setSkillLevel(int level) override; // 0-20; below 20 caps the search depth at level + 1
+    void setThreads(int count) override;
+    void setHashSize(int megabytes) override;
+
+    // Status
+    bool isEngineReady() const override { return isReady; }
+    bool isEngineRunning() const override { return isRunning; }
+    const EngineLog* getLog() const override { return &log; }
+    bool isSearching() const { return searching.load(); }
+    uint64_t getNodesSearched() const { return nodesSearched.load(); } // all threads, last search
+    int getHashfull() const { return tt.hashfull(); }             // permille of the TT in use
+};
+
+#endif // SEARCH_ENGINE_H
@@ -0,0 +1,32 @@
+#include "SearchFuture.h"
+#include <chrono>
+#include <memory>
+
+SearchFuture SearchFuture::start(AnalysisEngine& engine, const SearchLimits& limits, int multiPV) {
+    std::shared_ptr<std::promise<SearchResult> > promise = std::make_shared<std::promise<SearchResult> >();
+    SearchFuture future;
+    std::shared_future<SearchResult> pending = promise->get_future().share();
+    if (engine.startSearch(limits, multiPV, [promise](const SearchResult& r) { promise->set_value(r); })) {
+        future.engine = &engine;
+        future.result = pending;
+    }
+    return future;
+}
+
+bool SearchFuture::wait(int timeoutMs) const {
+    if (!result.valid()) return false;
+    if (timeoutMs < 0) {
+        result.wait();
+        return true;
+    }
+    return result.wait_for(std::chrono::milliseconds(timeoutMs)) == std::future_status::ready;
+}
+
+SearchResult SearchFuture::get() const {
+    if (!result.valid()) return SearchResult();
+    return result.get();
+}
+
+void SearchFuture::cancel() {
+    if (engine && !ready()) engine->stopAnalysis();
+}
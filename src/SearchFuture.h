@@ -0,0 +1,33 @@
+#ifndef SEARCH_FUTURE_H
+#define SEARCH_FUTURE_H
+
+#include <future>
+#include "AnalysisEngine.h"
+
+// A search running in the background on one engine. It resolves when the
+// engine reports its best move, whether the search hit its limits or was
+// cancelled, so a caller can bound its latency with wait(timeoutMs) and
+// cancel() and still always get a move to play.
+class SearchFuture {
+private:
+    AnalysisEngine* engine;
+    std::shared_future<SearchResult> result;
+
+public:
+    SearchFuture() : engine(nullptr) {}
+
+    // Searches the engine's current position (set with sendPosition first).
+    // The future is invalid if the engine could not start the search.
+    static SearchFuture start(AnalysisEngine& engine, const SearchLimits& limits, int multiPV = 1);
+
+    bool valid() const { return result.valid(); }
+    bool ready() const { return wait(0); }
+    bool wait(int timeoutMs = -1) const;   // true once resolved; -1 waits indefinitely
+    SearchResult get() const;              // blocks until resolved
+
+    // Stops the engine's search if this one has not finished; the future
+    // then resolves with the best move so far and `stopped` set
+    void cancel();
+};
+
+#endif // SEARCH_FUTURE_H
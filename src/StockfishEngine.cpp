@@ -1,14 +1,53 @@
 #include "StockfishEngine.h"
+#include "UciInfo.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace {
+
+EngineLine toEngineLine(const UciInfo& info) {
+    EngineLine line;
+    line.depth = info.depth;
+    line.mate = 0;
+    line.score = info.score;
+    if (info.isMate) {
+        line.mate = info.score; // store plies directly
+        line.score = (info.score > 0) ? 10000 : -10000;
+    }
+    line.pv.reserve(info.pvLength);
+    for (int i = 0; i < info.pvLength; ++i) line.pv.push_back(moveToUCI(info.pv[i]));
+    if (!line.pv.empty()) line.move = line.pv[0];
+    return line;
+}
+
+} // namespace
 
 StockfishEngine::StockfishEngine()
-    : isRunning(false), isReady(false),
+    : isRunning(false), isReady(false), outputClosed(false),
+      readerStop(false), readerExited(false), searchesStarted(0), searchesFinished(0), lastStoppedSearch(0),
+#ifdef _WIN32
       childStdInRd(NULL), childStdInWr(NULL),
-      childStdOutRd(NULL), childStdOutWr(NULL) {
+      childStdOutRd(NULL), childStdOutWr(NULL), readEvent(NULL) {
     ZeroMemory(&piProcInfo, sizeof(PROCESS_INFORMATION));
 }
+#else
+      childPid(-1), childStdIn(-1), childStdOut(-1) {
+}
+#endif
 
 StockfishEngine::~StockfishEngine() {
     shutdown();
@@ -19,6 +58,7 @@ bool StockfishEngine::initialize(const std::string& enginePath) {
 
     if (!createChildProcess(enginePath)) {
         std::cout << "Failed to start Stockfish process" << std::endl;
+        closeChildProcess();
         return false;
     }
 
@@ -26,7 +66,7 @@ bool StockfishEngine::initialize(const std::string& enginePath) {
 
     // Send UCI command and wait for uciok
     writeToPipe("uci\n");
-    auto lines = readAllLines(2000);
+    auto lines = readUntil("uciok", 2000);
 
     bool uciOk = false;
     for (const auto& line : lines) {
@@ -44,12 +84,19 @@ bool StockfishEngine::initialize(const std::string& enginePath) {
 
     // Send isready and wait for readyok
     writeToPipe("isready\n");
-    lines = readAllLines(1000);
+    lines = readUntil("readyok", 1000);
 
     for (const auto& line : lines) {
         if (line.find("readyok") != std::string::npos) {
             isReady = true;
             std::cout << "Engine is ready!" << std::endl;
+
+            // From here on only the reader thread touches the engine's stdout
+            readerStop = false;
+            searchesStarted = 0;
+            searchesFinished = 0;
+            readerExited = false;
+            readerThread = std::thread(&StockfishEngine::readerLoop, this);
             return true;
         }
     }
@@ -61,18 +108,8 @@ bool StockfishEngine::initialize(const std::string& enginePath) {
 void StockfishEngine::shutdown() {
     if (isRunning) {
         writeToPipe("quit\n");
-        Sleep(100);
-
-        if (piProcInfo.hProcess) {
-            TerminateProcess(piProcInfo.hProcess, 0);
-            CloseHandle(piProcInfo.hProcess);
-            CloseHandle(piProcInfo.hThread);
-        }
-
-        if (childStdInRd) CloseHandle(childStdInRd);
-        if (childStdInWr) CloseHandle(childStdInWr);
-        if (childStdOutRd) CloseHandle(childStdOutRd);
-        if (childStdOutWr) CloseHandle(childStdOutWr);
+        stopReader();
+        closeChildProcess();
 
         isRunning = false;
         isReady = false;
@@ -80,19 +117,35 @@ void StockfishEngine::shutdown() {
     }
 }
 
+#ifdef _WIN32
+
 bool StockfishEngine::createChildProcess(const std::string& exePath) {
     SECURITY_ATTRIBUTES saAttr;
     saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
     saAttr.bInheritHandle = TRUE;
     saAttr.lpSecurityDescriptor = NULL;
 
-    // Create pipes for child process's STDOUT
-    if (!CreatePipe(&childStdOutRd, &childStdOutWr, &saAttr, 0)) {
-        std::cout << "StdoutRd CreatePipe failed" << std::endl;
+    // The child's STDOUT is a named pipe so our end can be read with overlapped
+    // I/O and waited on; anonymous pipes only support polling
+    static LONG pipeSerial = 0;
+    std::string pipeName = "\\\\.\\pipe\\chessSFML-engine-" + std::to_string(GetCurrentProcessId())
+                         + "-" + std::to_string(InterlockedIncrement(&pipeSerial));
+    childStdOutRd = CreateNamedPipeA(pipeName.c_str(), PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED,
+                                     PIPE_TYPE_BYTE | PIPE_WAIT, 1, 4096, 4096, 0, NULL);
+    if (childStdOutRd == INVALID_HANDLE_VALUE) {
+        childStdOutRd = NULL;
+        std::cout << "StdoutRd CreateNamedPipe failed" << std::endl;
+        return false;
+    }
+    childStdOutWr = CreateFileA(pipeName.c_str(), GENERIC_WRITE, 0, &saAttr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (childStdOutWr == INVALID_HANDLE_VALUE) {
+        childStdOutWr = NULL;
+        std::cout << "StdoutWr CreateFile failed" << std::endl;
         return false;
     }
-    if (!SetHandleInformation(childStdOutRd, HANDLE_FLAG_INHERIT, 0)) {
-        std::cout << "Stdout SetHandleInformation failed" << std::endl;
+    readEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    if (!readEvent) {
+        std::cout << "Stdout CreateEvent failed" << std::endl;
         return false;
     }
 
@@ -137,29 +190,222 @@ bool StockfishEngine::createChildProcess(const std::string& exePath) {
     return true;
 }
 
+void StockfishEngine::closeChildProcess() {
+    if (piProcInfo.hProcess) {
+        // Give the engine a moment to handle "quit" before forcing it
+        if (WaitForSingleObject(piProcInfo.hProcess, 100) != WAIT_OBJECT_0) {
+            TerminateProcess(piProcInfo.hProcess, 0);
+        }
+        CloseHandle(piProcInfo.hProcess);
+        CloseHandle(piProcInfo.hThread);
+        ZeroMemory(&piProcInfo, sizeof(PROCESS_INFORMATION));
+    }
+
+    if (childStdInRd) CloseHandle(childStdInRd);
+    if (childStdInWr) CloseHandle(childStdInWr);
+    if (childStdOutRd) CloseHandle(childStdOutRd);
+    if (childStdOutWr) CloseHandle(childStdOutWr);
+    if (readEvent) CloseHandle(readEvent);
+    childStdInRd = childStdInWr = childStdOutRd = childStdOutWr = readEvent = NULL;
+    pendingOutput.clear();
+}
+
 void StockfishEngine::writeToPipe(const std::string& command) {
+    log.recordSent(command.data(), command.size());
     DWORD dwWritten;
     WriteFile(childStdInWr, command.c_str(), command.length(), &dwWritten, NULL);
 }
 
-std::string StockfishEngine::readFromPipe(int timeoutMs) {
-    DWORD dwRead;
-    CHAR chBuf[4096];
-    std::string result;
+size_t StockfishEngine::readAvailable(int waitMs) {
+    if (!childStdOutRd || outputClosed) return 0;
 
-    DWORD startTime = GetTickCount();
-    while (GetTickCount() - startTime < (DWORD)timeoutMs) {
+    CHAR chBuf[4096];
+    size_t total = 0;
+    for (;;) {
         DWORD bytesAvailable = 0;
-        if (PeekNamedPipe(childStdOutRd, NULL, 0, NULL, &bytesAvailable, NULL) && bytesAvailable > 0) {
-            DWORD bytesToRead = min(bytesAvailable, sizeof(chBuf) - 1);
-            if (ReadFile(childStdOutRd, chBuf, bytesToRead, &dwRead, NULL) && dwRead > 0) {
-                chBuf[dwRead] = '\0';
-                result += chBuf;
+        if (!PeekNamedPipe(childStdOutRd, NULL, 0, NULL, &bytesAvailable, NULL)) {
+            outputClosed = true;
+            return total;
+        }
+        if (bytesAvailable == 0 && (total > 0 || waitMs <= 0)) return total;
+
+        // Overlapped read: completes as soon as the engine writes anything,
+        // or is cancelled when the wait runs out
+        OVERLAPPED ov;
+        ZeroMemory(&ov, sizeof(OVERLAPPED));
+        ov.hEvent = readEvent;
+        ResetEvent(readEvent);
+        DWORD dwRead = 0;
+        if (!ReadFile(childStdOutRd, chBuf, sizeof(chBuf), &dwRead, &ov)) {
+            DWORD err = GetLastError();
+            if (err != ERROR_IO_PENDING) {
+                if (err == ERROR_BROKEN_PIPE) outputClosed = true;
+                return total;
+            }
+            if (WaitForSingleObject(readEvent, bytesAvailable > 0 ? INFINITE : (DWORD)waitMs) != WAIT_OBJECT_0) {
+                CancelIo(childStdOutRd);
+            }
+            if (!GetOverlappedResult(childStdOutRd, &ov, &dwRead, TRUE)) {
+                if (GetLastError() == ERROR_BROKEN_PIPE) outputClosed = true;
+                return total;
+            }
+        }
+        if (dwRead == 0) return total;
+        pendingOutput.append(chBuf, dwRead);
+        total += dwRead;
+    }
+}
+
+#else
+
+bool StockfishEngine::createChildProcess(const std::string& exePath) {
+    // A dead engine must not kill us with SIGPIPE on the next write
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int inPipe[2];
+    int outPipe[2];
+    if (pipe(inPipe) != 0) {
+        std::cout << "Stdin pipe failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (pipe(outPipe) != 0) {
+        std::cout << "Stdout pipe failed: " << std::strerror(errno) << std::endl;
+        close(inPipe[0]);
+        close(inPipe[1]);
+        return false;
+    }
+
+    // Our ends must not leak into the child; its ends are dup2'ed onto 0/1/2
+    fcntl(inPipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(outPipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(outPipe[0], F_SETFL, fcntl(outPipe[0], F_GETFL) | O_NONBLOCK);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDERR_FILENO);
+    posix_spawn_file_actions_addclose(&actions, inPipe[0]);
+    posix_spawn_file_actions_addclose(&actions, outPipe[1]);
+
+    char* argv[] = { const_cast<char*>(exePath.c_str()), NULL };
+    pid_t pid = -1;
+    int err = posix_spawnp(&pid, exePath.c_str(), &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    // The child has its own copies now
+    close(inPipe[0]);
+    close(outPipe[1]);
+    childStdIn = inPipe[1];
+    childStdOut = outPipe[0];
+
+    if (err != 0) {
+        std::cout << "posix_spawn failed: " << std::strerror(err) << std::endl;
+        return false;
+    }
+    childPid = pid;
+    outputClosed = false;
+    return true;
+}
+
+void StockfishEngine::closeChildProcess() {
+    // Closing stdin makes a well-behaved engine exit; wait for its stdout to
+    // hang up (at most 100 ms) before forcing it
+    if (childStdIn >= 0) close(childStdIn);
+    childStdIn = -1;
+
+    if (childPid > 0) {
+        if (childStdOut >= 0 && !outputClosed) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+            for (;;) {
+                int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count());
+                if (remaining <= 0) break;
+                size_t n = readAvailable(remaining);
+                if (outputClosed) break;
+                if (n == 0) break;
             }
         }
-        Sleep(10);
+        if (waitpid(childPid, NULL, WNOHANG) == 0) {
+            kill(childPid, SIGKILL);
+            waitpid(childPid, NULL, 0);
+        }
+        childPid = -1;
     }
 
+    if (childStdOut >= 0) close(childStdOut);
+    childStdOut = -1;
+    pendingOutput.clear();
+}
+
+void StockfishEngine::writeToPipe(const std::string& command) {
+    log.recordSent(command.data(), command.size());
+    if (childStdIn < 0) return;
+    size_t written = 0;
+    while (written < command.size()) {
+        ssize_t n = write(childStdIn, command.data() + written, command.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return; // engine gone (EPIPE)
+        }
+        written += static_cast<size_t>(n);
+    }
+}
+
+size_t StockfishEngine::readAvailable(int waitMs) {
+    if (childStdOut < 0 || outputClosed) return 0;
+
+    char chBuf[4096];
+    size_t total = 0;
+    for (;;) {
+        ssize_t n = read(childStdOut, chBuf, sizeof(chBuf));
+        if (n > 0) {
+            pendingOutput.append(chBuf, static_cast<size_t>(n));
+            total += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            outputClosed = true;
+            return total;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            outputClosed = true;
+            return total;
+        }
+
+        // Drained: done if we got something or may not wait, else sleep in poll
+        // until the engine writes or the wait runs out
+        if (total > 0 || waitMs <= 0) return total;
+        struct pollfd pfd;
+        pfd.fd = childStdOut;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, waitMs);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) return total;
+        waitMs = 0;
+    }
+}
+
+#endif
+
+std::string StockfishEngine::readFromPipe(int timeoutMs) {
+    // Wait (without polling) for at least one complete line, then take whatever
+    // else has already arrived. A trailing partial line stays buffered.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (pendingOutput.find('\n') == std::string::npos && !outputClosed) {
+        int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        if (remaining <= 0) break;
+        readAvailable(remaining);
+    }
+    readAvailable(0);
+
+    size_t end = pendingOutput.rfind('\n');
+    if (end == std::string::npos) return std::string();
+    std::string result = pendingOutput.substr(0, end + 1);
+    pendingOutput.erase(0, end + 1);
     return result;
 }
 
@@ -170,7 +416,9 @@ std::vector<std::string> StockfishEngine::readAllLines(int timeoutMs) {
     std::string line;
 
     while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
         if (!line.empty()) {
+            log.recordReceived(line.data(), line.size());
             lines.push_back(line);
         }
     }
@@ -178,89 +426,266 @@ std::vector<std::string> StockfishEngine::readAllLines(int timeoutMs) {
     return lines;
 }
 
+std::vector<std::string> StockfishEngine::readUntil(const std::string& token, int timeoutMs) {
+    std::vector<std::string> lines;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        if (remaining <= 0 || outputClosed) break;
+        for (const auto& line : readAllLines(remaining)) {
+            lines.push_back(line);
+            if (line.find(token) != std::string::npos) return lines;
+        }
+    }
+    return lines;
+}
+
 bool StockfishEngine::sendPosition(const std::string& fen) {
     if (!isReady) return false;
 
+    // The engine must not be searching when the position changes
+    if (searchesFinished.load() < searchesStarted.load()) {
+        lastStoppedSearch = searchesStarted.load();
+        writeToPipe("stop\n");
+    }
+
     std::string command = "position fen " + fen + "\n";
     writeToPipe(command);
     return true;
 }
 
-bool StockfishEngine::startAnalysis(int depth, int multiPV) {
+bool StockfishEngine::sendPosition(const std::string& startFen, const std::vector<std::string>& uciMoves) {
     if (!isReady) return false;
 
+    if (searchesFinished.load() < searchesStarted.load()) {
+        lastStoppedSearch = searchesStarted.load();
+        writeToPipe("stop\n");
+    }
+
+    std::string command = "position fen " + startFen;
+    if (!uciMoves.empty()) command += " moves";
+    for (const std::string& uci : uciMoves) command += " " + uci;
+    writeToPipe(command + "\n");
+    return true;
+}
+
+bool StockfishEngine::startAnalysis(int depth, int multiPV) {
+    SearchLimits limits;
+    limits.depth = depth;
+    return startSearch(limits, multiPV);
+}
+
+bool StockfishEngine::startSearch(const SearchLimits& limits, int multiPV, const SearchCallback& onDone) {
+    if (!isReady || readerExited.load()) return false;
+
     setMultiPV(multiPV);
 
-    std::string command = "go depth " + std::to_string(depth) + "\n";
+    std::string bounds;
+    if (!limits.infinite) {
+        if (limits.depth > 0) bounds += " depth " + std::to_string(limits.depth);
+        if (limits.movetimeMs > 0) bounds += " movetime " + std::to_string(limits.movetimeMs);
+        if (limits.nodes > 0) bounds += " nodes " + std::to_string(limits.nodes);
+        if (limits.whiteTimeMs > 0) bounds += " wtime " + std::to_string(limits.whiteTimeMs);
+        if (limits.blackTimeMs > 0) bounds += " btime " + std::to_string(limits.blackTimeMs);
+        if (limits.whiteIncMs > 0) bounds += " winc " + std::to_string(limits.whiteIncMs);
+        if (limits.blackIncMs > 0) bounds += " binc " + std::to_string(limits.blackIncMs);
+        if (limits.movesToGo > 0) bounds += " movestogo " + std::to_string(limits.movesToGo);
+    }
+    std::string command = limits.ponder ? "go ponder" : "go";
+    command += bounds.empty() ? " infinite" : bounds;
+    // Engines read moves after "searchmoves" up to the end of the line
+    if (!limits.searchMoves.empty()) {
+        command += " searchmoves";
+        for (const std::string& move : limits.searchMoves) command += " " + move;
+    }
+    command += "\n";
+
+    if (onDone) {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        searchCallbacks[searchesStarted.load() + 1] = onDone;
+    }
+
+    // Counted before the command goes out so the reader can tell this search's
+    // output from the tail of the previous one
+    searchesStarted++;
     writeToPipe(command);
     return true;
 }
 
+bool StockfishEngine::waitForSearch(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(searchMutex);
+    auto finished = [this]() { return readerExited.load() || searchesFinished.load() >= searchesStarted.load(); };
+    if (timeoutMs < 0) {
+        searchDone.wait(lock, finished);
+        return true;
+    }
+    return searchDone.wait_for(lock, std::chrono::milliseconds(timeoutMs), finished);
+}
+
+void StockfishEngine::ponderHit() {
+    if (isRunning) {
+        writeToPipe("ponderhit\n");
+    }
+}
+
 void StockfishEngine::stopAnalysis() {
     if (isRunning) {
+        lastStoppedSearch = searchesStarted.load();
         writeToPipe("stop\n");
     }
 }
 
-std::vector<EngineLine> StockfishEngine::getBestLines(int count) {
-    std::vector<EngineLine> lines;
+void StockfishEngine::readerLoop() {
+    std::vector<UciInfo> working;   // by multipv - 1; pvLength 0 until reported
+    std::string bestMove;
+    int workingSearch = 0;
+    int finished = 0;               // "bestmove" lines read; published after the snapshot
+    uint64_t version = 0;
+    UciInfo info;
+    std::vector<std::pair<int, SearchResult> > ended;  // searches whose bestmove came in this batch
+
+    while (!readerStop.load() && !outputClosed) {
+        // Bounded wait so a stop request is noticed even if the engine is silent
+        readAvailable(50);
+
+        bool changed = false;
+        size_t batchLines = 0;
+        size_t start = 0;
+        size_t end;
+        while ((end = pendingOutput.find('\n', start)) != std::string::npos) {
+            // Lines are parsed in place; nothing is copied out of the buffer
+            const char* line = pendingOutput.data() + start;
+            size_t length = end - start;
+            start = end + 1;
+            log.recordReceived(line, length);
+            batchLines++;
+
+            // Output belongs to the oldest search without a bestmove; anything
+            // from a search that has since been replaced is dropped
+            int search = finished + 1;
+            bool current = search == searchesStarted.load();
+            if (current && search != workingSearch) {
+                working.clear();
+                bestMove.clear();
+                workingSearch = search;
+            }
 
-    // Read all available output
-    auto outputLines = readAllLines(500);
-
-    // Parse info lines
-    for (const auto& line : outputLines) {
-        if (line.find("info") == 0 && line.find("pv") != std::string::npos) {
-            EngineLine engineLine;
-            engineLine.score = 0;
-            engineLine.depth = 0;
-            engineLine.mate = 0;
-            std::istringstream iss(line);
-            std::string token;
-
-            bool readingPV = false;
-            while (iss >> token) {
-                if (token == "depth") {
-                    iss >> engineLine.depth;
+            if (length >= 9 && std::memcmp(line, "bestmove ", 9) == 0) {
+                finished++;
+                size_t moveEnd = 9;
+                while (moveEnd < length && line[moveEnd] != ' ' && line[moveEnd] != '\r') moveEnd++;
+                SearchResult result;
+                result.bestMove.assign(line + 9, moveEnd - 9);
+                if (result.bestMove == "(none)") result.bestMove.clear();
+                if (length >= moveEnd + 8 && std::memcmp(line + moveEnd, " ponder ", 8) == 0) {
+                    size_t ponderEnd = moveEnd + 8;
+                    while (ponderEnd < length && line[ponderEnd] != ' ' && line[ponderEnd] != '\r') ponderEnd++;
+                    result.ponderMove.assign(line + moveEnd + 8, ponderEnd - moveEnd - 8);
                 }
-                else if (token == "score") {
-                    iss >> token; // "cp" or "mate"
-                    if (token == "cp") {
-                        iss >> engineLine.score;
-                        engineLine.mate = 0; // not a mate score
-                    }
-                    else if (token == "mate") {
-                        int mateIn;
-                        iss >> mateIn;
-                        engineLine.mate = mateIn; // store plies directly
-                        engineLine.score = (mateIn > 0) ? 10000 : -10000;
-                    }
-                }
-                else if (token == "pv") {
-                    readingPV = true;
-                }
-                else if (readingPV) {
-                    engineLine.pv.push_back(token);
-                    if (engineLine.move.empty()) {
-                        engineLine.move = token;
+                result.stopped = lastStoppedSearch.load() >= search;
+                if (current) {
+                    log.recordBestMove();
+                    bestMove = result.bestMove;
+                    for (const UciInfo& pv : working) {
+                        if (pv.pvLength > 0) result.lines.push_back(toEngineLine(pv));
                     }
+                    changed = true;
+                }
+                ended.push_back(std::make_pair(search, result));
+            } else if (current) {
+                auto parseStart = std::chrono::steady_clock::now();
+                bool parsed = parseUciInfo(line, length, info);
+                log.recordParse(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - parseStart).count());
+                if (parsed && info.pvLength > 0 && info.multipv >= 1 && info.multipv <= 256) {
+                    if (working.size() < (size_t)info.multipv) working.resize(info.multipv);
+                    working[info.multipv - 1] = info;
+                    if (info.has(UCI_INFO_DEPTH)) log.recordDepth(info.depth);
+                    changed = true;
                 }
             }
-
-            if (!engineLine.move.empty()) {
-                lines.push_back(engineLine);
+        }
+        pendingOutput.erase(0, start);
+        if (batchLines > 0) log.recordBatch(batchLines, pendingOutput.size());
+
+        // One snapshot per batch of output, not per line
+        if (changed) {
+            std::shared_ptr<AnalysisSnapshot> next = std::make_shared<AnalysisSnapshot>();
+            next->lines.resize(working.size());
+            for (size_t i = 0; i < working.size(); ++i) {
+                if (working[i].pvLength > 0) next->lines[i] = toEngineLine(working[i]);
             }
+            next->bestMove = bestMove;
+            next->searchId = workingSearch;
+            next->version = ++version;
+            std::atomic_store(&snapshot, std::shared_ptr<const AnalysisSnapshot>(next));
+        }
+
+        // Callbacks see the published snapshot and run before waiters wake
+        for (const auto& e : ended) finishSearch(e.first, e.second);
+        ended.clear();
+
+        // Only now are the final lines of a finished search visible
+        if (finished != searchesFinished.load()) {
+            std::lock_guard<std::mutex> lock(searchMutex);
+            searchesFinished = finished;
+            searchDone.notify_all();
         }
     }
 
-    // Return only the requested count
-    if (lines.size() > (size_t)count) {
-        lines.resize(count);
+    // No search can finish once the reader is gone; release any waiter
+    SearchResult lost;
+    lost.stopped = true;
+    for (int search = finished + 1; search <= searchesStarted.load(); ++search) finishSearch(search, lost);
+
+    std::lock_guard<std::mutex> lock(searchMutex);
+    readerExited = true;
+    searchDone.notify_all();
+}
+
+void StockfishEngine::finishSearch(int search, const SearchResult& result) {
+    SearchCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        std::map<int, SearchCallback>::iterator it = searchCallbacks.find(search);
+        if (it == searchCallbacks.end()) return;
+        callback = it->second;
+        searchCallbacks.erase(it);
     }
+    callback(result);
+}
 
+void StockfishEngine::stopReader() {
+    readerStop = true;
+    if (readerThread.joinable()) readerThread.join();
+    std::atomic_store(&snapshot, std::shared_ptr<const AnalysisSnapshot>());
+}
+
+std::shared_ptr<const AnalysisSnapshot> StockfishEngine::currentSnapshot() const {
+    std::shared_ptr<const AnalysisSnapshot> snap = std::atomic_load(&snapshot);
+    if (snap && snap->searchId != searchesStarted.load()) snap.reset();
+    return snap;
+}
+
+std::vector<EngineLine> StockfishEngine::getBestLines(int count) {
+    std::vector<EngineLine> lines;
+    std::shared_ptr<const AnalysisSnapshot> snap = currentSnapshot();
+    if (!snap) return lines;
+
+    for (const auto& line : snap->lines) {
+        if ((int)lines.size() >= count) break;
+        if (!line.move.empty()) lines.push_back(line);
+    }
     return lines;
 }
 
+uint64_t StockfishEngine::getLinesVersion() const {
+    // Both terms only grow, so the sum changes when either does
+    std::shared_ptr<const AnalysisSnapshot> snap = std::atomic_load(&snapshot);
+    return (snap ? snap->version : 0) + static_cast<uint64_t>(searchesStarted.load());
+}
+
 int StockfishEngine::getEvaluation() {
     auto lines = getBestLines(1);
     if (!lines.empty()) {
@@ -270,6 +695,10 @@ int StockfishEngine::getEvaluation() {
 }
 
 std::string StockfishEngine::getBestMove() {
+    std::shared_ptr<const AnalysisSnapshot> snap = currentSnapshot();
+    if (snap && !snap->bestMove.empty()) {
+        return snap->bestMove;
+    }
     auto lines = getBestLines(1);
     if (!lines.empty()) {
         return lines[0].move;
@@ -296,3 +725,9 @@ void StockfishEngine::setThreads(int count) {
     std::string command = "setoption name Threads value " + std::to_string(count) + "\n";
     writeToPipe(command);
 }
+
+void StockfishEngine::setHashSize(int megabytes) {
+    if (!isReady) return;
+    std::string command = "setoption name Hash value " + std::to_string(megabytes) + "\n";
+    writeToPipe(command);
+}
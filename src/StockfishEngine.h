@@ -1,62 +1,128 @@
 #ifndef STOCKFISH_ENGINE_H
 #define STOCKFISH_ENGINE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+#include "AnalysisEngine.h"
+#include "EngineLog.h"
 
-struct EngineLine {
-    std::string move;           // Best move in this line (e.g., "e2e4")
-    std::vector<std::string> pv; // Principal variation (sequence of moves)
-    int score;                  // Evaluation in centipawns (+100 = +1.0 pawn advantage)
-    int depth;                  // Search depth
-    int mate;                   // Mate in plies (0 = checkmate on board, >0 side to move mates in N plies, <0 side to move is mated in N plies)
-};
+#ifdef _WIN32
+const char* const STOCKFISH_DEFAULT_PATH = "engines/stockfish.exe";
+#else
+const char* const STOCKFISH_DEFAULT_PATH = "engines/stockfish";
+#endif
 
-class StockfishEngine {
+// Analysis of one search as parsed from the engine's output. Published
+// snapshots are never modified, so readers need no lock.
+struct AnalysisSnapshot {
+    std::vector<EngineLine> lines;  // by multipv - 1; a line not yet reported has no move
+    std::string bestMove;           // set once the engine has sent "bestmove"
+    int searchId;                   // which "go" this belongs to
+    uint64_t version;               // increases with every snapshot published
+};
+
+// UCI engine running as a child process. The process backend is chosen at
+// build time (Win32 CreateProcess or POSIX posix_spawn); both wait on the
+// engine's stdout instead of polling it, so output is read as soon as it arrives.
+// After the handshake a reader thread owns stdout: it parses info/bestmove
+// lines as they come and publishes an AnalysisSnapshot for the UI thread.
+
+class StockfishEngine : public AnalysisEngine {
 private:
+    bool isRunning;
+    bool isReady;
+
+    // Engine output read but not yet returned (a partial last line)
+    std::string pendingOutput;
+    bool outputClosed;
+
+    // Output reader
+    std::thread readerThread;
+    std::atomic<bool> readerStop;
+    std::atomic<bool> readerExited;                     // engine output closed; no search can finish
+    std::atomic<int> searchesStarted;                   // "go" commands sent
+    std::atomic<int> searchesFinished;                  // "bestmove" lines received and published
+    std::mutex searchMutex;
+    std::condition_variable searchDone;                 // signalled when searchesFinished changes
+    std::atomic<int> lastStoppedSearch;                 // newest search sent a "stop"
+    std::mutex callbackMutex;
+    std::map<int, SearchCallback> searchCallbacks;      // by search number, until its bestmove
+    std::shared_ptr<const AnalysisSnapshot> snapshot;   // only via std::atomic_load/atomic_store
+    EngineLog log;                                      // every command and output line
+
+#ifdef _WIN32
     // Process handles
     HANDLE childStdInRd;
     HANDLE childStdInWr;
-    HANDLE childStdOutRd;
+    HANDLE childStdOutRd;   // overlapped named pipe
     HANDLE childStdOutWr;
+    HANDLE readEvent;
     PROCESS_INFORMATION piProcInfo;
-
-    bool isRunning;
-    bool isReady;
+#else
+    pid_t childPid;
+    int childStdIn;
+    int childStdOut;        // non-blocking
+#endif
 
     // Helper methods
     bool createChildProcess(const std::string& exePath);
+    void closeChildProcess();
     void writeToPipe(const std::string& command);
-    std::string readFromPipe(int timeoutMs = 100);
+    size_t readAvailable(int waitMs);   // waits up to waitMs for output, then drains; returns bytes read
+    std::string readFromPipe(int timeoutMs = 100);  // complete lines only, as soon as one arrives
     std::vector<std::string> readAllLines(int timeoutMs = 1000);
+    std::vector<std::string> readUntil(const std::string& token, int timeoutMs);
+    void readerLoop();
+    void finishSearch(int search, const SearchResult& result); // runs the search's callback, if any
+    void stopReader();
+    std::shared_ptr<const AnalysisSnapshot> currentSnapshot() const; // null unless it is for the latest search
 
 public:
     StockfishEngine();
-    ~StockfishEngine();
+    ~StockfishEngine() override;
 
     // Engine lifecycle
-    bool initialize(const std::string& enginePath = "engines/stockfish.exe");
-    void shutdown();
+    bool initialize(const std::string& enginePath = STOCKFISH_DEFAULT_PATH) override;
+    void shutdown() override;
 
     // UCI commands
-    bool sendPosition(const std::string& fen);
-    bool startAnalysis(int depth = 20, int multiPV = 1);
-    void stopAnalysis();
+    bool sendPosition(const std::string& fen) override;
+    bool sendPosition(const std::string& startFen, const std::vector<std::string>& uciMoves) override;
+    bool startAnalysis(int depth = 20, int multiPV = 1) override;
+    bool startSearch(const SearchLimits& limits, int multiPV = 1,
+                     const SearchCallback& onDone = SearchCallback()) override;
+    void stopAnalysis() override;
+    void ponderHit() override;
+    bool waitForSearch(int timeoutMs = -1) override;
 
     // Get analysis results
-    std::vector<EngineLine> getBestLines(int count = 3);
-    int getEvaluation(); // Returns centipawns (+100 = white is up 1 pawn)
-    std::string getBestMove();
+    std::vector<EngineLine> getBestLines(int count = 3) override;  // never blocks
+    uint64_t getLinesVersion() const override;
+    int getEvaluation() override; // Returns centipawns (+100 = white is up 1 pawn)
+    std::string getBestMove() override;
 
     // Configuration
-    void setMultiPV(int count);
-    void setSkillLevel(int level); // 0-20, lower = weaker
-    void setThreads(int count);
+    void setMultiPV(int count) override;
+    void setSkillLevel(int level) override; // 0-20, lower = weaker
+    void setThreads(int count) override;
+    void setHashSize(int megabytes) override;
 
     // Status
-    bool isEngineReady() const { return isReady; }
-    bool isEngineRunning() const { return isRunning; }
+    bool isEngineReady() const override { return isReady; }
+    bool isEngineRunning() const override { return isRunning; }
+    const EngineLog* getLog() const override { return &log; }
 };
 
 #endif // STOCKFISH_ENGINE_H
@@ -0,0 +1,128 @@
+#include "TranspositionTable.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Packed slot data:
+//   bits 0-15  move
+//   bits 16-31 score (int16)
+//   bits 32-39 depth (int8)
+//   bits 40-41 bound
+//   bits 42-47 generation
+inline uint64_t packData(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return static_cast<uint64_t>(move)
+         | (static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score))) << 16)
+         | (static_cast<uint64_t>(static_cast<uint8_t>(static_cast<int8_t>(depth))) << 32)
+         | (static_cast<uint64_t>(bound) << 40)
+         | (static_cast<uint64_t>(generation & 63) << 42);
+}
+
+inline Move dataMove(uint64_t d) { return static_cast<Move>(d & 0xFFFF); }
+inline int dataScore(uint64_t d) { return static_cast<int16_t>(static_cast<uint16_t>(d >> 16)); }
+inline int dataDepth(uint64_t d) { return static_cast<int8_t>(static_cast<uint8_t>(d >> 32)); }
+inline Bound dataBound(uint64_t d) { return static_cast<Bound>((d >> 40) & 3); }
+inline uint8_t dataGeneration(uint64_t d) { return static_cast<uint8_t>((d >> 42) & 63); }
+
+const int HASHFULL_SAMPLE_BUCKETS = 250; // 1000 slots
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : memory(nullptr), buckets(nullptr), bucketMask(0), generation(0) {
+    resize(megabytes);
+}
+
+TranspositionTable::~TranspositionTable() {
+    std::free(memory);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t target = (megabytes ? megabytes : 1) * 1024 * 1024 / sizeof(Bucket);
+    size_t count = 1;
+    while (count * 2 <= target) count *= 2;
+
+    std::free(memory);
+    memory = static_cast<char*>(std::malloc(count * sizeof(Bucket) + 63));
+    if (!memory) throw std::bad_alloc();
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(memory) + 63) & ~static_cast<uintptr_t>(63);
+    buckets = reinterpret_cast<Bucket*>(aligned);
+    for (size_t i = 0; i < count; ++i) new (&buckets[i]) Bucket();
+    bucketMask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= bucketMask; ++i) {
+        for (int s = 0; s < BUCKET_SLOTS; ++s) {
+            buckets[i].slots[s].keyXorData.store(0, std::memory_order_relaxed);
+            buckets[i].slots[s].data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation = static_cast<uint8_t>((generation + 1) & 63);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Bucket& bucket = buckets[key & bucketMask];
+    for (int s = 0; s < BUCKET_SLOTS; ++s) {
+        uint64_t data = bucket.slots[s].data.load(std::memory_order_relaxed);
+        uint64_t check = bucket.slots[s].keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && dataBound(data) != BOUND_NONE) {
+            entry.move = dataMove(data);
+            entry.score = static_cast<int16_t>(dataScore(data));
+            entry.depth = static_cast<int8_t>(dataDepth(data));
+            entry.bound = dataBound(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+    Bucket& bucket = buckets[key & bucketMask];
+
+    // Same position already stored: overwrite it. Otherwise evict the slot
+    // that is shallowest once each search of age counts as 8 plies of depth.
+    Slot* victim = &bucket.slots[0];
+    int victimValue = 1 << 30;
+    for (int s = 0; s < BUCKET_SLOTS; ++s) {
+        Slot& slot = bucket.slots[s];
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key || dataBound(data) == BOUND_NONE) {
+            // Keep the old best move and a deeper result of the same search
+            if ((check ^ data) == key) {
+                if (move == MOVE_NONE) move = dataMove(data);
+                if (bound != BOUND_EXACT && dataGeneration(data) == generation && dataDepth(data) > depth + 2) return;
+            }
+            victim = &slot;
+            break;
+        }
+        int age = (generation - dataGeneration(data)) & 63;
+        int value = dataDepth(data) - 8 * age;
+        if (value < victimValue) {
+            victimValue = value;
+            victim = &slot;
+        }
+    }
+
+    uint64_t data = packData(move, score, depth, bound, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = bucketMask + 1 < static_cast<size_t>(HASHFULL_SAMPLE_BUCKETS) ? bucketMask + 1 : HASHFULL_SAMPLE_BUCKETS;
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (int s = 0; s < BUCKET_SLOTS; ++s) {
+            uint64_t data = buckets[i].slots[s].data.load(std::memory_order_relaxed);
+            if (dataBound(data) != BOUND_NONE && dataGeneration(data) == generation) used++;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * BUCKET_SLOTS));
+}
@@ -0,0 +1,68 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Move.h"
+
+enum Bound : uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,   // score <= stored value (failed low)
+    BOUND_LOWER = 2,   // score >= stored value (failed high)
+    BOUND_EXACT = 3
+};
+
+// Decoded copy of a table entry, as returned by probe()
+struct TTEntry {
+    Move move;
+    int16_t score;
+    int8_t depth;
+    uint8_t bound;
+};
+
+// Fixed-size hash table of search results shared by all search threads.
+//
+// Each 64-byte bucket (one cache line) holds four 16-byte slots. A slot is
+// two atomic words: the packed data and key ^ data. Readers and writers never
+// lock; a slot torn by a concurrent write fails the xor check and reads as a
+// miss. When a bucket is full the slot with the lowest depth, penalised by
+// its age in searches, is replaced.
+class TranspositionTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    static const int BUCKET_SLOTS = 4;
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SLOTS];
+    };
+
+    char* memory;          // raw allocation, buckets start at the next 64-byte boundary
+    Bucket* buckets;
+    size_t bucketMask;     // bucket count - 1 (a power of two)
+    uint8_t generation;    // 6-bit search age, bumped by newSearch()
+
+    TranspositionTable(const TranspositionTable&);
+    TranspositionTable& operator=(const TranspositionTable&);
+
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+    ~TranspositionTable();
+
+    // Not thread safe: only call while no search is running
+    void resize(size_t megabytes); // rounded down to a power of two buckets
+    void clear();
+    void newSearch();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+
+    // Permille of sampled slots written during the current search (UCI hashfull)
+    int hashfull() const;
+    size_t sizeInBytes() const { return (bucketMask + 1) * sizeof(Bucket); }
+};
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,157 @@
+#include "UciInfo.h"
+#include <cstring>
+
+namespace {
+
+// A token is a view into the caller's buffer; nothing is copied
+struct Token {
+    const char* text;
+    size_t length;
+
+    // Compares against a string literal; its length is known at compile time
+    template <size_t N>
+    bool is(const char (&word)[N]) const {
+        return length == N - 1 && std::memcmp(text, word, N - 1) == 0;
+    }
+};
+
+class Tokenizer {
+private:
+    const char* pos;
+    const char* end;
+
+public:
+    Tokenizer(const char* text, size_t length) : pos(text), end(text + length) {}
+
+    bool next(Token& token) {
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n')) ++pos;
+        if (pos == end) return false;
+        token.text = pos;
+        while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') ++pos;
+        token.length = static_cast<size_t>(pos - token.text);
+        return true;
+    }
+};
+
+bool toInt(const Token& token, int64_t& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (token.length > 0 && (token.text[0] == '-' || token.text[0] == '+')) {
+        negative = token.text[0] == '-';
+        i = 1;
+    }
+    if (i == token.length || token.length - i > 18) return false; // fits int64_t
+    int64_t result = 0;
+    for (; i < token.length; ++i) {
+        char c = token.text[i];
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+// Reads the number after a keyword; a missing or malformed value is ignored
+template <typename T>
+bool nextInt(Tokenizer& tokens, T& value) {
+    Token token;
+    int64_t parsed;
+    if (!tokens.next(token) || !toInt(token, parsed)) return false;
+    value = static_cast<T>(parsed);
+    return true;
+}
+
+} // namespace
+
+Move parseUciMoveText(const char* text, size_t length) {
+    if (length != 4 && length != 5) return MOVE_NONE;
+    if (text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8'
+        || text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8') {
+        return MOVE_NONE;
+    }
+    int from = (text[1] - '1') * 8 + (text[0] - 'a');
+    int to = (text[3] - '1') * 8 + (text[2] - 'a');
+    if (from == to) return MOVE_NONE;
+    if (length == 4) return encodeMove(from, to);
+
+    PieceType promotion;
+    switch (text[4]) {
+        case 'n': promotion = PieceType::KNIGHT; break;
+        case 'b': promotion = PieceType::BISHOP; break;
+        case 'r': promotion = PieceType::ROOK; break;
+        case 'q': promotion = PieceType::QUEEN; break;
+        default: return MOVE_NONE;
+    }
+    return encodeMove(from, to, MOVE_PROMOTION, promotion);
+}
+
+bool parseUciInfo(const char* text, size_t length, UciInfo& info) {
+    Tokenizer tokens(text, length);
+    Token token;
+    if (!tokens.next(token) || !token.is("info")) return false;
+
+    info.fields = 0;
+    info.depth = 0;
+    info.seldepth = 0;
+    info.multipv = 1;
+    info.score = 0;
+    info.isMate = false;
+    info.bound = UCI_BOUND_EXACT;
+    info.hashfull = 0;
+    info.nodes = 0;
+    info.nps = 0;
+    info.tbhits = 0;
+    info.timeMs = 0;
+    info.pvLength = 0;
+
+    bool haveToken = tokens.next(token);
+    while (haveToken) {
+        if (token.is("string")) {
+            return false; // free text up to the end of the line
+        } else if (token.is("depth")) {
+            if (nextInt(tokens, info.depth)) info.fields |= UCI_INFO_DEPTH;
+        } else if (token.is("seldepth")) {
+            if (nextInt(tokens, info.seldepth)) info.fields |= UCI_INFO_SELDEPTH;
+        } else if (token.is("multipv")) {
+            if (nextInt(tokens, info.multipv)) info.fields |= UCI_INFO_MULTIPV;
+        } else if (token.is("nodes")) {
+            if (nextInt(tokens, info.nodes)) info.fields |= UCI_INFO_NODES;
+        } else if (token.is("nps")) {
+            if (nextInt(tokens, info.nps)) info.fields |= UCI_INFO_NPS;
+        } else if (token.is("hashfull")) {
+            if (nextInt(tokens, info.hashfull)) info.fields |= UCI_INFO_HASHFULL;
+        } else if (token.is("tbhits")) {
+            if (nextInt(tokens, info.tbhits)) info.fields |= UCI_INFO_TBHITS;
+        } else if (token.is("time")) {
+            if (nextInt(tokens, info.timeMs)) info.fields |= UCI_INFO_TIME;
+        } else if (token.is("score")) {
+            // score cp <x> | mate <y>, optionally followed by lowerbound/upperbound
+            Token kind;
+            if (tokens.next(kind) && (kind.is("cp") || kind.is("mate"))) {
+                if (nextInt(tokens, info.score)) {
+                    info.isMate = kind.is("mate");
+                    info.fields |= UCI_INFO_SCORE;
+                }
+            }
+            haveToken = tokens.next(token);
+            if (haveToken && token.is("lowerbound")) {
+                info.bound = UCI_BOUND_LOWER;
+            } else if (haveToken && token.is("upperbound")) {
+                info.bound = UCI_BOUND_UPPER;
+            } else {
+                continue; // not a bound: handle it as the next keyword
+            }
+        } else if (token.is("pv")) {
+            // Moves run until the first token that is not one (normally the end)
+            info.fields |= UCI_INFO_PV;
+            while ((haveToken = tokens.next(token))) {
+                Move m = parseUciMoveText(token.text, token.length);
+                if (m == MOVE_NONE) break;
+                if (info.pvLength < UCI_MAX_PV) info.pv[info.pvLength++] = m;
+            }
+            continue;
+        }
+        haveToken = tokens.next(token);
+    }
+    return true;
+}
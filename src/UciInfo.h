@@ -0,0 +1,60 @@
+#ifndef UCI_INFO_H
+#define UCI_INFO_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Move.h"
+
+// Longest PV kept from one info line; the rest of a longer PV is dropped
+const int UCI_MAX_PV = 128;
+
+enum UciBound : uint8_t {
+    UCI_BOUND_EXACT = 0,
+    UCI_BOUND_LOWER = 1,   // "lowerbound": the score is at least this
+    UCI_BOUND_UPPER = 2    // "upperbound": the score is at most this
+};
+
+// Bits of UciInfo::fields, one per field the line contained
+enum UciInfoField : uint32_t {
+    UCI_INFO_DEPTH    = 1 << 0,
+    UCI_INFO_SELDEPTH = 1 << 1,
+    UCI_INFO_MULTIPV  = 1 << 2,
+    UCI_INFO_SCORE    = 1 << 3,
+    UCI_INFO_NODES    = 1 << 4,
+    UCI_INFO_NPS      = 1 << 5,
+    UCI_INFO_HASHFULL = 1 << 6,
+    UCI_INFO_TBHITS   = 1 << 7,
+    UCI_INFO_TIME     = 1 << 8,
+    UCI_INFO_PV       = 1 << 9
+};
+
+// One parsed "info" line. Fixed size and trivially copyable, so parsing into
+// it never allocates. Fields not present keep their defaults (0, multipv 1).
+struct UciInfo {
+    uint32_t fields;
+    int depth;
+    int seldepth;
+    int multipv;
+    int score;          // centipawns, or moves to mate when isMate (negative: being mated)
+    bool isMate;
+    UciBound bound;
+    int hashfull;       // permille
+    uint64_t nodes;
+    uint64_t nps;
+    uint64_t tbhits;
+    uint64_t timeMs;
+    int pvLength;
+    Move pv[UCI_MAX_PV]; // castling and en passant come back as MOVE_NORMAL; no position is known here
+
+    bool has(UciInfoField field) const { return (fields & field) != 0; }
+};
+
+// Parses "info ..." from [text, text + length) without copying or allocating.
+// Returns false if the text is not an info line or is an "info string".
+// Unknown keywords (wdl, currmove, ...) are skipped.
+bool parseUciInfo(const char* text, size_t length, UciInfo& info);
+
+// "e2e4" / "e7e8q" to a Move without position context; MOVE_NONE if malformed
+Move parseUciMoveText(const char* text, size_t length);
+
+#endif // UCI_INFO_H
@@ -54,6 +54,12 @@ void UserDB::removeFromReview(const std::string& id) {
     if (it != reviewQueue.end()) reviewQueue.erase(it, reviewQueue.end());
 }
 
+void UserDB::setAnalysisBudget(int depth, int movetimeMs, long long nodes) {
+    analysisDepth = std::max(0, depth);
+    analysisMovetimeMs = std::max(0, movetimeMs);
+    analysisNodes = std::max(0LL, nodes);
+}
+
 void UserDB::adjustRating(int delta) {
     rating += delta; if (rating < 400) rating = 400;
     writeSettingsSQLite();
@@ -111,11 +117,31 @@ void UserDB::readSettingsSQLite() {
     std::string r = selectSetting("rating");
     if (!r.empty()) try { rating = std::stoi(r); } catch (...) {}
     csvPath = selectSetting("csv");
+    std::string v = selectSetting("analysis_infinite");
+    if (!v.empty()) analysisInfinite = v != "0";
+    v = selectSetting("analysis_depth");
+    if (!v.empty()) try { analysisDepth = std::stoi(v); } catch (...) {}
+    v = selectSetting("analysis_movetime");
+    if (!v.empty()) try { analysisMovetimeMs = std::stoi(v); } catch (...) {}
+    v = selectSetting("analysis_nodes");
+    if (!v.empty()) try { analysisNodes = std::stoll(v); } catch (...) {}
+    puzzleFilter = selectSetting("puzzle_filter");
+    v = selectSetting("puzzle_prefetch");
+    if (!v.empty()) try { setPuzzlePrefetch(std::stoi(v)); } catch (...) {}
+    v = selectSetting("engine_hash");
+    if (!v.empty()) try { setEngineHash(std::stoi(v)); } catch (...) {}
 }
 
 void UserDB::writeSettingsSQLite() const {
     upsertSetting("rating", std::to_string(rating));
     upsertSetting("csv", csvPath);
+    upsertSetting("analysis_infinite", analysisInfinite ? "1" : "0");
+    upsertSetting("analysis_depth", std::to_string(analysisDepth));
+    upsertSetting("analysis_movetime", std::to_string(analysisMovetimeMs));
+    upsertSetting("analysis_nodes", std::to_string(analysisNodes));
+    upsertSetting("puzzle_filter", puzzleFilter);
+    upsertSetting("puzzle_prefetch", std::to_string(puzzlePrefetch));
+    upsertSetting("engine_hash", std::to_string(engineHash));
 }
 
 void UserDB::readReviewQueueSQLite() {
@@ -25,6 +25,27 @@ public:
     void setLastCsvPath(const std::string& p) { csvPath = p; }
     bool isSQLiteEnabled() const { return true; }
 
+    // Live analysis budget. Infinite analysis runs until the position
+    // changes; otherwise the search stops at the first limit set (0 = unset).
+    bool getAnalysisInfinite() const { return analysisInfinite; }
+    void setAnalysisInfinite(bool on) { analysisInfinite = on; }
+    int getAnalysisDepth() const { return analysisDepth; }
+    int getAnalysisMovetime() const { return analysisMovetimeMs; }
+    long long getAnalysisNodes() const { return analysisNodes; }
+    void setAnalysisBudget(int depth, int movetimeMs, long long nodes);
+
+    // Puzzle filter text, e.g. "fork + endgame, 1600-1800" (see PuzzleFilter)
+    const std::string& getPuzzleFilter() const { return puzzleFilter; }
+    void setPuzzleFilter(const std::string& f) { puzzleFilter = f; }
+
+    // Puzzles read and set up ahead of time in the background; 0 turns it off
+    int getPuzzlePrefetch() const { return puzzlePrefetch; }
+    void setPuzzlePrefetch(int depth) { puzzlePrefetch = depth < 0 ? 0 : depth; }
+
+    // Transposition table of the analysis and play engines, in MB
+    int getEngineHash() const { return engineHash; }
+    void setEngineHash(int megabytes) { engineHash = megabytes < 1 ? 1 : megabytes; }
+
     // Review queue API
     const std::vector<std::string>& getReviewQueue() const { return reviewQueue; }
     void pushReview(const std::string& id);
@@ -35,6 +56,13 @@ private:
     std::string dbPath;
     int rating = 1500;
     std::string csvPath;
+    bool analysisInfinite = true;
+    int analysisDepth = 15;
+    int analysisMovetimeMs = 0;
+    long long analysisNodes = 0;
+    std::string puzzleFilter;
+    int puzzlePrefetch = 2;
+    int engineHash = 64;
     std::vector<std::string> reviewQueue;
 
     // SQLite internals
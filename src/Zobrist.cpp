@@ -0,0 +1,47 @@
+#include "Zobrist.h"
+
+namespace Zobrist {
+
+uint64_t PieceSquare[2][6][64];
+uint64_t Castling[16];
+uint64_t EnPassantFile[8];
+uint64_t SideToMove;
+
+// xorshift64*: small, fast and good enough for hash keys
+static uint64_t nextRandom(uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+static void fillTables() {
+    uint64_t state = 1070372ULL;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            for (int sq = 0; sq < 64; ++sq) PieceSquare[c][t][sq] = nextRandom(state);
+        }
+    }
+
+    // One key per single right; combined rights xor their parts so that
+    // clearing one right is a single xor of its own key
+    uint64_t rightKeys[4];
+    for (int i = 0; i < 4; ++i) rightKeys[i] = nextRandom(state);
+    for (int rights = 0; rights < 16; ++rights) {
+        Castling[rights] = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (rights & (1 << i)) Castling[rights] ^= rightKeys[i];
+        }
+    }
+
+    for (int f = 0; f < 8; ++f) EnPassantFile[f] = nextRandom(state);
+    SideToMove = nextRandom(state);
+}
+
+void init() {
+    // Once only, whichever thread builds the first Position
+    static const bool filled = (fillTables(), true);
+    (void)filled;
+}
+
+} // namespace Zobrist
@@ -0,0 +1,20 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Zobrist keys. The tables come from a fixed-seed generator, so a position
+// hashes to the same 64-bit value in every run (safe to persist).
+namespace Zobrist {
+
+extern uint64_t PieceSquare[2][6][64]; // [color][piece type][square]
+extern uint64_t Castling[16];          // indexed by CastlingRight bitmask
+extern uint64_t EnPassantFile[8];
+extern uint64_t SideToMove;            // xored in when black is to move
+
+// Fills the tables; safe to call more than once, from any thread
+void init();
+
+} // namespace Zobrist
+
+#endif // ZOBRIST_H
@@ -0,0 +1,62 @@
+// Built-in engine benchmark: fixed-depth searches over a few positions,
+// reporting nodes and nodes/second (all threads combined).
+//
+//   bench [depth] [threads]        defaults: depth 8, 1 thread
+//
+// The single-core target documented in SearchEngine.h is measured with the
+// defaults.
+#include "../src/SearchEngine.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+const char* BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP2BPPP/R2QKB1R w KQ - 0 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = argc > 1 ? std::atoi(argv[1]) : 8;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+    if (depth < 1 || threads < 1) {
+        std::cerr << "usage: bench [depth] [threads]" << std::endl;
+        return 2;
+    }
+
+    SearchEngine engine;
+    engine.setThreads(threads);
+    engine.initialize();
+
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+    for (const char* fen : BENCH_POSITIONS) {
+        engine.setHashSize(16); // fresh table per position
+        engine.sendPosition(fen);
+        auto start = std::chrono::steady_clock::now();
+        engine.startAnalysis(depth, 1);
+        engine.waitForSearch();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t nodes = engine.getNodesSearched();
+        totalNodes += nodes;
+        totalSeconds += seconds;
+        auto lines = engine.getBestLines(1);
+        std::cout << fen << "\n    bestmove " << (lines.empty() ? "(none)" : lines[0].move)
+                  << "  score " << (lines.empty() ? 0 : lines[0].score)
+                  << "  nodes " << nodes << "  " << static_cast<int>(seconds * 1000.0) << " ms" << std::endl;
+    }
+
+    std::cout << "Total nodes: " << totalNodes << "  Time: " << static_cast<int>(totalSeconds * 1000.0) << " ms";
+    if (totalSeconds > 0.0) std::cout << "  NPS: " << static_cast<uint64_t>(totalNodes / totalSeconds);
+    std::cout << "  (" << threads << " thread" << (threads == 1 ? "" : "s") << ", depth " << depth << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+// CSV scanner throughput: splits a whole puzzle CSV (the full Lichess dump
+// is about 1 GB) into fields with every CsvScanner kernel this CPU runs, and
+// with the byte-at-a-time splitter the scanner replaced, and reports GB/s.
+// The kernels must agree on every field, which the checksums show.
+//
+//   csvbench <puzzles.csv> [passes]     default: 5 passes, best one reported
+//
+// The file is read through once before timing, so the numbers are for the
+// page cache rather than the disk.
+#include "../src/CsvScanner.h"
+#include "../src/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// What was seen, folded into numbers that differ if any field does
+struct Tally {
+    uint64_t rows = 0;
+    uint64_t fields = 0;
+    uint64_t checksum = 0;
+
+    void field(const char* data, size_t length) {
+        fields++;
+        checksum = checksum * 31 + length;
+        if (length) checksum += static_cast<unsigned char>(data[0]) + static_cast<unsigned char>(data[length - 1]);
+    }
+    void row(size_t begin, size_t end) {
+        rows++;
+        checksum ^= end - begin;
+    }
+};
+
+// The previous splitter: find each newline, then walk the line byte by byte
+// tracking quotes, as PuzzleStore::split and the index builder did
+void scanBytewise(const char* data, size_t size, Tally& tally) {
+    size_t rowBegin = 0;
+    while (rowBegin < size) {
+        const char* next = static_cast<const char*>(std::memchr(data + rowBegin, '\n', size - rowBegin));
+        size_t at = next ? static_cast<size_t>(next - data) : size;
+        size_t rowEnd = at;
+        if (rowEnd > rowBegin && data[rowEnd - 1] == '\r') rowEnd--;
+        const char* line = data + rowBegin;
+        size_t length = rowEnd - rowBegin;
+        size_t begin = 0;
+        bool inQuotes = false;
+        for (size_t i = 0; i <= length; ++i) {
+            if (i < length && line[i] == '"') {
+                inQuotes = !inQuotes;
+            } else if (i == length || (line[i] == ',' && !inQuotes)) {
+                size_t end = i;
+                if (end - begin >= 2 && line[begin] == '"' && line[end - 1] == '"') {
+                    begin++;
+                    end--;
+                }
+                tally.field(line + begin, end - begin);
+                begin = i + 1;
+            }
+        }
+        tally.row(rowBegin, rowEnd);
+        rowBegin = at + 1;
+    }
+}
+
+void report(const char* name, double seconds, size_t bytes, const Tally& tally) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << bytes / seconds / 1e9 << " GB/s" << std::setw(10) << std::setprecision(1)
+              << seconds * 1000 << " ms" << std::setw(12) << tally.rows << " rows" << std::setw(12) << tally.fields
+              << " fields  checksum " << std::hex << tally.checksum << std::dec << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: csvbench <puzzles.csv> [passes]" << std::endl;
+        return 2;
+    }
+    int passes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    MappedFile file;
+    if (!file.open(argv[1])) {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    const char* data = file.data();
+    size_t size = file.size();
+    volatile unsigned char touch = 0;
+    for (size_t i = 0; i < size; i += 4096) touch = touch + static_cast<unsigned char>(data[i]);
+    std::cout << argv[1] << ": " << size / 1e6 << " MB, best of " << passes
+              << " passes, detected kernel " << CsvScanner::name(CsvScanner::best()) << std::endl;
+
+    double best = 1e30;
+    Tally reference;
+    for (int p = 0; p < passes; ++p) {
+        Tally tally;
+        Clock::time_point start = Clock::now();
+        scanBytewise(data, size, tally);
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        reference = tally;
+    }
+    report("bytewise", best, size, reference);
+
+    int mismatches = 0;
+    for (int k = 0; k < CSV_KERNEL_COUNT; ++k) {
+        CsvKernel kernel = static_cast<CsvKernel>(k);
+        if (!CsvScanner::supported(kernel)) {
+            std::cout << std::left << std::setw(10) << CsvScanner::name(kernel) << "not supported here" << std::endl;
+            continue;
+        }
+        CsvScanner scanner(kernel);
+        best = 1e30;
+        Tally last;
+        for (int p = 0; p < passes; ++p) {
+            Tally tally;
+            Clock::time_point start = Clock::now();
+            scanner.scan(data, size, tally);
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+            last = tally;
+        }
+        report(CsvScanner::name(kernel), best, size, last);
+        if (last.rows != reference.rows || last.fields != reference.fields || last.checksum != reference.checksum) {
+            mismatches++;
+        }
+    }
+    if (mismatches) {
+        std::cout << mismatches << " kernel(s) disagree with the bytewise splitter" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+// StockfishEngine against tools/mockuci: what the pipe, the output reader and
+// the info parser cost on top of the engine, with the engine's own search
+// taken out of the picture.
+//
+//   enginebench [--mock PATH] [--searches N]     defaults: build/bin/mockuci, 20
+//
+// Each scenario starts a fresh engine with the mock configured through its
+// MOCKUCI_* environment and runs the searches one after another. Reported:
+//   init       initialize() time, the uci/isready handshake
+//   lines/s    engine lines through the reader per second of search
+//   lines      engine lines read per search
+//   parse      mean time of parseUciInfo per line
+//   batch      most lines the reader took in one wake-up
+//   latency    mock writing bestmove -> waitForSearch returning (mean / max);
+//              for "stop", stopAnalysis() -> waitForSearch returning
+//   ok         searches whose final lines and bestmove came through intact
+#include "../src/EngineLog.h"
+#include "../src/StockfishEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char* const START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const char* const SENT_PREFIX = "info string mockuci sent ";
+
+struct Scenario {
+    const char* name;
+    int startupMs;
+    int rate;           // lines/s, 0: unthrottled
+    int burst;
+    int depth;
+    int multiPV;
+    int pvLength;
+    int malformedEvery;
+    int stopAfterMs;    // > 0: infinite search stopped after this long
+};
+
+// name, startup, rate, burst, depth, multipv, pv, malformed, stop
+const Scenario SCENARIOS[] = {
+    { "slow start",   500,    0,   1,   10, 1, 16, 0,   0 },
+    { "burst",          0,    0,   1,  250, 8, 24, 0,   0 },
+    { "paced",          0, 4000,   1,   50, 4, 24, 0,   0 },
+    { "bursty",         0, 4000, 200,   50, 4, 24, 0,   0 },
+    { "malformed",      0,    0,   1,  100, 4, 24, 3,   0 },
+    { "stop",           0, 2000,   1, 1000, 2, 24, 0, 100 },
+};
+
+void configureMock(const Scenario& s) {
+    setenv("MOCKUCI_STARTUP_MS", std::to_string(s.startupMs).c_str(), 1);
+    setenv("MOCKUCI_RATE", std::to_string(s.rate).c_str(), 1);
+    setenv("MOCKUCI_BURST", std::to_string(s.burst).c_str(), 1);
+    setenv("MOCKUCI_DEPTH", std::to_string(s.depth).c_str(), 1);
+    setenv("MOCKUCI_PV", std::to_string(s.pvLength).c_str(), 1);
+    setenv("MOCKUCI_MALFORMED", std::to_string(s.malformedEvery).c_str(), 1);
+    unsetenv("MOCKUCI_SCRIPT");
+}
+
+// When the mock wrote the last bestmove, from the line it sends just before
+bool lastSentTime(const EngineLog& log, int64_t& sentNs) {
+    std::vector<EngineLogEntry> entries = log.entries();
+    size_t prefix = std::strlen(SENT_PREFIX);
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (it->sent || it->length <= prefix || std::memcmp(it->text, SENT_PREFIX, prefix) != 0) continue;
+        sentNs = std::strtoll(std::string(it->text + prefix, it->length - prefix).c_str(), nullptr, 10);
+        return true;
+    }
+    return false;
+}
+
+// What the mock generates for the last depth of a search that ran to the end
+bool intact(const Scenario& s, const SearchResult& result) {
+    if (s.stopAfterMs > 0) return result.stopped && !result.bestMove.empty();
+    if (result.lines.size() != static_cast<size_t>(s.multiPV)) return false;
+    for (const EngineLine& line : result.lines) {
+        if (line.depth != s.depth || line.pv.size() != static_cast<size_t>(s.pvLength)) return false;
+    }
+    return result.bestMove == "e2e4" && result.ponderMove == "e7e5" && result.lines[0].move == "e2e4";
+}
+
+// One row of the table
+std::string runScenario(const Scenario& s, const std::string& mockPath, int searches) {
+    char row[256];
+    configureMock(s);
+    StockfishEngine engine;
+    Clock::time_point initStart = Clock::now();
+    if (!engine.initialize(mockPath)) {
+        std::snprintf(row, sizeof(row), "%-10s could not start %s", s.name, mockPath.c_str());
+        return row;
+    }
+    double initMs = std::chrono::duration<double, std::milli>(Clock::now() - initStart).count();
+    const EngineLog& log = *engine.getLog();
+
+    SearchLimits limits;
+    if (s.stopAfterMs > 0) limits.infinite = true;
+    else limits.depth = s.depth;
+
+    uint64_t linesBefore = log.metrics().linesReceived;
+    double searchMs = 0.0;
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+    int ok = 0;
+    int timedOut = 0;
+    for (int i = 0; i < searches; ++i) {
+        // The callback runs on the reader thread before waitForSearch wakes,
+        // which orders this write before the read below
+        SearchResult result;
+        engine.sendPosition(START_FEN);
+        Clock::time_point go = Clock::now();
+        engine.startSearch(limits, s.multiPV, [&result](const SearchResult& r) { result = r; });
+
+        Clock::time_point stopAt;
+        if (s.stopAfterMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(s.stopAfterMs));
+            stopAt = Clock::now();
+            engine.stopAnalysis();
+        }
+        if (!engine.waitForSearch(10000)) {
+            timedOut++;
+            engine.stopAnalysis();
+            engine.waitForSearch(1000);
+            continue;
+        }
+        Clock::time_point done = Clock::now();
+        searchMs += std::chrono::duration<double, std::milli>(done - go).count();
+
+        double latencyUs = -1.0;
+        int64_t sentNs = 0;
+        if (s.stopAfterMs > 0) {
+            latencyUs = std::chrono::duration<double, std::micro>(done - stopAt).count();
+        } else if (lastSentTime(log, sentNs)) {
+            int64_t doneNs = std::chrono::duration_cast<std::chrono::nanoseconds>(done.time_since_epoch()).count();
+            latencyUs = (doneNs - sentNs) / 1000.0;
+        }
+        if (latencyUs >= 0.0) {
+            latencySum += latencyUs;
+            latencyMax = std::max(latencyMax, latencyUs);
+        }
+        if (intact(s, result)) ok++;
+    }
+
+    EngineMetrics m = log.metrics();
+    int completed = searches - timedOut;
+    uint64_t lines = m.linesReceived - linesBefore;
+    int n = std::snprintf(row, sizeof(row), "%-10s %7.1f %8.0f %10.0f %8.3f %6zu %9.0f %8.0f %5d/%d",
+                s.name, initMs, completed ? static_cast<double>(lines) / completed : 0.0,
+                searchMs > 0.0 ? lines * 1000.0 / searchMs : 0.0, m.parseUsPerLine, m.maxBatchLines,
+                completed ? latencySum / completed : 0.0, latencyMax, ok, searches);
+    if (timedOut && n > 0 && static_cast<size_t>(n) < sizeof(row)) {
+        std::snprintf(row + n, sizeof(row) - n, "  (%d timed out)", timedOut);
+    }
+    engine.shutdown();
+    return row;
+}
+
+int usage() {
+    std::cerr << "usage: enginebench [--mock PATH] [--searches N]" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string mockPath = "build/bin/mockuci";
+    int searches = 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mock" && i + 1 < argc) mockPath = argv[++i];
+        else if (arg == "--searches" && i + 1 < argc) searches = std::max(1, std::atoi(argv[++i]));
+        else return usage();
+    }
+
+    // StockfishEngine narrates start-up on stdout; the table goes to stdout too,
+    // so collect the rows and print them once every engine is done
+    std::vector<std::string> rows;
+    for (const Scenario& s : SCENARIOS) rows.push_back(runScenario(s, mockPath, searches));
+
+    std::printf("\n%-10s %7s %8s %10s %8s %6s %9s %8s %7s\n", "scenario", "init ms", "lines", "lines/s",
+                "parse us", "batch", "lat us", "max us", "ok");
+    for (const std::string& row : rows) std::printf("%s\n", row.c_str());
+    return 0;
+}
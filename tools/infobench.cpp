@@ -0,0 +1,158 @@
+// UCI info line parser benchmark: parses a corpus of Stockfish-style info
+// lines with deep PVs, with parseUciInfo and with the std::istringstream
+// parser it replaced, and reports lines/second for both.
+//
+//   infobench [lines] [passes]     defaults: 2000 lines, 200 passes
+//
+// An engine at high depth with MultiPV emits a few hundred such lines per
+// second; the parser has to stay far below a millisecond per line.
+#include "../src/Position.h"
+#include "../src/UciInfo.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint64_t rngState = 0x9E3779B97F4A7C15ULL;
+
+uint64_t nextRandom() {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 2685821657736338717ULL;
+}
+
+// A line like Stockfish's, with a legal PV played out from the start position
+std::string makeInfoLine(int depth, int multipv) {
+    Position pos;
+    pos.setStartPosition();
+    int pvLength = depth + static_cast<int>(nextRandom() % 12);
+    std::string pv;
+    for (int i = 0; i < pvLength; ++i) {
+        MoveList moves;
+        pos.generateLegalMoves(moves);
+        if (moves.empty()) break;
+        Move m = moves[static_cast<int>(nextRandom() % moves.size())];
+        pv += ' ';
+        pv += moveToUCI(m);
+        pos.makeMove(m);
+    }
+
+    std::ostringstream line;
+    line << "info depth " << depth << " seldepth " << depth + 8 << " multipv " << multipv;
+    if (nextRandom() % 20 == 0) {
+        line << " score mate " << static_cast<int>(nextRandom() % 15) - 7;
+    } else {
+        line << " score cp " << static_cast<int>(nextRandom() % 600) - 300;
+        if (nextRandom() % 10 == 0) line << " lowerbound";
+    }
+    line << " wdl 310 620 70 nodes " << nextRandom() % 100000000 << " nps " << 1000000 + nextRandom() % 2000000
+         << " hashfull " << nextRandom() % 1000 << " tbhits 0 time " << nextRandom() % 60000 << " pv" << pv;
+    return line.str();
+}
+
+// The previous parser, for comparison
+struct OldLine {
+    std::string move;
+    std::vector<std::string> pv;
+    int score;
+    int depth;
+    int mate;
+};
+
+bool parseWithStream(const std::string& text, OldLine& line) {
+    line = OldLine();
+    std::istringstream iss(text);
+    std::string token;
+    bool readingPV = false;
+    while (iss >> token) {
+        if (readingPV) {
+            line.pv.push_back(token);
+            if (line.move.empty()) line.move = token;
+        } else if (token == "depth") {
+            iss >> line.depth;
+        } else if (token == "score") {
+            iss >> token;
+            if (token == "cp") {
+                iss >> line.score;
+            } else if (token == "mate") {
+                iss >> line.mate;
+                line.score = line.mate > 0 ? 10000 : -10000;
+            }
+        } else if (token == "pv") {
+            readingPV = true;
+        }
+    }
+    return !line.move.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int lineCount = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int passes = argc > 2 ? std::atoi(argv[2]) : 200;
+    if (lineCount < 1 || passes < 1) {
+        std::cerr << "usage: infobench [lines] [passes]" << std::endl;
+        return 2;
+    }
+
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    for (int i = 0; i < lineCount; ++i) {
+        lines.push_back(makeInfoLine(20 + i % 40, 1 + i % 3));
+        bytes += lines.back().size();
+    }
+    std::cout << lineCount << " lines, " << bytes / lineCount << " bytes/line on average" << std::endl;
+
+    // The new parser must agree with the old one before its speed matters
+    for (const std::string& text : lines) {
+        UciInfo info;
+        OldLine old;
+        bool parsed = parseUciInfo(text.data(), text.size(), info);
+        parseWithStream(text, old);
+        bool same = parsed && info.depth == old.depth && info.pvLength == static_cast<int>(old.pv.size())
+                    && (info.isMate ? info.score == old.mate : info.score == old.score);
+        for (int i = 0; same && i < info.pvLength; ++i) same = moveToUCI(info.pv[i]) == old.pv[i];
+        if (!same) {
+            std::cerr << "mismatch on: " << text << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t checksum = 0;
+    UciInfo info;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const std::string& text : lines) {
+            if (parseUciInfo(text.data(), text.size(), info)) checksum += info.pv[info.pvLength - 1] + info.nodes;
+        }
+    }
+    double newSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The stream parser is much slower; a tenth of the passes is enough
+    int oldPasses = passes / 10 > 0 ? passes / 10 : 1;
+    OldLine old;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < oldPasses; ++pass) {
+        for (const std::string& text : lines) {
+            if (parseWithStream(text, old)) checksum += old.pv.size();
+        }
+    }
+    double oldSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double parsedNew = static_cast<double>(lineCount) * passes;
+    double parsedOld = static_cast<double>(lineCount) * oldPasses;
+    std::cout << "parseUciInfo:       " << static_cast<uint64_t>(parsedNew / newSeconds) << " lines/s, "
+              << static_cast<uint64_t>(newSeconds * 1e9 / parsedNew) << " ns/line, "
+              << static_cast<uint64_t>(bytes * static_cast<double>(passes) / newSeconds / 1e6) << " MB/s" << std::endl;
+    std::cout << "std::istringstream: " << static_cast<uint64_t>(parsedOld / oldSeconds) << " lines/s, "
+              << static_cast<uint64_t>(oldSeconds * 1e9 / parsedOld) << " ns/line" << std::endl;
+    std::cout << "speedup: " << (oldSeconds / parsedOld) / (newSeconds / parsedNew) << "x"
+              << " (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,468 @@
+// Scripted stand-in for a UCI engine, so StockfishEngine's pipe, reader and
+// info parser can be exercised and timed without a real engine's search in
+// the way. Each "go" replays a stream of info lines - generated, or read from
+// a script - at a set rate, then answers bestmove.
+//
+//   mockuci [--startup-ms MS] [--rate LINES] [--burst N] [--depth N] [--pv N]
+//           [--malformed K] [--script FILE]
+//
+//   --startup-ms   delay before answering "uci" (default 0)
+//   --rate         info lines per second; 0 writes as fast as the pipe takes them
+//   --burst        lines written together at each tick of the rate (default 1)
+//   --depth        deepest depth generated; "go depth N" lowers it (default 20)
+//   --pv           moves per generated PV (default 16)
+//   --malformed    a malformed line before every K-th good one (default 0: none)
+//   --script       replay the lines of FILE instead; a "bestmove" line ends it
+//
+// StockfishEngine starts engines without arguments, so every option can also
+// be set in the environment as MOCKUCI_STARTUP_MS, MOCKUCI_RATE, ... ; flags
+// win over the environment.
+//
+// Generated lines follow setoption MultiPV and "go searchmoves". Just before
+// its bestmove the mock writes "info string mockuci sent <ns>", the
+// steady_clock time of that write, so the other side can measure how long
+// the bestmove took to reach it. "go infinite" holds the bestmove until
+// "stop"; "go ponder" until "stop" or "ponderhit".
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    int startupMs = 0;
+    double rate = 0.0;
+    int burst = 1;
+    int depth = 20;
+    int pvLength = 16;
+    int malformedEvery = 0;
+    std::string script;
+};
+
+// A Ruy Lopez main line, so PVs look like chess; nothing here checks legality
+const char* const PV_MOVES[] = {
+    "e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6", "e1g1", "f8e7",
+    "f1e1", "b7b5", "a4b3", "d7d6", "c2c3", "e8g8", "h2h3", "c6a5", "b3c2", "c7c5",
+    "d2d4", "d8c7", "b1d2", "c5d4", "c3d4", "a5c6", "d2b3", "a6a5", "c1e3", "a5a4"
+};
+const int PV_MOVE_COUNT = sizeof(PV_MOVES) / sizeof(PV_MOVES[0]);
+
+// First moves for MultiPV lines after the first
+const char* const ROOT_MOVES[] = {
+    "e2e4", "d2d4", "g1f3", "c2c4", "e2e3", "g2g3", "b2b3", "c2c3", "b1c3", "d2d3", "f2f4", "h2h3"
+};
+const int ROOT_MOVE_COUNT = sizeof(ROOT_MOVES) / sizeof(ROOT_MOVES[0]);
+
+// Commands from stdin, read without blocking so a search can watch for "stop"
+class Input {
+public:
+    // Next complete line; waits up to waitMs for one (-1: no limit).
+    // False on timeout or once stdin is closed
+    bool next(std::string& line, int waitMs) {
+        for (;;) {
+            size_t end = buffer.find('\n');
+            if (end != std::string::npos) {
+                line.assign(buffer, 0, end);
+                if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+                buffer.erase(0, end + 1);
+                return true;
+            }
+            if (eof) return false;
+
+            pollfd pfd;
+            pfd.fd = STDIN_FILENO;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, waitMs) <= 0) return false;
+            char chunk[4096];
+            ssize_t n = read(STDIN_FILENO, chunk, sizeof(chunk));
+            if (n <= 0) {
+                eof = true;
+                return false;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+            // Part of a line came in: a timed wait does not start over
+            if (waitMs > 0) waitMs = 0;
+        }
+    }
+
+    bool closed() const { return eof && buffer.find('\n') == std::string::npos; }
+
+private:
+    std::string buffer;
+    bool eof = false;
+};
+
+// stdout, collected and written in whole bursts so the reader sees the same
+// chunks a real engine would produce
+class Output {
+public:
+    void line(const std::string& text) {
+        buffer += text;
+        buffer += '\n';
+    }
+
+    void append(const std::string& text) { buffer += text; }
+
+    size_t size() const { return buffer.size(); }
+
+    void flush() {
+        size_t done = 0;
+        while (done < buffer.size()) {
+            ssize_t n = write(STDOUT_FILENO, buffer.data() + done, buffer.size() - done);
+            // The other end went away; nobody is left to talk to
+            if (n <= 0) std::exit(0);
+            done += static_cast<size_t>(n);
+        }
+        buffer.clear();
+    }
+
+private:
+    std::string buffer;
+};
+
+struct StreamLine {
+    std::string text;
+    bool torn;                  // written in two halves with a flush between
+};
+
+struct Search {
+    bool active = false;
+    bool infinite = false;      // bestmove waits for "stop"
+    bool ponder = false;        // bestmove waits for "stop" or "ponderhit"
+    bool hasDeadline = false;
+    Clock::time_point start;
+    Clock::time_point deadline; // "go movetime"
+    std::vector<StreamLine> lines;
+    size_t next = 0;            // first line not yet written
+    std::string bestMove;
+    std::string ponderMove;
+};
+
+int intOption(const char* text, int fallback) {
+    return text && *text ? std::atoi(text) : fallback;
+}
+
+void readEnvironment(Options& options) {
+    options.startupMs = intOption(std::getenv("MOCKUCI_STARTUP_MS"), options.startupMs);
+    const char* rate = std::getenv("MOCKUCI_RATE");
+    if (rate && *rate) options.rate = std::atof(rate);
+    options.burst = intOption(std::getenv("MOCKUCI_BURST"), options.burst);
+    options.depth = intOption(std::getenv("MOCKUCI_DEPTH"), options.depth);
+    options.pvLength = intOption(std::getenv("MOCKUCI_PV"), options.pvLength);
+    options.malformedEvery = intOption(std::getenv("MOCKUCI_MALFORMED"), options.malformedEvery);
+    const char* script = std::getenv("MOCKUCI_SCRIPT");
+    if (script) options.script = script;
+}
+
+bool readArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--startup-ms") options.startupMs = std::atoi(value);
+        else if (arg == "--rate") options.rate = std::atof(value);
+        else if (arg == "--burst") options.burst = std::atoi(value);
+        else if (arg == "--depth") options.depth = std::atoi(value);
+        else if (arg == "--pv") options.pvLength = std::atoi(value);
+        else if (arg == "--malformed") options.malformedEvery = std::atoi(value);
+        else if (arg == "--script") options.script = value;
+        else return false;
+    }
+    return true;
+}
+
+// Planned time of line `index` after go, in us
+int64_t plannedUs(const Options& options, size_t index) {
+    if (options.rate <= 0.0) return 0;
+    size_t tick = index / static_cast<size_t>(options.burst);
+    return static_cast<int64_t>(tick * options.burst * 1e6 / options.rate);
+}
+
+std::string makeInfoLine(const Options& options, int depth, int multipv, int64_t timeMs,
+                         const std::vector<std::string>& searchMoves) {
+    std::ostringstream line;
+    uint64_t nodes = 2000ULL * depth * depth * depth + 137ULL * multipv;
+    line << "info depth " << depth << " seldepth " << depth + 6 << " multipv " << multipv
+         << " score cp " << 31 - 17 * (multipv - 1) + depth % 5
+         << " nodes " << nodes << " nps 1500000 hashfull " << (depth * 37) % 1000
+         << " tbhits 0 time " << timeMs << " pv";
+    for (int i = 0; i < options.pvLength; ++i) {
+        std::string move;
+        if (i == 0 && !searchMoves.empty()) move = searchMoves[(multipv - 1) % searchMoves.size()];
+        else if (i == 0 && multipv > 1) move = ROOT_MOVES[(multipv - 1) % ROOT_MOVE_COUNT];
+        else move = PV_MOVES[i % PV_MOVE_COUNT];
+        line << ' ' << move;
+    }
+    return line.str();
+}
+
+// The kinds of bad output engines and pipes have been seen to produce,
+// in turn. Each stands before the good line `next`, which overwrites
+// whatever the parser made of it.
+StreamLine makeMalformedLine(int kind, const StreamLine& next) {
+    StreamLine bad;
+    bad.torn = false;
+    size_t multipvAt = next.text.find(" multipv ");
+    std::string multipv = multipvAt == std::string::npos ? "1"
+        : next.text.substr(multipvAt + 9, next.text.find(' ', multipvAt + 9) - multipvAt - 9);
+    switch (kind % 8) {
+    case 0:  // cut off mid-token
+        bad.text = next.text.substr(0, next.text.size() / 2 + 1);
+        break;
+    case 1:  // empty
+        break;
+    case 2:  // keyword without a value
+        bad.text = "info depth";
+        break;
+    case 3:  // values that are not numbers
+        bad.text = "info depth 12x seldepth -- multipv " + multipv + " score cp nodes pv";
+        break;
+    case 4:  // chatter without a PV
+        bad.text = "info depth 3 currmove e2e4 currmovenumber 1 wdl 412 401 187";
+        break;
+    case 5:  // a lone carriage return, as from a Windows build
+        bad.text = "\r";
+        break;
+    case 6: {  // PV far past UCI_MAX_PV
+        bad.text = "info depth 1 multipv " + multipv + " score cp 0 pv";
+        for (int i = 0; i < 400; ++i) bad.text += std::string(" ") + PV_MOVES[i % PV_MOVE_COUNT];
+        break;
+    }
+    default:  // not text at all
+        bad.text = "\x01\x7f\xfe\xff info \x80 pv";
+        break;
+    }
+    return bad;
+}
+
+// The whole stream for one search, so the timing loop only writes
+void prepareSearch(const Options& options, int multiPV, int depthLimit,
+                   const std::vector<std::string>& searchMoves, Search& search) {
+    std::vector<StreamLine> good;
+    search.bestMove.clear();
+    search.ponderMove.clear();
+
+    if (!options.script.empty()) {
+        std::ifstream in(options.script);
+        std::string text;
+        while (std::getline(in, text)) {
+            if (!text.empty() && text[text.size() - 1] == '\r') text.erase(text.size() - 1);
+            if (text.compare(0, 9, "bestmove ") == 0) {
+                std::istringstream fields(text.substr(9));
+                std::string word;
+                fields >> search.bestMove >> word >> search.ponderMove;
+                if (word != "ponder") search.ponderMove.clear();
+                break;
+            }
+            StreamLine line;
+            line.text = text;
+            line.torn = false;
+            good.push_back(line);
+        }
+        if (search.bestMove.empty()) search.bestMove = PV_MOVES[0];
+    } else {
+        int depth = depthLimit > 0 && depthLimit < options.depth ? depthLimit : options.depth;
+        for (int d = 1; d <= depth; ++d) {
+            for (int pv = 1; pv <= multiPV; ++pv) {
+                StreamLine line;
+                line.text = makeInfoLine(options, d, pv, plannedUs(options, good.size()) / 1000, searchMoves);
+                line.torn = false;
+                good.push_back(line);
+            }
+        }
+        std::string first = makeInfoLine(options, 1, 1, 0, searchMoves);
+        std::istringstream fields(first.substr(first.find(" pv ") + 4));
+        fields >> search.bestMove >> search.ponderMove;
+    }
+
+    search.lines.clear();
+    search.lines.reserve(good.size() * 2);
+    int malformed = 0;
+    for (size_t i = 0; i < good.size(); ++i) {
+        if (options.malformedEvery > 0 && (i + 1) % options.malformedEvery == 0) {
+            // Every other injection tears the good line across two writes instead
+            if (malformed % 2 == 1) good[i].torn = true;
+            else search.lines.push_back(makeMalformedLine(malformed / 2, good[i]));
+            malformed++;
+        }
+        search.lines.push_back(good[i]);
+    }
+    search.next = 0;
+}
+
+void writeStreamLine(const StreamLine& line, Output& out) {
+    if (!line.torn) {
+        out.line(line.text);
+        return;
+    }
+    size_t half = line.text.size() / 2;
+    out.append(line.text.substr(0, half));
+    out.flush();
+    out.line(line.text.substr(half));
+}
+
+// Writes the lines that are due; returns how long until the next one, in ms
+int writeDueLines(const Options& options, Search& search, Output& out) {
+    if (options.rate <= 0.0) {
+        // As fast as the pipe drains, a pipe-sized chunk at a time so
+        // commands are still read between chunks
+        while (search.next < search.lines.size() && out.size() < 64 * 1024) {
+            writeStreamLine(search.lines[search.next++], out);
+        }
+        out.flush();
+        return 0;
+    }
+
+    int64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - search.start).count();
+    while (search.next < search.lines.size() && plannedUs(options, search.next) <= elapsedUs) {
+        writeStreamLine(search.lines[search.next++], out);
+    }
+    out.flush();
+    if (search.next >= search.lines.size()) return 0;
+    int64_t waitUs = plannedUs(options, search.next) - elapsedUs;
+    return waitUs > 0 ? static_cast<int>(waitUs / 1000) : 0;
+}
+
+void finishSearch(Search& search, Output& out) {
+    // Whatever is still queued is dropped, as an engine stops mid-iteration
+    search.active = false;
+    int64_t sentNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    out.line("info string mockuci sent " + std::to_string(sentNs));
+    std::string best = "bestmove " + search.bestMove;
+    if (!search.ponderMove.empty()) best += " ponder " + search.ponderMove;
+    out.line(best);
+    out.flush();
+}
+
+void startSearch(const Options& options, int multiPV, const std::string& command, Search& search) {
+    std::istringstream fields(command);
+    std::string word;
+    fields >> word; // "go"
+    int depthLimit = 0;
+    std::vector<std::string> searchMoves;
+    search.infinite = false;
+    search.ponder = false;
+    search.hasDeadline = false;
+    search.start = Clock::now();
+    while (fields >> word) {
+        if (word == "infinite") search.infinite = true;
+        else if (word == "ponder") search.ponder = true;
+        else if (word == "depth") fields >> depthLimit;
+        else if (word == "movetime") {
+            int ms = 0;
+            fields >> ms;
+            search.hasDeadline = ms > 0;
+            search.deadline = search.start + std::chrono::milliseconds(ms);
+        } else if (word == "searchmoves") {
+            while (fields >> word) searchMoves.push_back(word);
+        }
+    }
+    prepareSearch(options, multiPV, depthLimit, searchMoves, search);
+    search.active = true;
+}
+
+void sendIdentity(Output& out) {
+    out.line("id name mockuci");
+    out.line("id author chess-trainer");
+    out.line("option name Threads type spin default 1 min 1 max 1024");
+    out.line("option name Hash type spin default 16 min 1 max 33554432");
+    out.line("option name MultiPV type spin default 1 min 1 max 256");
+    out.line("option name Skill Level type spin default 20 min 0 max 20");
+    out.line("uciok");
+    out.flush();
+}
+
+int usage() {
+    std::cerr << "usage: mockuci [--startup-ms MS] [--rate LINES] [--burst N] [--depth N] [--pv N]"
+                 " [--malformed K] [--script FILE]" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    readEnvironment(options);
+    if (!readArguments(argc, argv, options)) return usage();
+    if (options.burst < 1) options.burst = 1;
+    if (options.pvLength < 1) options.pvLength = 1;
+
+    // A closed pipe shows up as a failed write, not a signal
+    signal(SIGPIPE, SIG_IGN);
+
+    Input in;
+    Output out;
+    Search search;
+    int multiPV = 1;
+    bool started = false;
+
+    for (;;) {
+        int waitMs = -1;
+        if (search.active) {
+            if (search.hasDeadline && Clock::now() >= search.deadline) {
+                finishSearch(search, out);
+            } else if (search.next < search.lines.size()) {
+                waitMs = writeDueLines(options, search, out);
+                if (search.hasDeadline) {
+                    int64_t left = std::chrono::duration_cast<std::chrono::milliseconds>(search.deadline - Clock::now()).count();
+                    if (left < waitMs) waitMs = left > 0 ? static_cast<int>(left) : 0;
+                }
+            } else if (!search.infinite && !search.ponder) {
+                finishSearch(search, out);
+            } else if (search.hasDeadline) {
+                int64_t left = std::chrono::duration_cast<std::chrono::milliseconds>(search.deadline - Clock::now()).count();
+                waitMs = left > 0 ? static_cast<int>(left) : 0;
+            }
+        }
+
+        std::string command;
+        if (!in.next(command, waitMs)) {
+            if (in.closed()) break;
+            continue;
+        }
+
+        std::istringstream fields(command);
+        std::string word;
+        fields >> word;
+        if (word == "uci") {
+            if (!started && options.startupMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(options.startupMs));
+            }
+            started = true;
+            sendIdentity(out);
+        } else if (word == "isready") {
+            out.line("readyok");
+            out.flush();
+        } else if (word == "setoption") {
+            // setoption name MultiPV value N
+            std::string name, value;
+            fields >> word >> name >> word >> value;
+            if (name == "MultiPV") multiPV = std::max(1, std::atoi(value.c_str()));
+        } else if (word == "go") {
+            if (search.active) finishSearch(search, out);
+            startSearch(options, multiPV, command, search);
+        } else if (word == "stop") {
+            if (search.active) finishSearch(search, out);
+        } else if (word == "ponderhit") {
+            search.ponder = false;
+        } else if (word == "quit") {
+            break;
+        }
+        // position, ucinewgame and anything unknown need no answer
+    }
+    return 0;
+}
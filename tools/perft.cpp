@@ -0,0 +1,155 @@
+// Headless perft: move generator node counts, divide output and nodes/second.
+//
+//   perft <depth> [fen]            total nodes and nodes/second
+//   perft --divide <depth> [fen]   nodes below each root move
+//   perft --suite                  standard positions, exits 1 on any mismatch
+//
+// The FEN may be passed unquoted; remaining arguments are joined with spaces.
+#include "../src/Position.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const PerftCase SUITE[] = {
+    { "start",                 "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609ULL },
+    { "kiwipete",              "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL },
+    { "endgame ep/pins",       "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083ULL },
+    { "promotions/castling",   "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292ULL },
+    { "promotion into check",  "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL },
+    { "middlegame",            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL },
+    { "illegal ep (pin)",      "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ULL },
+    { "illegal ep (diagonal)", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ULL },
+    { "ep gives check",        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ULL },
+    { "short castle check",    "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ULL },
+    { "long castle check",     "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ULL },
+    { "castle rights lost",    "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ULL },
+    { "castling prevented",    "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ULL },
+    { "promote out of check",  "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ULL },
+    { "discovered check",      "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ULL },
+    { "promote to check",      "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ULL },
+    { "underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ULL },
+    { "self stalemate",        "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ULL },
+    { "stalemate/checkmate",   "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ULL },
+    { "double check",          "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ULL },
+};
+
+uint64_t perft(Position& pos, int depth) {
+    MoveList moves;
+    pos.generateLegalMoves(moves);
+    if (depth <= 1) return depth == 1 ? static_cast<uint64_t>(moves.size()) : 1;
+
+    uint64_t nodes = 0;
+    for (Move m : moves) {
+        pos.makeMove(m);
+        nodes += perft(pos, depth - 1);
+        pos.unmakeMove();
+    }
+    return nodes;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printSpeed(uint64_t nodes, double seconds) {
+    std::cout << "Nodes: " << nodes << "  Time: " << static_cast<int>(seconds * 1000.0) << " ms";
+    if (seconds > 0.0) std::cout << "  NPS: " << static_cast<uint64_t>(nodes / seconds);
+    std::cout << std::endl;
+}
+
+int runSuite() {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const PerftCase& c : SUITE) {
+        Position pos;
+        if (!pos.setFEN(c.fen)) {
+            std::cout << "FAIL  " << c.name << ": bad FEN" << std::endl;
+            failures++;
+            continue;
+        }
+        uint64_t nodes = perft(pos, c.depth);
+        totalNodes += nodes;
+        bool ok = nodes == c.nodes;
+        if (!ok) failures++;
+        std::cout << (ok ? "ok    " : "FAIL  ") << c.name << " (depth " << c.depth << "): " << nodes;
+        if (!ok) std::cout << ", expected " << c.nodes;
+        std::cout << std::endl;
+    }
+
+    printSpeed(totalNodes, secondsSince(start));
+    std::cout << (failures ? "Suite FAILED (" + std::to_string(failures) + " mismatches)" : std::string("Suite passed")) << std::endl;
+    return failures ? 1 : 0;
+}
+
+void usage() {
+    std::cerr << "usage: perft <depth> [fen]\n"
+              << "       perft --divide <depth> [fen]\n"
+              << "       perft --suite" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+
+    std::string first = argv[1];
+    if (first == "--suite") return runSuite();
+
+    bool divide = first == "--divide";
+    int argi = divide ? 2 : 1;
+    if (argi >= argc) {
+        usage();
+        return 2;
+    }
+    int depth = std::atoi(argv[argi++]);
+
+    std::string fen;
+    for (; argi < argc; ++argi) {
+        if (!fen.empty()) fen += ' ';
+        fen += argv[argi];
+    }
+    if (fen.empty()) fen = START_FEN;
+
+    Position pos;
+    if (depth < 1 || !pos.setFEN(fen)) {
+        usage();
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    if (divide) {
+        MoveList moves;
+        pos.generateLegalMoves(moves);
+        for (Move m : moves) {
+            pos.makeMove(m);
+            uint64_t count = perft(pos, depth - 1);
+            pos.unmakeMove();
+            std::cout << moveToUCI(m) << ": " << count << std::endl;
+            nodes += count;
+        }
+        std::cout << std::endl;
+    } else {
+        nodes = perft(pos, depth);
+    }
+    printSpeed(nodes, secondsSince(start));
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Converts a Lichess puzzle CSV into the binary pack the game maps directly
+// (see src/PuzzlePack.h), and optionally checks that every puzzle decodes back
+// to what the CSV holds.
+//
+//   puzzlepack <puzzles.csv> [out.pzl] [--verify]
+//
+// The output defaults to the CSV's path with ".csv" replaced by ".pzl".
+#include "../src/PuzzlePack.h"
+#include "../src/PuzzleStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+int usage() {
+    std::cerr << "usage: puzzlepack <puzzles.csv> [out.pzl] [--verify]" << std::endl;
+    return 2;
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double fileMb(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return 0.0;
+    return info.st_size / (1024.0 * 1024.0);
+}
+
+// Themes are stored as a set, so their order and repeats may differ
+std::vector<std::string> themeSet(const std::string& themes) {
+    std::vector<std::string> words;
+    std::istringstream in(themes);
+    std::string word;
+    while (in >> word) words.push_back(word);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+bool samePuzzle(const Puzzle& a, const Puzzle& b) {
+    return a.id == b.id && a.fen == b.fen && a.moves == b.moves && a.rating == b.rating
+        && a.ratingDeviation == b.ratingDeviation && a.popularity == b.popularity && a.nbPlays == b.nbPlays
+        && themeSet(a.themes) == themeSet(b.themes) && a.gameUrl == b.gameUrl && a.openingTags == b.openingTags;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string csvPath;
+    std::string packPath;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--verify") == 0) verify = true;
+        else if (arg[0] != '-' && csvPath.empty()) csvPath = arg;
+        else if (arg[0] != '-' && packPath.empty()) packPath = arg;
+        else return usage();
+    }
+    if (csvPath.empty()) return usage();
+    if (packPath.empty()) {
+        packPath = csvPath;
+        if (packPath.size() > 4 && packPath.compare(packPath.size() - 4, 4, ".csv") == 0) packPath.erase(packPath.size() - 4);
+        packPath += ".pzl";
+    }
+
+    Clock::time_point start = Clock::now();
+    PuzzleStore store;
+    if (!store.open(csvPath)) {
+        std::cerr << "cannot open " << csvPath << std::endl;
+        return 1;
+    }
+    std::cout << "Read " << store.size() << " puzzles in " << msSince(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    size_t skipped = 0;
+    std::string error;
+    if (!PuzzlePack::write(store, packPath, skipped, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (!error.empty()) std::cout << "Note: " << error << std::endl;
+    std::cout << "Wrote " << packPath << " in " << msSince(start) << " ms: " << store.size() - skipped
+              << " puzzles, " << skipped << " skipped, " << fileMb(csvPath) << " MB -> " << fileMb(packPath)
+              << " MB" << std::endl;
+
+    if (!verify) return 0;
+    start = Clock::now();
+    PuzzlePack pack;
+    if (!pack.open(packPath)) {
+        std::cerr << "cannot open " << packPath << std::endl;
+        return 1;
+    }
+    Puzzle expected;
+    Puzzle actual;
+    size_t mismatches = 0;
+    size_t row = 0;
+    for (size_t i = 0; i < store.size(); ++i) {
+        if (!store.load(i, expected) || pack.findId(expected.id) == PuzzleSource::NOT_FOUND) continue;
+        if (!pack.load(row, actual) || !samePuzzle(expected, actual) || pack.findId(expected.id) != row) {
+            if (mismatches++ < 5) std::cerr << "mismatch at puzzle " << expected.id << std::endl;
+        }
+        row++;
+    }
+    std::cout << "Verified " << row << " puzzles in " << msSince(start) << " ms, " << mismatches << " mismatches"
+              << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Times theme / opening-tag queries against the inverted index of a puzzle
+// file (CSV or pack), the way the game filters puzzles.
+//
+//   puzzlequery <puzzles.csv|puzzles.pzl> ["fork + endgame, 1600-1800" ...] [--repeat N]
+//
+// The first run builds <file>.tags; later runs load it. Without queries a
+// few representative ones are timed.
+#include "../src/PuzzlePack.h"
+#include "../src/PuzzleStore.h"
+#include "../src/PuzzleTagIndex.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+int usage() {
+    std::cerr << "usage: puzzlequery <puzzles.csv|puzzles.pzl> [query ...] [--repeat N]" << std::endl;
+    return 2;
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    std::vector<std::string> queries;
+    int repeat = 20;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg[0] == '-' && arg[1] == '-') return usage();
+        else if (path.empty()) path = arg;
+        else queries.push_back(arg);
+    }
+    if (path.empty()) return usage();
+    if (queries.empty()) {
+        queries.push_back("endgame");
+        queries.push_back("fork + endgame");
+        queries.push_back("fork + endgame, 1600-1800");
+        queries.push_back("mateIn2 + sacrifice + kingsideAttack");
+        queries.push_back("Sicilian_Defense, 1400-1600");
+        queries.push_back("zugzwang + promotion + rookEndgame, 2000-2400");
+    }
+
+    Clock::time_point start = Clock::now();
+    PuzzleSource* source = nullptr;
+    if (PuzzlePack::isPack(path)) source = new PuzzlePack();
+    else source = new PuzzleStore();
+    if (!source->open(path)) {
+        std::cerr << "cannot open " << path << std::endl;
+        delete source;
+        return 1;
+    }
+    std::cout << "Opened " << source->size() << " puzzles in " << msSince(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    PuzzleTagIndex tags;
+    if (!tags.open(*source)) {
+        std::cerr << "cannot index " << path << std::endl;
+        delete source;
+        return 1;
+    }
+    std::cout << "Tag index: " << tags.tagCount() << " tags in " << msSince(start) << " ms" << std::endl;
+
+    std::mt19937 rng(1);
+    std::cout << std::left << std::setw(48) << "query" << std::right << std::setw(10) << "matches"
+              << std::setw(12) << "ms/query" << "  sample" << std::endl;
+    for (const std::string& text : queries) {
+        PuzzleFilter filter;
+        if (!PuzzleFilter::parse(text, filter)) {
+            std::cout << std::left << std::setw(48) << text << "  (empty)" << std::endl;
+            continue;
+        }
+        std::string unknown;
+        std::vector<uint32_t> rows;
+        start = Clock::now();
+        for (int r = 0; r < repeat; ++r) rows = tags.match(filter, &unknown);
+        double ms = msSince(start) / repeat;
+
+        std::string sample = "-";
+        if (!unknown.empty()) {
+            sample = "unknown tag " + unknown;
+        } else if (!rows.empty()) {
+            Puzzle p;
+            if (source->load(rows[std::uniform_int_distribution<size_t>(0, rows.size() - 1)(rng)], p)) {
+                sample = p.id + " " + std::to_string(p.rating) + " " + p.themes;
+            }
+        }
+        std::cout << std::left << std::setw(48) << filter.describe() << std::right << std::setw(10) << rows.size()
+                  << std::setw(12) << std::fixed << std::setprecision(3) << ms << "  " << sample << std::endl;
+    }
+    delete source;
+    return 0;
+}
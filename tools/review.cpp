@@ -0,0 +1,95 @@
+// Headless game review: analyses every position of each game in a PGN file
+// on a pool of engines and prints per-move centipawn loss, classification
+// and accuracy, plus a summary per side.
+//
+//   review <file.pgn> [--depth N] [--movetime MS] [--engines N] [--threads N]
+//                     [--hash MB] [--engine PATH]
+//
+// Defaults: depth 16, engines = cores / threads, 1 thread and 16 MB per
+// engine, and Stockfish from the usual path (the built-in engine if it
+// cannot be started).
+#include "../src/EnginePool.h"
+#include "../src/GameReview.h"
+#include "../src/Pgn.h"
+#include "../src/SearchEngine.h"
+#include "../src/StockfishEngine.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int usage() {
+    std::cerr << "usage: review <file.pgn> [--depth N] [--movetime MS] [--engines N] [--threads N]"
+                 " [--hash MB] [--engine PATH]" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string pgnPath;
+    std::string enginePath = STOCKFISH_DEFAULT_PATH;
+    SearchLimits limits;
+    int engines = 0;
+    int threads = 1;
+    int hash = 16;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--depth") == 0 && hasValue) limits.depth = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--movetime") == 0 && hasValue) limits.movetimeMs = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--engines") == 0 && hasValue) engines = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue) threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--hash") == 0 && hasValue) hash = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--engine") == 0 && hasValue) enginePath = argv[++i];
+        else if (arg[0] != '-' && pgnPath.empty()) pgnPath = arg;
+        else return usage();
+    }
+    if (pgnPath.empty()) return usage();
+    if (limits.depth <= 0 && limits.movetimeMs <= 0) limits.depth = 16;
+
+    std::ifstream file(pgnPath.c_str());
+    if (!file) {
+        std::cerr << "cannot open " << pgnPath << std::endl;
+        return 1;
+    }
+
+    EnginePool pool(engines, threads, hash);
+    pool.setEngineFactory([enginePath]() -> AnalysisEngine* {
+        AnalysisEngine* engine = new StockfishEngine();
+        if (engine->initialize(enginePath)) return engine;
+        delete engine;
+        engine = new SearchEngine();
+        if (engine->initialize("")) return engine;
+        delete engine;
+        return nullptr;
+    });
+    if (!pool.start()) return 1;
+
+    PgnReader reader(file);
+    PgnGame game;
+    GameReview review(pool, limits);
+    int gameNumber = 0;
+    while (reader.next(game)) {
+        gameNumber++;
+        std::cout << "\nGame " << gameNumber << ": " << game.tag("White") << " - " << game.tag("Black")
+                  << "  " << game.result << " (" << game.moves.size() << " plies)" << std::endl;
+        if (!game.error.empty()) std::cout << "  PGN: " << game.error << "; reviewing the moves before it" << std::endl;
+        if (!review.start(game.startFEN, game.moves)) {
+            std::cout << "  cannot replay this game, skipped" << std::endl;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        review.update();
+        while (review.isWaiting()) review.update(true);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << review.report();
+        std::cout << "  analysed in " << seconds << " s" << std::endl;
+    }
+    return 0;
+}
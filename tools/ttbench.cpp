@@ -0,0 +1,87 @@
+// Transposition table micro-benchmark: probe/store throughput on one shared
+// table at 1, 2, 4 and 8 threads.
+//
+//   ttbench [megabytes] [operations per thread]    defaults: 64 MB, 4M ops
+//
+// Each operation is a probe followed by a store on a random key, so a
+// perfectly scaling table doubles total throughput with the thread count.
+#include "../src/TranspositionTable.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+uint64_t nextRandom(uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+// Returns the number of probes that hit, so the work cannot be optimised away
+uint64_t hammer(TranspositionTable& tt, int threadIndex, uint64_t operations) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(threadIndex + 1);
+    uint64_t hits = 0;
+    uint64_t recent[16] = { 0 };
+    TTEntry entry;
+    for (uint64_t i = 0; i < operations; ++i) {
+        // Revisit a recent key a quarter of the time so probes hit as they would in a search
+        uint64_t key;
+        if ((i & 3) == 0) {
+            key = recent[(i >> 2) & 15];
+        } else {
+            key = nextRandom(state);
+            recent[i & 15] = key;
+        }
+        if (tt.probe(key, entry)) hits++;
+        tt.store(key, static_cast<Move>(key & 0xFFF), static_cast<int>(key % 2000) - 1000,
+                 static_cast<int>(i & 31), BOUND_EXACT);
+    }
+    return hits;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long megabytes = argc > 1 ? std::atol(argv[1]) : 64;
+    long long operations = argc > 2 ? std::atoll(argv[2]) : 4000000LL;
+    if (megabytes < 1 || operations < 1) {
+        std::cerr << "usage: ttbench [megabytes] [operations per thread]" << std::endl;
+        return 2;
+    }
+
+    TranspositionTable tt(static_cast<size_t>(megabytes));
+    std::cout << "Table: " << tt.sizeInBytes() / (1024 * 1024) << " MB, "
+              << operations << " probe+store per thread" << std::endl;
+
+    const int threadCounts[] = { 1, 2, 4, 8 };
+    double singleRate = 0.0;
+    for (int threads : threadCounts) {
+        tt.clear();
+        tt.newSearch();
+        std::vector<std::thread> pool;
+        std::vector<uint64_t> hits(threads, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&tt, &hits, t, operations]() {
+                hits[t] = hammer(tt, t, static_cast<uint64_t>(operations));
+            });
+        }
+        for (std::thread& th : pool) th.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t totalHits = 0;
+        for (uint64_t h : hits) totalHits += h;
+        double rate = operations * threads / seconds / 1e6;
+        if (threads == 1) singleRate = rate;
+        std::cout << threads << " thread" << (threads == 1 ? " " : "s") << ": "
+                  << rate << " M ops/s (" << (singleRate > 0.0 ? rate / singleRate : 0.0) << "x), "
+                  << "hits " << totalHits << ", hashfull " << tt.hashfull() << std::endl;
+    }
+    return 0;
+}